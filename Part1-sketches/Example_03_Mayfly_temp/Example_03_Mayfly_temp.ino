@@ -19,13 +19,26 @@ https://github.com/SodaqMoja/Sodaq_DS3231
 
 #include <Arduino.h>
 #include <Wire.h>
+#include <avr/sleep.h>
 #include "Sodaq_DS3231.h"   // Install this library to interact with the Real Time Clock
 
+// In low power mode the Mayfly sleeps between readings and the DS3231's
+// once-a-second alarm wakes it up.  Set this to 0 for the original
+// always-awake demo.
+#define LOW_POWER_MODE 1
+
 int State8 = LOW;
 int State9 = LOW;
 
 int LEDtime = 1000;   //milliseconds
 
+const int8_t rtcIntPin = A7;   // DS3231 alarm output on the Mayfly
+
+unsigned long awakeMicros = 0;   // how long the last sample kept us awake
+
+// The alarm only needs to wake the CPU, so the interrupt has nothing to do
+EMPTY_INTERRUPT(PCINT0_vect);
+
 void setup ()
 {
     pinMode(8, OUTPUT);
@@ -37,10 +50,39 @@ void setup ()
 
     Serial.println("EnviroDIY Mayfly: Blink demo with serial temperature");
 
+#if LOW_POWER_MODE
+    ADCSRA &= ~_BV(ADEN);   // the ADC isn't used, so don't power it
+
+    // Have the DS3231 pull its alarm pin low every second, and wake on
+    // the pin change
+    pinMode(rtcIntPin, INPUT_PULLUP);
+    rtc.enableInterrupts(EverySecond);
+    rtc.clearINTStatus();
+    *digitalPinToPCMSK(rtcIntPin) |= _BV(digitalPinToPCMSKbit(rtcIntPin));
+    *digitalPinToPCICR(rtcIntPin) |= _BV(digitalPinToPCICRbit(rtcIntPin));
+#endif
 }
 
+#if LOW_POWER_MODE
+// Power down until the DS3231 alarm pulls its pin low
+void sleepUntilAlarm()
+{
+    set_sleep_mode(SLEEP_MODE_PWR_DOWN);
+    cli();
+    if (digitalRead(rtcIntPin) == HIGH) {
+      sleep_enable();
+      sei();
+      sleep_cpu();
+      sleep_disable();
+    }
+    sei();
+}
+#endif
+
 void loop ()
 {
+    unsigned long wakeMicros = micros();
+
     if (State8 == LOW) {
       State8 = HIGH;
     } else {
@@ -51,9 +93,22 @@ void loop ()
     State9 = !State8;
     digitalWrite(9, State9);
 
+#if LOW_POWER_MODE
+    rtc.clearINTStatus();                 //let the alarm pin go so it can wake us next time
+    // The DS3231 converts the temperature by itself every 64 seconds,
+    // so just read the registers
+    Serial.print(rtc.getTemperature(),2);
+    Serial.print("deg C, awake us: ");
+    Serial.println(awakeMicros);          //how long the previous sample took
+    Serial.flush();                       //finish sending before the UART stops
+
+    awakeMicros = micros() - wakeMicros;
+    sleepUntilAlarm();
+#else
     rtc.convertTemperature();             //convert current temperature into registers
     Serial.print(rtc.getTemperature(),2); //read registers and display the temperature
     Serial.println("deg C");
 
     delay(LEDtime);
+#endif
 }
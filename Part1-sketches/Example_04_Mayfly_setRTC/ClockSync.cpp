@@ -0,0 +1,301 @@
+#include "ClockSync.h"
+#include <Sodaq_DS3231.h>
+#include "RtcTimebase.h"
+
+// Same limits as the "T" command always had
+const unsigned long DEFAULT_TIME = 1451606400; // Jan 1 2016 00:00:00.000
+const unsigned long MAX_TIME = 2713910400; // Jan 1 2056 00:00:00.000
+
+
+// Print a number of milliseconds as signed seconds, like -1.234
+static void printSeconds(Print &out, int64_t ms)
+{
+  out.print(ms < 0 ? '-' : '+');
+  uint64_t magnitude = ms < 0 ? -ms : ms;
+  out.print((uint32_t)(magnitude / 1000));
+  out.print('.');
+  uint16_t fraction = magnitude % 1000;
+  if (fraction < 100) out.print('0');
+  if (fraction < 10) out.print('0');
+  out.print(fraction);
+}
+
+
+ClockSync::ClockSync(Stream &port)
+  : port(port), state(IDLE), field(NO_FIELD), requestId(0), lastResult(NO_RESULT)
+{
+}
+
+
+bool ClockSync::busy() const
+{
+  return state != IDLE || field != NO_FIELD;
+}
+
+
+bool ClockSync::update()
+{
+  bool finished = false;
+  while (port.available() > 0)
+  {
+    // Timestamp each byte as it is taken, so t4 is when the reply arrived
+    if (handleByte(port.read(), millis()))
+    {
+      finished = true;
+    }
+  }
+
+  uint32_t now = millis();
+  if (field == UNIX_TIME && now - lastByteMillis >= QuietMs)
+  {
+    finishTimeCommand();
+    finished = true;
+  }
+
+  switch (state)
+  {
+    case IDLE:
+      break;
+
+    case WAIT_REPLY:
+      if (now - stateMillis >= ReplyTimeoutMs)
+      {
+        field = NO_FIELD;
+        finished = finishExchange();
+      }
+      break;
+
+    case WAIT_SECOND:
+      uint32_t sinceAnchor = millis() - anchorMillis;
+      if ((int64_t)sinceAnchor + bestOffset >= targetMs)
+      {
+        lastSetTo = targetMs / 1000;
+        rtc.setEpoch(lastSetTo);
+        RtcTimebase::restart(lastSetTo);
+        report(F("Sync: RTC set, it was off by "));
+        lastResult = SYNCED;
+        state = IDLE;
+        finished = true;
+      }
+      break;
+  }
+  return finished;
+}
+
+
+bool ClockSync::handleByte(char c, uint32_t now)
+{
+  lastByteMillis = now;
+
+  if (field != NO_FIELD)
+  {
+    if (c >= '0' && c <= '9')
+    {
+      value = value * 10 + (c - '0');
+      return false;
+    }
+    switch (field)
+    {
+      case UNIX_TIME:
+        finishTimeCommand();
+        return true;
+
+      case REPLY_ID:
+        field = NO_FIELD;
+        if (c == ',')
+        {
+          replyId = value;
+          value = 0;
+          field = T2;
+        }
+        return false;   // otherwise the reply was garbled; the timeout resends
+
+      case T2:
+        field = NO_FIELD;
+        if (c == ',')
+        {
+          t2 = value;
+          value = 0;
+          field = T3;
+        }
+        return false;
+
+      case T3:
+        field = NO_FIELD;
+        t3 = value;
+        if (replyId != requestId)
+        {
+          return false;   // late, for a request that already timed out
+        }
+        return recordExchange();
+
+      default:
+        field = NO_FIELD;
+        break;
+    }
+  }
+
+  switch (c)
+  {
+    case 'R':
+      if (state == WAIT_REPLY)
+      {
+        t4 = now;
+        value = 0;
+        field = REPLY_ID;
+      }
+      break;
+
+    case 'T':
+      if (state == IDLE)
+      {
+        value = 0;
+        field = UNIX_TIME;
+      }
+      break;
+
+    case 'S':
+    case 'C':
+      if (state == IDLE)
+      {
+        start(c == 'S');
+      }
+      break;
+  }
+  return false;
+}
+
+
+void ClockSync::start(bool set)
+{
+  setClock = set;
+  sent = 0;
+  good = 0;
+
+  // Without the 1 Hz pulses the RTC's old time is only known to the
+  // second, but it can still be set
+  anchored = RtcTimebase::valid() && RtcTimebase::pulsing();
+  anchorMillis = millis();
+  anchorRtcMs = anchored ? RtcTimebase::nowMs() : (uint64_t)rtc.now().getEpoch() * 1000;
+  sendRequest();
+}
+
+
+void ClockSync::sendRequest()
+{
+  sent++;
+  requestId++;
+  t1 = millis();
+  port.write('Q');
+  port.print(requestId);
+  port.write('\n');
+  stateMillis = t1;
+  state = WAIT_REPLY;
+}
+
+
+bool ClockSync::recordExchange()
+{
+  // Measured from anchorMillis, so millis() wrapping round part way
+  // through changes nothing
+  uint32_t sentAt = t1 - anchorMillis;
+  uint32_t receivedAt = t4 - anchorMillis;
+  int32_t roundTrip = (int32_t)(t4 - t1) - (int32_t)(t3 - t2);
+  int64_t offset = ((int64_t)(t2 - sentAt) + (int64_t)(t3 - receivedAt)) / 2;
+  if (roundTrip >= 0 && (good == 0 || roundTrip < bestRoundTrip))
+  {
+    bestRoundTrip = roundTrip;
+    bestOffset = offset;
+  }
+  if (roundTrip >= 0)
+  {
+    good++;
+  }
+  return finishExchange();
+}
+
+
+bool ClockSync::finishExchange()
+{
+  if (good < Exchanges && sent < 2 * Exchanges)
+  {
+    sendRequest();
+    return false;
+  }
+
+  if (good == 0)
+  {
+    port.println(F("Sync failed: no reply from the PC"));
+    lastResult = FAILED;
+    state = IDLE;
+    return true;
+  }
+
+  if (setClock)
+  {
+    // Wait for the PC's next whole second
+    uint32_t sinceAnchor = millis() - anchorMillis;
+    int64_t pcNow = (int64_t)sinceAnchor + bestOffset;
+    targetMs = (pcNow / 1000 + 1) * 1000;
+    state = WAIT_SECOND;
+    return false;
+  }
+
+  report(F("Check: RTC is off by "));
+  lastResult = CHECKED;
+  state = IDLE;
+  return true;
+}
+
+
+void ClockSync::report(const __FlashStringHelper *label)
+{
+  // The RTC's time minus the PC's, both at anchorMillis
+  lastError = (int64_t)anchorRtcMs - bestOffset;
+
+  port.print(label);
+  printSeconds(port, lastError);
+  port.print(F(" s, round trip "));
+  port.print(bestRoundTrip);
+  port.print(F(" ms"));
+  if (!anchored)
+  {
+    port.print(F(" (no 1 Hz signal, so only to the second)"));
+  }
+  port.println();
+}
+
+
+void ClockSync::finishTimeCommand()
+{
+  field = NO_FIELD;
+  port.print("Received:");
+  port.println((uint32_t)value);
+  if (value < DEFAULT_TIME || value > MAX_TIME) // check the value is a valid time (between 2016 and 2056)
+  {
+    port.println("Time out of range");
+    lastResult = FAILED;
+    return;
+  }
+  uint32_t newTs = value;
+
+  //Get the old time stamp and print out difference in times
+  uint32_t oldTs = rtc.now().getEpoch();
+  int32_t diffTs = newTs - oldTs;
+  int32_t diffTs_abs = abs(diffTs);
+  port.print("RTC is Off by ");
+  port.print(diffTs_abs);
+  port.println(" seconds");
+
+  //Display old and new time stamps
+  port.print("Updating RTC, old = ");
+  port.print(oldTs);
+  port.print(" new = ");
+  port.println(newTs);
+
+  //Update the rtc
+  rtc.setEpoch(newTs);
+  RtcTimebase::restart(newTs);
+  lastSetTo = newTs;
+  lastResult = SET_BY_HAND;
+}
@@ -0,0 +1,117 @@
+/*
+  ClockSync
+
+  Sets the DS3231 from a PC to within a few milliseconds, using the same
+  four-timestamp exchange as NTP.
+
+  The Mayfly sends "Q<n>" and notes when (t1).  The PC answers straight
+  away with "R<n>,<t2>,<t3>": the same n, then when it got the Q and when
+  it sent the reply, both in milliseconds since 1970.  The Mayfly notes
+  when the R arrives (t4).  n counts up with each request, so a reply that
+  turns up after its request timed out is thrown away, instead of being
+  taken for the answer to the next one.  Then
+
+    round trip = (t4 - t1) - (t3 - t2)
+    offset     = ((t2 - t1) + (t3 - t4)) / 2    (PC time minus millis())
+
+  Several exchanges are made and the one with the shortest round trip is
+  kept, since it had the least room for the two directions to differ.
+  Waiting until millis() + offset reaches a whole second and writing the
+  RTC right then makes the DS3231 start its new second in step with the PC
+  (writing the seconds register restarts its countdown).
+
+  The RTC's old time comes from RtcTimebase, to the millisecond, so its
+  error can be reported too.
+
+  Everything arrives through update(), one byte at a time, so loop() never
+  waits on the serial port.  Commands from the PC:
+
+    S           synchronize the RTC
+    C           check the RTC against the PC without changing it
+    T<seconds>  set the RTC to a unix time, as before (whole seconds)
+ */
+
+#ifndef ClockSync_h
+#define ClockSync_h
+
+#include <Arduino.h>
+
+class ClockSync
+{
+  public:
+  static const uint8_t Exchanges = 8;            // round trips per sync
+  static const unsigned long ReplyTimeoutMs = 1000;
+  static const unsigned long QuietMs = 100;      // ends a "T" typed without a line ending
+
+  enum Result { NO_RESULT, SYNCED, CHECKED, SET_BY_HAND, FAILED };
+
+  ClockSync(Stream &port);
+
+  // Read whatever has arrived and move the sync along.  Returns true when
+  // a sync, check or "T" command has just finished.
+  bool update();
+
+  // True from the first command byte until the result is printed
+  bool busy() const;
+
+  // What the last finished command did
+  Result result() const { return lastResult; }
+
+  // For SYNCED and CHECKED: the RTC's time minus the PC's, in ms, and
+  // whether that is to the millisecond (the 1 Hz output was seen) or only
+  // to the second
+  int64_t errorMs() const { return lastError; }
+  bool errorExact() const { return anchored; }
+
+  // For SYNCED and SET_BY_HAND: the unix time the RTC was set to
+  uint32_t setTo() const { return lastSetTo; }
+
+  private:
+  enum State { IDLE, WAIT_REPLY, WAIT_SECOND };
+  enum Field { NO_FIELD, UNIX_TIME, REPLY_ID, T2, T3 };
+
+  void start(bool setClock);
+  void sendRequest();
+  bool recordExchange();
+  bool finishExchange();
+  void finishTimeCommand();
+  bool handleByte(char c, uint32_t now);
+  void report(const __FlashStringHelper *label);
+
+  Stream &port;
+
+  // Times from millis() are kept to its 32 bits, so the differences
+  // between them wrap round with it
+
+  State state;
+  bool setClock;
+  uint32_t stateMillis;
+
+  // Parser
+  Field field;
+  uint64_t value;
+  uint64_t replyId;
+  uint64_t t2, t3;
+  uint32_t lastByteMillis;
+
+  // The RTC's time at anchorMillis, in ms since 1970 (only to the second
+  // unless anchored is true)
+  uint64_t anchorRtcMs;
+  uint32_t anchorMillis;
+  bool anchored;
+
+  // The exchange in progress, and the best one so far.  The offset is
+  // the PC's time minus the milliseconds since anchorMillis.
+  uint32_t t1, t4;
+  uint8_t requestId;        // n in the last "Q<n>"
+  uint8_t sent, good;
+  int64_t bestOffset;
+  int32_t bestRoundTrip;
+  int64_t targetMs;
+
+  Result lastResult;
+  int64_t lastError;
+  uint32_t lastSetTo;
+};
+
+#endif
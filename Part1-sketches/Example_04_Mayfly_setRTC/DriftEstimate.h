@@ -0,0 +1,103 @@
+/*
+  DriftEstimate
+
+  Works out how fast a DS3231 runs from the errors found at each sync, and
+  the aging offset that would cancel it.
+
+  Every sync sets the clock, so the error found at the next one is what
+  built up over the time in between.  error / interval is the rate for
+  that interval.  The aging offset in effect then slowed the clock by
+  about 0.1 ppm per count (DS3231 datasheet, "Aging Offset"), so adding
+  that back gives the crystal's own rate.  The estimate is the average of
+  those, weighted by interval squared: a few ms of sync error matters much
+  less over a week than over an hour.
+
+  Rates are in parts per billion (ppb), positive when the RTC runs fast.
+  This file only needs <stdint.h>, so the math can be checked on a PC.
+ */
+
+#ifndef DriftEstimate_h
+#define DriftEstimate_h
+
+#include <stdint.h>
+
+#define DRIFT_HISTORY_SIZE 8
+
+const uint32_t DRIFT_MIN_INTERVAL = 3600;   // s; shorter gaps say little about the rate
+const int32_t DRIFT_MAX_PPB = 50000;        // 50 ppm; anything faster wasn't drift
+const int32_t AGING_PPB = 100;              // slowing from one count of aging offset
+
+// What one sync found
+struct DriftSample
+{
+  uint32_t interval;   // seconds since the sync before
+  int32_t errorMs;     // RTC minus true time, just before setting
+  int8_t aging;        // aging offset in effect over the interval
+};
+
+// The last few samples, oldest overwritten first
+struct DriftHistory
+{
+  uint8_t count;
+  uint8_t next;
+  DriftSample samples[DRIFT_HISTORY_SIZE];
+};
+
+// The rate over one interval, with the aging offset's effect still in it
+inline int32_t driftSampleRatePpb(const DriftSample &s)
+{
+  return (int32_t)((int64_t)s.errorMs * 1000000 / (int64_t)s.interval);
+}
+
+// Keep a sample if it is long enough and believable.  Returns false if not.
+inline bool driftAddSample(DriftHistory &h, const DriftSample &s)
+{
+  if (s.interval < DRIFT_MIN_INTERVAL)
+  {
+    return false;
+  }
+  int32_t rate = driftSampleRatePpb(s);
+  if (rate > DRIFT_MAX_PPB || rate < -DRIFT_MAX_PPB)
+  {
+    return false;
+  }
+  h.samples[h.next] = s;
+  h.next = (h.next + 1) % DRIFT_HISTORY_SIZE;
+  if (h.count < DRIFT_HISTORY_SIZE)
+  {
+    h.count++;
+  }
+  return true;
+}
+
+// The crystal's own rate, as if the aging offset were 0
+inline int32_t driftEstimatePpb(const DriftHistory &h)
+{
+  float sum = 0;
+  float weights = 0;
+  for (uint8_t i = 0; i < h.count; i++)
+  {
+    const DriftSample &s = h.samples[i];
+    float w = (float)s.interval * (float)s.interval;
+    sum += w * ((float)driftSampleRatePpb(s) + (float)s.aging * AGING_PPB);
+    weights += w;
+  }
+  if (weights == 0)
+  {
+    return 0;
+  }
+  // Rounded, as float can land a hair under a whole number
+  float estimate = sum / weights;
+  return (int32_t)(estimate + (estimate < 0 ? -0.5f : 0.5f));
+}
+
+// The aging offset that cancels a rate, to the nearest count
+inline int8_t driftAgingFor(int32_t ratePpb)
+{
+  int32_t counts = (ratePpb + (ratePpb < 0 ? -AGING_PPB / 2 : AGING_PPB / 2)) / AGING_PPB;
+  if (counts > 127) counts = 127;
+  if (counts < -128) counts = -128;
+  return (int8_t)counts;
+}
+
+#endif
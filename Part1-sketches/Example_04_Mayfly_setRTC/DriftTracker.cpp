@@ -0,0 +1,160 @@
+#include "DriftTracker.h"
+#include <EEPROM.h>
+#include <Wire.h>
+
+#define DS3231_ADDRESS 0x68
+#define DS3231_CONTROL 0x0E
+#define DS3231_AGING   0x10
+#define DS3231_CONV    0x20   // control bit: start a temperature conversion
+
+// Changes whenever Saved does, so an old layout is never misread
+#define DRIFT_MAGIC 0xD701
+
+// A bigger error means the clock was changed some other way in between
+const int64_t MAX_ERROR_MS = 86400000L;
+
+
+// Print parts per billion as ppm, like +2.345
+static void printPpm(Print &out, int32_t ppb)
+{
+  out.print(ppb < 0 ? '-' : '+');
+  uint32_t magnitude = ppb < 0 ? -ppb : ppb;
+  out.print(magnitude / 1000);
+  out.print('.');
+  uint16_t fraction = magnitude % 1000;
+  if (fraction < 100) out.print('0');
+  if (fraction < 10) out.print('0');
+  out.print(fraction);
+}
+
+
+DriftTracker::DriftTracker(int eepromAddress)
+  : eepromAddress(eepromAddress)
+{
+}
+
+
+void DriftTracker::begin()
+{
+  EEPROM.get(eepromAddress, saved);
+  if (saved.magic != DRIFT_MAGIC || saved.history.count > DRIFT_HISTORY_SIZE)
+  {
+    memset(&saved, 0, sizeof(saved));
+    saved.magic = DRIFT_MAGIC;
+  }
+}
+
+
+void DriftTracker::synced(uint32_t setTo, int64_t errorMs, bool exact, Print &out)
+{
+  // The offset written at the last sync has been in effect since
+  int8_t aging = readAging();
+
+  if (saved.lastSync != 0 && exact && setTo > saved.lastSync &&
+      errorMs > -MAX_ERROR_MS && errorMs < MAX_ERROR_MS)
+  {
+    DriftSample sample = { setTo - saved.lastSync, (int32_t)errorMs, aging };
+    out.print(F("Drift: "));
+    printPpm(out, driftSampleRatePpb(sample));
+    out.print(F(" ppm over "));
+    out.print(sample.interval);
+    out.print(F(" s"));
+    if (!driftAddSample(saved.history, sample))
+    {
+      out.print(F(" (not used)"));
+    }
+    out.println();
+  }
+
+  if (saved.history.count > 0)
+  {
+    int8_t wanted = driftAgingFor(estimatePpb());
+    if (wanted != aging)
+    {
+      writeAging(wanted);
+    }
+  }
+  saved.lastSync = setTo;
+  save();
+  print(out);
+}
+
+
+void DriftTracker::checked(uint32_t now, int64_t errorMs, bool exact, Print &out)
+{
+  if (saved.lastSync == 0 || !exact || now <= saved.lastSync ||
+      errorMs <= -MAX_ERROR_MS || errorMs >= MAX_ERROR_MS)
+  {
+    return;
+  }
+  DriftSample sample = { now - saved.lastSync, (int32_t)errorMs, 0 };
+  out.print(F("Drift since the last sync: "));
+  printPpm(out, driftSampleRatePpb(sample));
+  out.print(F(" ppm over "));
+  out.print(sample.interval);
+  out.println(F(" s"));
+}
+
+
+void DriftTracker::setByHand()
+{
+  saved.lastSync = 0;
+  save();
+}
+
+
+int32_t DriftTracker::estimatePpb() const
+{
+  return driftEstimatePpb(saved.history);
+}
+
+
+void DriftTracker::print(Print &out) const
+{
+  out.print(F("Drift estimate: "));
+  if (saved.history.count == 0)
+  {
+    out.print(F("none yet"));
+  }
+  else
+  {
+    printPpm(out, estimatePpb());
+    out.print(F(" ppm from "));
+    out.print(saved.history.count);
+    out.print(F(" syncs"));
+  }
+  out.print(F(", aging offset "));
+  out.println(readAging());
+}
+
+
+void DriftTracker::save()
+{
+  // put() only rewrites bytes that changed
+  EEPROM.put(eepromAddress, saved);
+}
+
+
+int8_t DriftTracker::readAging()
+{
+  Wire.beginTransmission(DS3231_ADDRESS);
+  Wire.write(DS3231_AGING);
+  Wire.endTransmission();
+  Wire.requestFrom(DS3231_ADDRESS, 1);
+  return (int8_t)Wire.read();
+}
+
+
+void DriftTracker::writeAging(int8_t aging)
+{
+  Wire.beginTransmission(DS3231_ADDRESS);
+  Wire.write(DS3231_AGING);
+  Wire.write((uint8_t)aging);
+  Wire.endTransmission();
+
+  // Keep the 1 Hz output RtcTimebase set up, and convert now
+  Wire.beginTransmission(DS3231_ADDRESS);
+  Wire.write(DS3231_CONTROL);
+  Wire.write(DS3231_CONV);
+  Wire.endTransmission();
+}
@@ -0,0 +1,65 @@
+/*
+  DriftTracker
+
+  Keeps the sync history in EEPROM and steers the DS3231's aging offset
+  register (0x10) so the clock drifts less between syncs.
+
+  After each sync the new sample goes into the history (DriftEstimate.h),
+  the crystal's rate is re-estimated, and the aging offset is set to
+  cancel it.  A temperature conversion is started straight after so the
+  new offset takes effect now rather than at the next automatic one, up
+  to 64 s later.
+
+  The aging offset is kept by the DS3231's backup battery, and the
+  history by the Mayfly's EEPROM, so both survive a power cycle.
+ */
+
+#ifndef DriftTracker_h
+#define DriftTracker_h
+
+#include <Arduino.h>
+#include "DriftEstimate.h"
+
+class DriftTracker
+{
+  public:
+  DriftTracker(int eepromAddress);
+
+  // Load the history, or start an empty one if the EEPROM doesn't hold one
+  void begin();
+
+  // After a sync that set the RTC to setTo (unix time), having found it
+  // off by errorMs.  exact is false if the error is only to the second.
+  void synced(uint32_t setTo, int64_t errorMs, bool exact, Print &out);
+
+  // After a check: print the rate since the last sync
+  void checked(uint32_t now, int64_t errorMs, bool exact, Print &out);
+
+  // After the RTC was set some other way, so its error is unknown
+  void setByHand();
+
+  // The crystal's own rate, in ppb
+  int32_t estimatePpb() const;
+
+  // Print what is known so far
+  void print(Print &out) const;
+
+  // The DS3231's aging offset register
+  static int8_t readAging();
+  static void writeAging(int8_t aging);
+
+  private:
+  struct Saved
+  {
+    uint16_t magic;
+    uint32_t lastSync;   // unix time of the last sync, 0 if unknown
+    DriftHistory history;
+  };
+
+  void save();
+
+  int eepromAddress;
+  Saved saved;
+};
+
+#endif
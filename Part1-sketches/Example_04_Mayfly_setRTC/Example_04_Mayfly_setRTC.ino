@@ -6,7 +6,9 @@
  * After uploading this script to your Mayfly, the time can be set by either manually sending
  * a "T" followed by a unix time stamp to the Mayfly (ie, T1451606400) or by running the
  * sync_clock_PC.py python script which will automatically synchronize the RTC to UTC based
- * on the computer's clock or NTP (if internet connection is available).
+ * on the computer's clock or NTP (if internet connection is available).  The script
+ * measures the round trip over the serial port and sets the RTC to within a few
+ * milliseconds (see ClockSync.h).
  *
  * This script is meant to be used on a naked EnviroDIY Mayfly board with no connection other than
  * directly to the computer via microUSB.  If a GPRSbee or other internet/radio access shields are
@@ -22,130 +24,152 @@
 #include <Arduino.h>
 #include <Wire.h>  //http://arduino.cc/en/Reference/Wire (included with Arduino IDE)
 #include <Sodaq_DS3231.h> //Sodaq's library for the DS3231: https://github.com/SodaqMoja/Sodaq_DS3231
-
-String getDateTime()
+#include "TimestampFormat.h" // Formats times into a char buffer, without String or the heap
+#include "RtcTimebase.h"    // Millisecond time from the RTC's 1 Hz output, without I2C
+#include "ClockSync.h"      // Round-trip sync with the PC, to the millisecond
+#include "DriftTracker.h"   // Learns the RTC's drift and trims it with the aging offset
+
+// Free SRAM between the heap and the stack, now and at its lowest.
+// __brkval is only where the heap ends now, so to see how deep the stack
+// has ever gone, setup() fills the free SRAM with a pattern, and later the
+// pattern is searched for the first byte the stack has written over.
+// Nothing in this sketch allocates, so the heap should stay 0.
+extern char __heap_start;
+extern char *__brkval;
+
+#define SRAM_PAINT 0xA5
+
+char *heapEnd()
 {
-  String dateTimeStr;
-
-  //Create a DateTime object from the current time
-  DateTime dt(rtc.makeDateTime(rtc.now().getEpoch()));
-
-  //Convert it to a String
-  dt.addToString(dateTimeStr);
-
-  return dateTimeStr;
+  return __brkval ? __brkval : &__heap_start;
 }
 
-
-/*  code to process time sync messages from the serial port   */
-#define TIME_HEADER  'T'   // Header tag for serial time sync message
-
-unsigned long processSyncMessage() {
-  unsigned long pctime = 0L;
-  const unsigned long DEFAULT_TIME = 1451606400; // Jan 1 2016 00:00:00.000
-  const unsigned long MAX_TIME = 2713910400; // Jan 1 2056 00:00:00.000
-
-  if (Serial.find(TIME_HEADER)) {
-    pctime = Serial.parseInt();
-    Serial.println("Received:" + String(pctime));
-    if ( pctime < DEFAULT_TIME) // check the value is a valid time (greater than Jan 1 2016)
-    {
-      Serial.println("Time out of range");
-      pctime = 0L; // return 0 to indicate that the time is not valid
-    }
-    if ( pctime > MAX_TIME) // check the value is a valid time (greater than Jan 1 2016)
-    {
-      Serial.println("Time out of range");
-      pctime = 0L; // return 0 to indicate that the time is not valid
-    }
+void paintFreeMemory()
+{
+  char stackTop;
+  // Stop short of this function's own stack frame
+  for (char *p = heapEnd(); p < &stackTop - 16; p++)
+  {
+    *p = SRAM_PAINT;
   }
-  return pctime;
 }
 
-
-void syncRTCwithBatch()
+void printMemory()
 {
-  // Read the timestamp from the PC's batch program
-  uint32_t newTs = processSyncMessage();
-
-  if (newTs > 0)
+  char stackTop;
+  char *untouched = heapEnd();
+  while (untouched < &stackTop && *untouched == (char)SRAM_PAINT)
   {
-    //Serial.println(newTs);
+    untouched++;
+  }
+  Serial.print("Free SRAM: ");
+  Serial.print(&stackTop - heapEnd());
+  Serial.print(" bytes, never used: ");
+  Serial.print(untouched - heapEnd());
+  Serial.print(" bytes, heap: ");
+  Serial.print(heapEnd() - &__heap_start);
+  Serial.println(" bytes");
+}
 
-    // Add the timezone difference plus a few seconds
-    // to compensate for transmission and processing delay
-    //newTs += SYNC_DELAY + TIME_ZONE_SEC;
 
-    //Get the old time stamp and print out difference in times
-    uint32_t oldTs = rtc.now().getEpoch();
-    int32_t diffTs = newTs - oldTs;
-    int32_t diffTs_abs = abs(diffTs);
-    Serial.println("RTC is Off by " + String(diffTs_abs) + " seconds");
+// The DS3231's 1 Hz output is wired to A7 on the Mayfly
+#define RTC_PIN A7
 
-    //Display old and new time stamps
-    Serial.print("Updating RTC, old = " + String(oldTs));
-    Serial.println(" new = " + String(newTs));
+ClockSync clockSync(Serial);
 
-    //Update the rtc
-    rtc.setEpoch(newTs);
-  }
-}
+// Where the sync history is kept
+#define DRIFT_EEPROM_ADDRESS 0
+
+DriftTracker drift(DRIFT_EEPROM_ADDRESS);
 
 
 void setup()
 {
+  paintFreeMemory();
+
   //Start Serial for serial monitor
   Serial.begin(57600);
   while (!Serial) ; // wait until Arduino Serial Monitor opens
   Serial.println("Running sketch: Example_04_Mayfly_setRTC.ino");
-}
+  printMemory();
 
-// This makes the date look all pretty
-String weekDay[] = {"Sunday", "Monday", "Tuesday", "Wednesday", "Thursday",
-                     "Friday", "Saturday" };
-String charMonth[] = {"January", "February", "March", "April", "May", "June",
-                       "July", "August", "September", "October", "November",
-                       "December" };
-String add02d(uint16_t val)
-{
-  if (val < 10)
-    {return "0" + String(val);}
-  else
-    {return String(val);}
+  rtc.begin();
+  if (!RtcTimebase::begin(RTC_PIN))
+  {
+    Serial.println("The RTC's 1 Hz output must be on port A");
+  }
+  drift.begin();
+  drift.print(Serial);
 }
 
+uint8_t linesPrinted = 0;
+uint32_t lastPrinted = 0;
+
 
 void loop()
 {
-  //Print out current date/time
-  DateTime now = rtc.now(); //get the current date-time
-  uint32_t ts = now.getEpoch();
-  Serial.print("Current RTC Date/Time: ");
-  Serial.print(weekDay[now.dayOfWeek()-1]);
-  Serial.print(", ");
-  Serial.print(charMonth[now.month()-1]);
-  Serial.print(' ');
-  Serial.print(now.date());
-  Serial.print(", ");
-  Serial.print(now.year());
-  Serial.print(' ');
-  Serial.print(now.hour());
-  Serial.print(':');
-  Serial.print(add02d(now.minute()));
-  Serial.print(':');
-  Serial.print(add02d(now.second()));
-  Serial.println(" (" + String(ts) + ")");
-
-  if (Serial.available())
+  // Sync messages are handled a byte at a time as they arrive
+  if (clockSync.update())
+  {
+    switch (clockSync.result())
+    {
+      case ClockSync::SYNCED:
+        drift.synced(clockSync.setTo(), clockSync.errorMs(), clockSync.errorExact(), Serial);
+        break;
+
+      case ClockSync::CHECKED:
+        drift.checked(RtcTimebase::nowMs() / 1000, clockSync.errorMs(), clockSync.errorExact(), Serial);
+        break;
+
+      case ClockSync::SET_BY_HAND:
+        drift.setByHand();
+        break;
+
+      default:
+        break;
+    }
+  }
+
+  RtcTimebase::update();
+
+  // Print each new second, unless a sync is running: printing would
+  // delay its replies
+  uint32_t ts;
+  uint16_t ms;
+  RtcTimebase::now(ts, ms);
+  if (clockSync.busy() || !RtcTimebase::valid() || ts == lastPrinted)
   {
-    //Sync time
-    syncRTCwithBatch();
+    return;
   }
-  // Empty the serial buffer
-  while (Serial.available() > 0)
+  lastPrinted = ts;
+
+  // This makes the date look all pretty
+  CivilTime t;
+  epochToCivil(ts, t);
+  char timestamp[LONGDATE_SIZE];
+  formatLongDate(timestamp, sizeof(timestamp), t);
+
+  Serial.print("Current RTC Date/Time: ");
+  Serial.print(timestamp);
+  Serial.print(" (");
+  Serial.print(ts);
+  Serial.print('.');
+  if (ms < 100) Serial.print('0');
+  if (ms < 10) Serial.print('0');
+  Serial.print(ms);
+  Serial.print(")");
+  if (!RtcTimebase::pulsing())
   {
-    Serial.read();
+    Serial.print(" no 1 Hz pulses, ");
+    Serial.print(RtcTimebase::missed());
+    Serial.print(" missed");
   }
+  Serial.println();
 
-  delay(1000);
+  // Once a minute, check that memory use isn't creeping up
+  if (++linesPrinted >= 60)
+  {
+    linesPrinted = 0;
+    printMemory();
+  }
 }
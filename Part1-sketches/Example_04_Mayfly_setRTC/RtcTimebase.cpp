@@ -0,0 +1,194 @@
+#include "RtcTimebase.h"
+#include <Wire.h>
+#include <Sodaq_DS3231.h>
+
+#define DS3231_ADDRESS 0x68
+#define DS3231_CONTROL 0x0E   // 0 here: oscillator on, 1 Hz square wave, no alarms
+
+// How far into a second the count may be checked, so an edge can't land
+// in the middle of the I2C read
+#define CHECK_WINDOW_MS 500
+
+// A gap longer than this means a pulse went missing
+#define LATE_MS 1500
+
+static volatile uint32_t anchorSeconds;   // unix time at the last edge
+static volatile unsigned long anchorMillis;
+static volatile unsigned long anchorMicros;
+static volatile uint8_t edges = 0;        // counts edges, so loop() can spot a new one
+static volatile bool needCheck = true;    // the count is unknown or doubtful
+static volatile uint16_t missedPulses = 0;
+
+static volatile uint8_t *sqwPinReg;
+static uint8_t sqwMask;
+static volatile bool lastIsrLevel;
+
+static bool counting = false;             // anchorSeconds has been read from the RTC
+static uint8_t lastCheck = 0;             // edges when the count was last checked
+
+
+bool RtcTimebase::begin(uint8_t sqwPin)
+{
+  if (digitalPinToPCICRbit(sqwPin) != 0)
+  {
+    return false;
+  }
+
+  Wire.beginTransmission(DS3231_ADDRESS);
+  Wire.write(DS3231_CONTROL);
+  Wire.write(0x00);
+  Wire.endTransmission();
+
+  pinMode(sqwPin, INPUT_PULLUP);
+  sqwPinReg = portInputRegister(digitalPinToPort(sqwPin));
+  sqwMask = digitalPinToBitMask(sqwPin);
+  lastIsrLevel = (*sqwPinReg & sqwMask) != 0;
+  anchorMillis = millis();
+  anchorMicros = micros();
+
+  *digitalPinToPCMSK(sqwPin) |= _BV(digitalPinToPCMSKbit(sqwPin));
+  PCIFR = _BV(digitalPinToPCICRbit(sqwPin));
+  *digitalPinToPCICR(sqwPin) |= _BV(digitalPinToPCICRbit(sqwPin));
+  return true;
+}
+
+
+void RtcTimebase::update()
+{
+  uint8_t seen = edges;
+  if (!needCheck && (uint8_t)(seen - lastCheck) < CheckSeconds)
+  {
+    return;
+  }
+
+  // Only just after an edge, and only if no edge came during the read
+  uint8_t oldSREG = SREG;
+  cli();
+  unsigned long since = millis() - anchorMillis;
+  SREG = oldSREG;
+  if (since >= CHECK_WINDOW_MS || seen == lastCheck)
+  {
+    return;
+  }
+  uint32_t seconds = rtc.now().getEpoch();
+
+  oldSREG = SREG;
+  cli();
+  if (edges == seen)
+  {
+    if (counting && seconds != anchorSeconds)
+    {
+      missedPulses++;
+    }
+    anchorSeconds = seconds;
+    counting = true;
+    needCheck = false;
+    lastCheck = seen;
+  }
+  SREG = oldSREG;
+}
+
+
+void RtcTimebase::now(uint32_t &seconds, uint16_t &millisInSecond)
+{
+  uint8_t oldSREG = SREG;
+  cli();
+  uint32_t s = anchorSeconds;
+  unsigned long m = anchorMillis;
+  unsigned long u = anchorMicros;
+  SREG = oldSREG;
+
+  // micros() is finer but wraps every 71 minutes, so only use it for the
+  // usual case of an edge in the last second or so
+  unsigned long elapsed = millis() - m;
+  if (elapsed < LATE_MS)
+  {
+    elapsed = (micros() - u) / 1000;
+  }
+  seconds = s + elapsed / 1000;
+  millisInSecond = elapsed % 1000;
+}
+
+
+uint64_t RtcTimebase::nowMs()
+{
+  uint32_t seconds;
+  uint16_t ms;
+  now(seconds, ms);
+  return (uint64_t)seconds * 1000 + ms;
+}
+
+
+bool RtcTimebase::valid()
+{
+  return counting;
+}
+
+
+bool RtcTimebase::pulsing()
+{
+  uint8_t oldSREG = SREG;
+  cli();
+  unsigned long since = millis() - anchorMillis;
+  SREG = oldSREG;
+  return since < LATE_MS;
+}
+
+
+uint16_t RtcTimebase::missed()
+{
+  uint8_t oldSREG = SREG;
+  cli();
+  uint16_t m = missedPulses;
+  SREG = oldSREG;
+  return m;
+}
+
+
+void RtcTimebase::restart(uint32_t seconds)
+{
+  uint8_t oldSREG = SREG;
+  cli();
+  anchorSeconds = seconds;
+  anchorMillis = millis();
+  anchorMicros = micros();
+  counting = true;
+  needCheck = true;   // read it back once the first pulse comes
+  SREG = oldSREG;
+}
+
+
+ISR(PCINT0_vect)
+{
+  // Other pins on the port share this interrupt, so ignore it unless the
+  // 1 Hz output itself changed, and then only when it falls
+  bool level = (*sqwPinReg & sqwMask) != 0;
+  if (level == lastIsrLevel)
+  {
+    return;
+  }
+  lastIsrLevel = level;
+  if (level)
+  {
+    return;
+  }
+
+  unsigned long m = millis();
+  unsigned long gap = m - anchorMillis;
+  if (gap >= LATE_MS)
+  {
+    // Count the seconds that went by without a pulse, and have update()
+    // make sure of it
+    unsigned long seconds = (gap + 500) / 1000;
+    anchorSeconds += seconds;
+    missedPulses += seconds - 1;
+    needCheck = true;
+  }
+  else
+  {
+    anchorSeconds++;
+  }
+  anchorMillis = m;
+  anchorMicros = micros();
+  edges++;
+}
@@ -0,0 +1,57 @@
+/*
+  RtcTimebase
+
+  Millisecond timestamps from the DS3231 without talking to it each time.
+
+  The DS3231's 1 Hz output falls as each second starts.  A pin change
+  interrupt notes millis() and micros() at that moment and counts the
+  second, so the time is just the count plus how long it has been since
+  the last edge: no I2C, and good to about a millisecond.
+
+  update() reads the RTC over I2C only to get the count started, after a
+  missed pulse, and once a minute to be sure no pulse was missed or
+  doubled.  If pulses stop altogether, millis() carries on alone and
+  pulsing() turns false.
+
+  The interrupt handler is for port A (A0 to A7), where the DS3231's
+  output reaches the Mayfly (A7).
+ */
+
+#ifndef RtcTimebase_h
+#define RtcTimebase_h
+
+#include <Arduino.h>
+
+class RtcTimebase
+{
+  public:
+  static const unsigned long CheckSeconds = 60;   // how often update() compares with the RTC
+
+  // Turn on the 1 Hz output and start watching it.  Returns false if the
+  // pin isn't on port A.  Call after rtc.begin().
+  static bool begin(uint8_t sqwPin);
+
+  // Call from loop()
+  static void update();
+
+  // Milliseconds since 1970
+  static uint64_t nowMs();
+
+  // The same, as a unix time and milliseconds into that second
+  static void now(uint32_t &seconds, uint16_t &millis);
+
+  // True once the count has been read from the RTC
+  static bool valid();
+
+  // True while pulses are arriving each second
+  static bool pulsing();
+
+  // How many pulses have been missed (or were extra) so far
+  static uint16_t missed();
+
+  // The RTC has just been set to this unix time.  Writing the seconds
+  // restarts its countdown, so this is the start of a new second.
+  static void restart(uint32_t seconds);
+};
+
+#endif
@@ -0,0 +1,125 @@
+#include "TimestampFormat.h"
+
+static const char weekDays[7][10] PROGMEM = {
+  "Sunday", "Monday", "Tuesday", "Wednesday", "Thursday", "Friday", "Saturday"};
+static const char months[12][10] PROGMEM = {
+  "January", "February", "March", "April", "May", "June",
+  "July", "August", "September", "October", "November", "December"};
+
+
+void epochToCivil(uint32_t epoch, CivilTime &t)
+{
+  uint32_t days = epoch / 86400UL;
+  uint32_t secs = epoch % 86400UL;
+
+  t.hour = secs / 3600;
+  t.minute = (secs / 60) % 60;
+  t.second = secs % 60;
+  t.weekday = (days + 4) % 7;   // 1970-01-01 was a Thursday
+
+  // Count from 0000-03-01, so the leap day is the last day of each year
+  // (Howard Hinnant's civil_from_days)
+  uint32_t z = days + 719468UL;
+  uint32_t era = z / 146097UL;
+  uint32_t dayOfEra = z - era * 146097UL;
+  uint32_t yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+  uint32_t dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+  uint32_t mp = (5 * dayOfYear + 2) / 153;
+
+  t.day = dayOfYear - (153 * mp + 2) / 5 + 1;
+  t.month = mp < 10 ? mp + 3 : mp - 9;
+  t.year = yearOfEra + era * 400 + (t.month <= 2 ? 1 : 0);
+}
+
+
+// Write a number with at least "digits" digits, zero padded
+static char *putNumber(char *p, uint16_t value, uint8_t digits)
+{
+  char reversed[5];
+  uint8_t n = 0;
+  do
+  {
+    reversed[n++] = '0' + value % 10;
+    value /= 10;
+  } while (value > 0 && n < sizeof(reversed));
+  while (n < digits)
+  {
+    reversed[n++] = '0';
+  }
+  while (n > 0)
+  {
+    *p++ = reversed[--n];
+  }
+  return p;
+}
+
+// Date and time joined by "separator": 2017-01-12T14:05:09
+static char *putDateTime(char *p, const CivilTime &t, char separator)
+{
+  p = putNumber(p, t.year, 4);
+  *p++ = '-';
+  p = putNumber(p, t.month, 2);
+  *p++ = '-';
+  p = putNumber(p, t.day, 2);
+  *p++ = separator;
+  p = putNumber(p, t.hour, 2);
+  *p++ = ':';
+  p = putNumber(p, t.minute, 2);
+  *p++ = ':';
+  p = putNumber(p, t.second, 2);
+  return p;
+}
+
+
+uint8_t formatISO8601(char *buffer, size_t size, const CivilTime &t)
+{
+  if (size < ISO8601_SIZE)
+  {
+    return 0;
+  }
+  char *p = putDateTime(buffer, t, 'T');
+  *p++ = 'Z';
+  *p = '\0';
+  return p - buffer;
+}
+
+
+uint8_t formatCSVTime(char *buffer, size_t size, const CivilTime &t)
+{
+  if (size < CSVTIME_SIZE)
+  {
+    return 0;
+  }
+  char *p = putDateTime(buffer, t, ' ');
+  *p = '\0';
+  return p - buffer;
+}
+
+
+uint8_t formatLongDate(char *buffer, size_t size, const CivilTime &t)
+{
+  if (size < LONGDATE_SIZE || t.weekday > 6 || t.month < 1 || t.month > 12)
+  {
+    return 0;
+  }
+  char *p = buffer;
+  strcpy_P(p, weekDays[t.weekday]);
+  p += strlen(p);
+  *p++ = ',';
+  *p++ = ' ';
+  strcpy_P(p, months[t.month - 1]);
+  p += strlen(p);
+  *p++ = ' ';
+  p = putNumber(p, t.day, 1);
+  *p++ = ',';
+  *p++ = ' ';
+  p = putNumber(p, t.year, 4);
+  *p++ = ' ';
+  p = putNumber(p, t.hour, 1);
+  *p++ = ':';
+  p = putNumber(p, t.minute, 2);
+  *p++ = ':';
+  p = putNumber(p, t.second, 2);
+  *p = '\0';
+  return p - buffer;
+}
@@ -0,0 +1,43 @@
+/*
+  TimestampFormat
+
+  Formats a Unix timestamp as text into a buffer you pass in, without
+  using String or the heap.  The weekday and month names are kept in
+  flash (PROGMEM) so they don't use any SRAM either.
+
+    ISO-8601:   2017-01-12T14:05:09Z
+    CSV:        2017-01-12 14:05:09
+    Long form:  Thursday, January 12, 2017 14:05:09
+
+  Each format function returns the number of characters written (not
+  counting the terminating '\0'), or 0 if the buffer is too small.
+ */
+
+#ifndef TimestampFormat_h
+#define TimestampFormat_h
+
+#include <Arduino.h>
+
+#define ISO8601_SIZE 21    // buffer size for formatISO8601(), '\0' included
+#define CSVTIME_SIZE 20    // buffer size for formatCSVTime()
+#define LONGDATE_SIZE 40   // big enough for any formatLongDate()
+
+struct CivilTime
+{
+  uint16_t year;
+  uint8_t month;     // 1 to 12
+  uint8_t day;       // 1 to 31
+  uint8_t hour;
+  uint8_t minute;
+  uint8_t second;
+  uint8_t weekday;   // 0 is Sunday
+};
+
+// Split seconds since 1970-01-01 00:00:00 into a calendar date and time
+void epochToCivil(uint32_t epoch, CivilTime &t);
+
+uint8_t formatISO8601(char *buffer, size_t size, const CivilTime &t);
+uint8_t formatCSVTime(char *buffer, size_t size, const CivilTime &t);
+uint8_t formatLongDate(char *buffer, size_t size, const CivilTime &t);
+
+#endif
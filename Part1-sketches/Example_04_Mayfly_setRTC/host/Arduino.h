@@ -0,0 +1,64 @@
+/*
+  Just enough of Arduino.h to build this sketch's helpers on a PC for the
+  tests in this folder.  PROGMEM is ordinary memory here, and the _P
+  functions are the plain ones.  millis() is a pretend clock the test
+  moves on by hand, and Print keeps what is printed so the test can read
+  it back.
+ */
+
+#ifndef Arduino_h
+#define Arduino_h
+
+#include <inttypes.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+
+#define PROGMEM
+#define strcpy_P strcpy
+
+#define HIGH 1
+#define LOW 0
+#define INPUT_PULLUP 2
+#define DEC 10
+
+class __FlashStringHelper;
+#define F(s) (reinterpret_cast<const __FlashStringHelper *>(s))
+
+class Print
+{
+  public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t c) = 0;
+
+  size_t print(const char *s) { size_t n = 0; while (*s) n += write(*s++); return n; }
+  size_t print(const __FlashStringHelper *s) { return print(reinterpret_cast<const char *>(s)); }
+  size_t print(char c) { return write(c); }
+  size_t print(int v, int = DEC) { char b[24]; snprintf(b, sizeof(b), "%d", v); return print(b); }
+  size_t print(unsigned v, int = DEC) { char b[24]; snprintf(b, sizeof(b), "%u", v); return print(b); }
+  size_t print(long v, int = DEC) { char b[24]; snprintf(b, sizeof(b), "%ld", v); return print(b); }
+  size_t print(unsigned long v, int = DEC) { char b[24]; snprintf(b, sizeof(b), "%lu", v); return print(b); }
+  size_t println() { return write('\n'); }
+  template <class T> size_t println(T v) { size_t n = print(v); return n + println(); }
+};
+
+class Stream : public Print
+{
+  public:
+  virtual int available() = 0;
+  virtual int read() = 0;
+};
+
+// The pretend clock is 32 bits, as the AVR's is, so millis() wraps round
+// after 49.7 days the same way here even where long is 64 bits.
+extern uint32_t hostMillis;
+
+inline unsigned long millis()
+{
+  return hostMillis;
+}
+
+#endif
@@ -0,0 +1,359 @@
+/*
+  ClockSyncTest
+
+  Runs ClockSync on a PC against a pretend DS3231 and a pretend PC at the
+  other end of the serial line, which answers each "Q<n>" the way
+  sync_clock_PC.py does after a random delay each way.  Checks that:
+
+  - "S" finds the RTC's error to within half the best round trip, and
+    sets the RTC so its seconds start in step with the PC's
+  - "C" afterwards finds it close to 0
+  - without the 1 Hz output the error is still found to the second
+  - lost and garbled replies are resent, and no reply at all fails
+  - a reply that comes after its request timed out is thrown away, not
+    paired with the next request
+  - "T" still works, with or without a line ending
+  - all of that holds with millis() wrapping round in the middle
+
+  Build and run from this folder:
+    g++ -std=c++11 -Wall -Wextra -I. -o ClockSyncTest ClockSyncTest.cpp ../ClockSync.cpp && ./ClockSyncTest
+ */
+
+#include <deque>
+#include "Arduino.h"
+#include <Sodaq_DS3231.h>
+#include "../ClockSync.h"
+#include "../RtcTimebase.h"
+
+// Everything runs off one simulated clock, in ms.  millis() starts
+// wherever the test likes; the PC and the RTC are fixed offsets from it.
+static int64_t simMs;
+static uint32_t millisStart;
+static int64_t pcOffset;       // PC time (ms since 1970) minus simMs
+static int64_t rtcOffset;      // the same for the RTC
+static bool rtcPulses;         // whether RtcTimebase sees the 1 Hz output
+static uint32_t restartedTo;
+
+uint32_t hostMillis;
+
+static void wait(int64_t ms)
+{
+  simMs += ms;
+  hostMillis = (uint32_t)(millisStart + simMs);
+}
+
+static int64_t pcMs() { return simMs + pcOffset; }
+static int64_t rtcMs() { return simMs + rtcOffset; }
+
+
+Sodaq_DS3231 rtc;
+
+DateTime Sodaq_DS3231::now()
+{
+  return DateTime((uint32_t)(rtcMs() / 1000));
+}
+
+void Sodaq_DS3231::setEpoch(uint32_t seconds)
+{
+  // Writing the seconds starts a whole new second
+  rtcOffset = (int64_t)seconds * 1000 - simMs;
+}
+
+bool RtcTimebase::valid() { return rtcPulses; }
+bool RtcTimebase::pulsing() { return rtcPulses; }
+uint64_t RtcTimebase::nowMs() { return rtcMs(); }
+void RtcTimebase::restart(uint32_t seconds) { restartedTo = seconds; }
+
+
+// The serial line and the PC at the far end of it
+class PcPort : public Stream
+{
+  public:
+  int maxDelay;        // each direction takes 1 to maxDelay ms
+  int dropEvery;       // ignore every nth "Q", 0 for none
+  int garbleEvery;     // answer every nth "Q" with rubbish
+  int lateEvery;       // answer every nth "Q" after the Mayfly gives up on it
+  int answered;
+  int minRoundTrip;
+  std::string line;    // the Mayfly's last complete line
+  std::string output;  // everything it has printed
+
+  void reset(int delay)
+  {
+    maxDelay = delay;
+    dropEvery = 0;
+    garbleEvery = 0;
+    lateEvery = 0;
+    answered = 0;
+    minRoundTrip = 1 << 30;
+    toMayfly.clear();
+    partial.clear();
+    line.clear();
+    output.clear();
+  }
+
+  void send(const char *s, int64_t at)
+  {
+    for (; *s; s++)
+    {
+      toMayfly.push_back(Byte { at, *s });
+    }
+  }
+
+  int available()
+  {
+    return !toMayfly.empty() && toMayfly.front().at <= simMs;
+  }
+
+  int read()
+  {
+    char c = toMayfly.front().c;
+    toMayfly.pop_front();
+    return c;
+  }
+
+  size_t write(uint8_t c)
+  {
+    output += (char)c;
+    if (c != '\n')
+    {
+      partial += (char)c;
+      return 1;
+    }
+    line = partial;
+    partial.clear();
+    if (line[0] == 'Q')
+    {
+      answer(line.substr(1));
+    }
+    return 1;
+  }
+
+  private:
+  struct Byte
+  {
+    int64_t at;
+    char c;
+  };
+  std::deque<Byte> toMayfly;
+  std::string partial;
+
+  // Stamp the Q on arrival and reply a millisecond later, with its number
+  void answer(const std::string &id)
+  {
+    answered++;
+    if (dropEvery && answered % dropEvery == 0)
+    {
+      return;
+    }
+    int up = 1 + rand() % maxDelay;
+    int down = 1 + rand() % maxDelay;
+    int64_t t2 = pcMs() + up;
+    int64_t t3 = t2 + 1;
+    if (lateEvery && answered % lateEvery == 0)
+    {
+      // Arrive just after the Mayfly gives up and sends the next Q
+      down = ClockSync::ReplyTimeoutMs - up;
+    }
+    char reply[64];
+    if (garbleEvery && answered % garbleEvery == 0)
+    {
+      snprintf(reply, sizeof(reply), "R%s,%" PRId64 "x\n", id.c_str(), t2);
+    }
+    else
+    {
+      snprintf(reply, sizeof(reply), "R%s,%" PRId64 ",%" PRId64 "\n", id.c_str(), t2, t3);
+      if (up + down < minRoundTrip)
+      {
+        minRoundTrip = up + down;
+      }
+    }
+    send(reply, simMs + up + 1 + down);
+  }
+};
+
+static PcPort port;
+static int failures = 0;
+
+static void fail(const char *test, const char *what)
+{
+  printf("FAIL %s: %s\n", test, what);
+  printf("  Mayfly said:\n%s", port.output.c_str());
+  failures++;
+}
+
+
+// Start fresh: millis() at start, the RTC errorMs ms off the PC
+static void setUp(uint32_t start, int64_t errorMs, bool pulses, int maxDelay)
+{
+  simMs = 0;
+  millisStart = start;
+  hostMillis = start;
+  pcOffset = 1700000000LL * 1000 + 777;
+  rtcOffset = pcOffset + errorMs;
+  rtcPulses = pulses;
+  restartedTo = 0;
+  port.reset(maxDelay);
+}
+
+// Send a command and run update() every millisecond until it finishes
+static bool run(ClockSync &sync, const char *command, int64_t limitMs)
+{
+  port.output.clear();
+  port.send(command, simMs);
+  for (int64_t end = simMs + limitMs; simMs < end; wait(1))
+  {
+    if (sync.update())
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+static int64_t distance(int64_t a, int64_t b)
+{
+  return a > b ? a - b : b - a;
+}
+
+
+// "S" then "C", checking both against the true error
+static void testSync(const char *test, uint32_t start, int64_t errorMs, bool pulses, int maxDelay)
+{
+  setUp(start, errorMs, pulses, maxDelay);
+  ClockSync sync(port);
+
+  if (!run(sync, "S\n", 20000) || sync.result() != ClockSync::SYNCED)
+  {
+    fail(test, "sync didn't finish");
+    return;
+  }
+  // The best exchange can be out by half its round trip, plus rounding
+  int64_t slack = port.minRoundTrip / 2 + 2;
+  if (sync.errorExact() != pulses)
+  {
+    fail(test, "wrong errorExact()");
+  }
+  int64_t low = errorMs - slack - (pulses ? 0 : 999);   // to the second it reads low
+  if (sync.errorMs() < low || sync.errorMs() > errorMs + slack)
+  {
+    fail(test, "wrong error reported");
+  }
+  if (distance(rtcMs(), pcMs()) > slack)
+  {
+    fail(test, "RTC not set in step with the PC");
+  }
+  if (sync.setTo() != restartedTo || (int64_t)sync.setTo() * 1000 != rtcMs() - rtcMs() % 1000)
+  {
+    fail(test, "setTo() isn't what the RTC was set to");
+  }
+
+  int64_t nowError = rtcMs() - pcMs();
+  port.minRoundTrip = 1 << 30;
+  wait(1500);
+  if (!run(sync, "C\n", 20000) || sync.result() != ClockSync::CHECKED)
+  {
+    fail(test, "check didn't finish");
+    return;
+  }
+  slack = port.minRoundTrip / 2 + 2;
+  low = nowError - slack - (pulses ? 0 : 999);
+  if (sync.errorMs() < low || sync.errorMs() > nowError + slack || rtcMs() - pcMs() != nowError)
+  {
+    fail(test, "check wrong, or it changed the RTC");
+  }
+}
+
+
+static void testLostReplies()
+{
+  setUp(123456, -2345, true, 10);
+  ClockSync sync(port);
+  port.dropEvery = 3;
+  port.garbleEvery = 4;
+  if (!run(sync, "S\n", 30000) || sync.result() != ClockSync::SYNCED ||
+    distance(rtcMs(), pcMs()) > port.minRoundTrip / 2 + 2)
+  {
+    fail("lost replies", "sync didn't survive lost and garbled replies");
+  }
+
+  // Every other reply turns up a millisecond after the next request.
+  // Paired with that one's t1, it would look like the quickest exchange of
+  // all, with the offset a second out.
+  setUp(123456, -2345, true, 10);
+  port.lateEvery = 2;
+  if (!run(sync, "S\n", 30000) || sync.result() != ClockSync::SYNCED ||
+    distance(rtcMs(), pcMs()) > port.minRoundTrip / 2 + 2)
+  {
+    fail("late replies", "a late reply was taken for the next request's");
+  }
+
+  setUp(123456, -2345, true, 10);
+  port.dropEvery = 1;
+  int64_t before = rtcMs() - pcMs();
+  if (!run(sync, "S\n", 30000) || sync.result() != ClockSync::FAILED ||
+    port.line != "Sync failed: no reply from the PC" || rtcMs() - pcMs() != before)
+  {
+    fail("no replies", "a sync with no PC didn't fail cleanly");
+  }
+  if (simMs < 2 * ClockSync::Exchanges * (int64_t)ClockSync::ReplyTimeoutMs)
+  {
+    fail("no replies", "gave up before trying every request");
+  }
+}
+
+
+static void testTimeCommand()
+{
+  setUp(5000, 500000, false, 5);
+  ClockSync sync(port);
+
+  if (!run(sync, "T1451606400\n", 1000) || sync.result() != ClockSync::SET_BY_HAND ||
+    sync.setTo() != 1451606400UL || rtcMs() != 1451606400LL * 1000)
+  {
+    fail("T", "T with a line ending didn't set the RTC");
+  }
+
+  wait(1000);
+  if (!run(sync, "T1600000000", 1000) || sync.result() != ClockSync::SET_BY_HAND ||
+    rtcMs() != 1600000000LL * 1000 || simMs < 1000 + (int64_t)ClockSync::QuietMs)
+  {
+    fail("T", "T without a line ending didn't set the RTC after the quiet time");
+  }
+
+  int64_t before = rtcMs();
+  if (!run(sync, "T123\n", 1000) || sync.result() != ClockSync::FAILED ||
+    port.line != "Time out of range" || rtcMs() != before)
+  {
+    fail("T", "an out of range time wasn't refused");
+  }
+}
+
+
+int main()
+{
+  srand(1);
+
+  testSync("sync", 5000, -3210, true, 10);
+  testSync("sync, RTC fast", 5000, 59876, true, 30);
+  testSync("sync, no 1 Hz", 5000, -3210, false, 10);
+  testSync("sync, quick line", 5000, 1, true, 1);
+  for (int i = 0; i < 200; i++)
+  {
+    int64_t errorMs = (int64_t)(rand() % 200001) - 100000;
+    testSync("sync, random", rand(), errorMs, rand() & 1, 1 + rand() % 50);
+  }
+
+  // millis() wraps round during the exchanges, and while waiting for the
+  // PC's next second
+  for (uint32_t before = 0; before < 12000; before += 50)
+  {
+    testSync("millis() wrap", 0xFFFFFFFFUL - before, -3210, before & 64, 10);
+  }
+
+  testLostReplies();
+  testTimeCommand();
+
+  printf(failures ? "FAILED\n" : "PASSED\n");
+  return failures ? 1 : 0;
+}
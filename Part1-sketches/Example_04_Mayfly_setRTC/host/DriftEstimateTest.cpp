@@ -0,0 +1,137 @@
+/*
+  DriftEstimateTest
+
+  Checks the pieces of DriftEstimate.h against hand-worked numbers, then
+  simulates a thousand DS3231s, each with its own crystal error and a
+  per-count aging effect a little off the datasheet's 0.1 ppm.  Each one is
+  synced every one to seven days with a few ms of sync error, and its aging
+  offset set from the estimate after every sync, as DriftTracker does.
+  Within ten syncs every clock has to be running within one count of
+  perfect, and stay there.
+
+  Build and run from this folder:
+    g++ -std=c++11 -Wall -I.. -o DriftEstimateTest DriftEstimateTest.cpp && ./DriftEstimateTest
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "DriftEstimate.h"
+
+static int failures = 0;
+
+static void expect(bool ok, const char *what)
+{
+  if (!ok)
+  {
+    printf("FAIL %s\n", what);
+    failures++;
+  }
+}
+
+static double randomBetween(double low, double high)
+{
+  return low + (high - low) * rand() / RAND_MAX;
+}
+
+
+static void testPieces()
+{
+  DriftSample day = { 86400, 291, 0 };
+  expect(driftSampleRatePpb(day) == 3368, "291 ms a day is 3368 ppb");
+  DriftSample slow = { 604800, -3024, 5 };
+  expect(driftSampleRatePpb(slow) == -5000, "-3024 ms a week is -5000 ppb");
+
+  expect(driftAgingFor(0) == 0, "aging for 0");
+  expect(driftAgingFor(149) == 1 && driftAgingFor(150) == 2, "aging rounds to nearest");
+  expect(driftAgingFor(-149) == -1 && driftAgingFor(-150) == -2, "aging rounds negative rates");
+  expect(driftAgingFor(50000) == 127 && driftAgingFor(-50000) == -128, "aging clamps");
+
+  DriftHistory h = {};
+  expect(driftEstimatePpb(h) == 0, "empty history estimates 0");
+  DriftSample shortGap = { DRIFT_MIN_INTERVAL - 1, 10, 0 };
+  expect(!driftAddSample(h, shortGap) && h.count == 0, "short interval refused");
+  DriftSample setByHand = { 86400, 100000, 0 };   // 1157 ppm: not drift
+  expect(!driftAddSample(h, setByHand) && h.count == 0, "unbelievable rate refused");
+
+  // Aging 10 slowed it by 1000 ppb, so the crystal itself runs at 4368
+  DriftSample aged = { 86400, 291, 10 };
+  expect(driftAddSample(h, aged) && driftEstimatePpb(h) == 4368, "aging added back");
+
+  // A week outweighs an hour 28224 to 1
+  DriftHistory mixed = {};
+  DriftSample hour = { 3600, 36, 0 };            // 10000 ppb
+  DriftSample week = { 604800, 604, 0 };         // 998 ppb
+  driftAddSample(mixed, hour);
+  driftAddSample(mixed, week);
+  expect(driftEstimatePpb(mixed) == 998 + (10000 - 998) / 28225, "weighted by interval squared");
+
+  // The ninth sample overwrites the first
+  DriftHistory full = {};
+  DriftSample fast = { 86400, 864, 0 };          // 10000 ppb
+  DriftSample steady = { 86400, 86, 0 };         // 995 ppb
+  driftAddSample(full, fast);
+  for (int i = 0; i < DRIFT_HISTORY_SIZE; i++)
+  {
+    driftAddSample(full, steady);
+  }
+  expect(full.count == DRIFT_HISTORY_SIZE && driftEstimatePpb(full) == 995, "oldest sample dropped");
+}
+
+
+// One clock synced again and again.  Returns the worst rate it ran at,
+// in ppb, from the tenth sync on.
+static double simulateClock(double crystalPpb, double perCountPpb)
+{
+  DriftHistory h = {};
+  int8_t aging = 0;
+  double worst = 0;
+  for (int sync = 1; sync <= 30; sync++)
+  {
+    uint32_t interval = 86400 + rand() % (6 * 86400);
+    double ratePpb = crystalPpb - perCountPpb * aging;
+    if (sync > 10 && fabs(ratePpb) > worst)
+    {
+      worst = fabs(ratePpb);
+    }
+    // The drift, plus up to 5 ms each from this sync and the one before
+    double errorMs = ratePpb * interval / 1e6 + randomBetween(-10, 10);
+    DriftSample s = { interval, (int32_t)lround(errorMs), aging };
+    driftAddSample(h, s);
+    aging = driftAgingFor(driftEstimatePpb(h));
+  }
+  return worst;
+}
+
+static void testConvergence()
+{
+  double worstOff = 0;
+  for (int i = 0; i < 1000; i++)
+  {
+    double crystalPpb = randomBetween(-10000, 10000);
+    double perCountPpb = randomBetween(90, 110);
+    // Within one count of 0, and a bit for the sync errors
+    double off = simulateClock(crystalPpb, perCountPpb) / perCountPpb;
+    if (off > worstOff)
+    {
+      worstOff = off;
+    }
+    if (off > 1.1)
+    {
+      printf("FAIL crystal %+.0f ppb, %.1f ppb per count: still %.2f counts off\n",
+        crystalPpb, perCountPpb, off);
+      failures++;
+    }
+  }
+  printf("Worst clock after ten syncs: %.2f counts of aging off\n", worstOff);
+}
+
+
+int main()
+{
+  srand(1);
+  testPieces();
+  testConvergence();
+  printf(failures ? "FAILED\n" : "PASSED\n");
+  return failures ? 1 : 0;
+}
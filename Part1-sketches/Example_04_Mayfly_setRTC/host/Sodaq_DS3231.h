@@ -0,0 +1,30 @@
+/*
+  A pretend DS3231 for the tests in this folder: its time is the test's
+  hostRtcMs, which runs on with millis() once the test has set it.
+ */
+
+#ifndef Sodaq_DS3231_h
+#define Sodaq_DS3231_h
+
+#include <Arduino.h>
+
+class DateTime
+{
+  public:
+  DateTime(uint32_t seconds) : seconds(seconds) {}
+  uint32_t getEpoch() const { return seconds; }
+
+  private:
+  uint32_t seconds;
+};
+
+class Sodaq_DS3231
+{
+  public:
+  DateTime now();
+  void setEpoch(uint32_t seconds);
+};
+
+extern Sodaq_DS3231 rtc;
+
+#endif
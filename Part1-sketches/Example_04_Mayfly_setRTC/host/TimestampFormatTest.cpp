@@ -0,0 +1,85 @@
+/*
+  TimestampFormatTest
+
+  Checks epochToCivil() against the C library's gmtime() for dates from
+  1970 to the end of the 32-bit epoch in 2106, and the three formats
+  against known strings.
+
+  Build and run from this folder:
+    g++ -std=c++11 -Wall -I. -o TimestampFormatTest TimestampFormatTest.cpp ../TimestampFormat.cpp && ./TimestampFormatTest
+ */
+
+#include <time.h>
+#include "Arduino.h"
+#include "../TimestampFormat.h"
+
+static int failures = 0;
+
+static void expect(const char *got, const char *wanted)
+{
+  if (strcmp(got, wanted) != 0)
+  {
+    printf("FAIL format: got \"%s\", expected \"%s\"\n", got, wanted);
+    failures++;
+  }
+}
+
+static void checkEpoch(uint32_t epoch)
+{
+  CivilTime t;
+  epochToCivil(epoch, t);
+
+  time_t seconds = epoch;
+  struct tm *g = gmtime(&seconds);
+  if (t.year != g->tm_year + 1900 || t.month != g->tm_mon + 1 || t.day != g->tm_mday ||
+    t.hour != g->tm_hour || t.minute != g->tm_min || t.second != g->tm_sec ||
+    t.weekday != g->tm_wday)
+  {
+    if (failures < 10)
+    {
+      printf("FAIL epochToCivil(%u): %04u-%02u-%02u %02u:%02u:%02u day %u\n", epoch,
+        t.year, t.month, t.day, t.hour, t.minute, t.second, t.weekday);
+    }
+    failures++;
+  }
+}
+
+
+int main()
+{
+  // Every day's first and last second, and a wandering time of day
+  for (uint64_t day = 0; day * 86400 <= 0xFFFFFFFFULL; day++)
+  {
+    checkEpoch(day * 86400);
+    if (day * 86400 + 86399 <= 0xFFFFFFFFULL)
+    {
+      checkEpoch(day * 86400 + 86399);
+    }
+    checkEpoch((uint32_t)(day * 86400 + (day * 7919) % 86400));
+  }
+  checkEpoch(0xFFFFFFFFUL);
+
+  char buffer[LONGDATE_SIZE];
+  CivilTime t;
+  epochToCivil(1484230009UL, t);
+  formatISO8601(buffer, sizeof(buffer), t);
+  expect(buffer, "2017-01-12T14:06:49Z");
+  formatCSVTime(buffer, sizeof(buffer), t);
+  expect(buffer, "2017-01-12 14:06:49");
+  formatLongDate(buffer, sizeof(buffer), t);
+  expect(buffer, "Thursday, January 12, 2017 14:06:49");
+
+  epochToCivil(951782400UL, t);   // a leap day in a century year
+  formatLongDate(buffer, sizeof(buffer), t);
+  expect(buffer, "Tuesday, February 29, 2000 0:00:00");
+
+  if (formatISO8601(buffer, ISO8601_SIZE - 1, t) != 0 ||
+    formatCSVTime(buffer, CSVTIME_SIZE - 1, t) != 0)
+  {
+    printf("FAIL format: wrote into a buffer that was too small\n");
+    failures++;
+  }
+
+  printf(failures ? "FAILED\n" : "PASSED\n");
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,128 @@
+#!/usr/bin/env python
+"""
+Runs sync_clock_PC.py against a pretend Mayfly on a pseudo-terminal.
+
+The pretend Mayfly's clock is a known amount behind the computer's.  It
+makes the same Q/R exchanges as ClockSync and works out its offset from
+the replies, so this checks that the script stamps and answers each "Q"
+straight away and in the right format, with the request's number, and
+stops at the report line.
+Needs Linux or macOS for the pty; pyserial isn't needed.
+
+Run from this folder:  python3 sync_clock_pty_test.py
+"""
+
+from __future__ import print_function
+
+import os
+import pty
+import select
+import sys
+import threading
+import time
+import tty
+import types
+
+# The script only needs pyserial to open a real port
+sys.modules.setdefault("serial", types.ModuleType("serial"))
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), ".."))
+import sync_clock_PC as tool
+
+SKEW = -2.345       # the pretend Mayfly's clock minus the computer's, in s
+EXCHANGES = 8
+
+
+class Port(object):
+    """One end of the pty, with a short read timeout like pyserial's."""
+    def __init__(self, fd):
+        self.fd = fd
+
+    def read(self, n):
+        ready, _, _ = select.select([self.fd], [], [], 0.05)
+        return os.read(self.fd, n) if ready else b""
+
+    def write(self, data):
+        os.write(self.fd, data)
+
+    def flushInput(self):
+        pass
+
+
+def mayfly(port, answer, result):
+    """Wait for a command, then do what ClockSync does with it."""
+    while True:
+        c = port.read(1)
+        if c in (b"S", b"C"):
+            break
+    if not answer:
+        return
+
+    best = None
+    for n in range(1, EXCHANGES + 1):
+        t1 = time.time() + SKEW
+        port.write(b"Q%d\n" % n)
+        line = b""
+        while True:
+            c = port.read(1)
+            if c == b"R" and not line:
+                t4 = time.time() + SKEW
+            if c == b"\n":
+                if line:
+                    break
+                continue    # the end of the command's line
+            line += c
+        n_back, t2, t3 = [int(x) for x in line[1:].split(b",")]
+        if n_back != n:
+            return      # the script's side then times out and fails
+        t2, t3 = t2 / 1000.0, t3 / 1000.0
+        round_trip = (t4 - t1) - (t3 - t2)
+        offset = ((t2 - t1) + (t3 - t4)) / 2
+        if best is None or round_trip < best[0]:
+            best = (round_trip, offset)
+    result.append(best)
+    port.write(("Sync: RTC set, it was off by %+.3f s, round trip %d ms\n"
+                % (-best[1], best[0] * 1000)).encode("ascii"))
+
+
+def exchange(answer):
+    """Run the script's side against a fresh pretend Mayfly."""
+    master, slave = pty.openpty()
+    tty.setraw(master)
+    tty.setraw(slave)
+    result = []
+    thread = threading.Thread(target=mayfly, args=(Port(master), answer, result))
+    thread.daemon = True
+    thread.start()
+    ok = tool.run(Port(slave), "S", 0.0, 3)
+    thread.join(1)
+    os.close(master)
+    os.close(slave)
+    return ok, result
+
+
+def main():
+    failures = 0
+
+    ok, result = exchange(True)
+    if not ok or not result:
+        print("FAIL sync: the script didn't finish the exchanges")
+        failures += 1
+    else:
+        round_trip, offset = result[0]
+        # The offset can be out by half the round trip, plus the 1 ms steps
+        if round_trip < 0 or abs(offset + SKEW) > round_trip / 2 + 0.002:
+            print("FAIL sync: offset %+.4f s, round trip %.4f s, expected %+.3f s"
+                  % (offset, round_trip, -SKEW))
+            failures += 1
+
+    ok, result = exchange(False)
+    if ok:
+        print("FAIL no answer: a silent Mayfly counted as a success")
+        failures += 1
+
+    print("FAILED" if failures else "PASSED")
+    return 1 if failures else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,103 @@
+#!/usr/bin/env python
+"""
+Synchronize the RTC of a Mayfly running Example_04_Mayfly_setRTC.ino.
+
+Sends "S" to start a sync, then answers each "Q<n>" from the Mayfly with
+"R<n>,<received>,<sent>": the request's own number, so the Mayfly can
+tell a late reply from the one it is waiting for, then both times in
+milliseconds since 1970 (UTC).  The Mayfly
+works out the round trip and its offset from those, sets its RTC on the
+next whole second, and prints how far off it was.  Afterwards a "C" asks
+it to measure the offset again without changing anything.
+
+The time comes from the computer's clock, corrected by NTP when ntplib is
+installed and the internet can be reached.
+
+Usage:  python sync_clock_PC.py PORT [--baud 57600] [--no-ntp] [--no-check]
+"""
+
+from __future__ import print_function
+
+import argparse
+import sys
+import time
+
+import serial
+
+try:
+    import ntplib
+except ImportError:
+    ntplib = None
+
+
+def ntp_offset(server):
+    """Seconds to add to time.time() to get NTP time, or 0 if unavailable."""
+    if ntplib is None:
+        return 0.0
+    try:
+        return ntplib.NTPClient().request(server, version=3, timeout=2).offset
+    except Exception as e:
+        print("NTP unavailable (%s), using the computer's clock" % e)
+        return 0.0
+
+
+def run(port, command, offset, timeout):
+    """Send a command and answer the Mayfly's requests until it reports."""
+    if hasattr(port, "reset_input_buffer"):
+        port.reset_input_buffer()
+    else:
+        port.flushInput()   # pyserial 2.7
+    port.write(command.encode("ascii") + b"\n")
+
+    line = b""
+    deadline = time.time() + timeout
+    while time.time() < deadline:
+        c = port.read(1)
+        if not c:
+            continue
+        if c == b"Q":
+            # Stamp the request as soon as its first byte is seen
+            received = int(round((time.time() + offset) * 1000))
+        if c != b"\n":
+            line += c
+            continue
+
+        text = line.decode("ascii", "replace").strip()
+        line = b""
+        if text[:1] == "Q" and text[1:].isdigit():
+            sent = int(round((time.time() + offset) * 1000))
+            port.write(("R%s,%d,%d\n" % (text[1:], received, sent)).encode("ascii"))
+        elif text:
+            print(text)
+            if text.startswith("Sync") or text.startswith("Check"):
+                return "failed" not in text
+    print("No answer from the Mayfly")
+    return False
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument("port", help="serial port, like COM3 or /dev/ttyUSB0")
+    parser.add_argument("--baud", type=int, default=57600)
+    parser.add_argument("--ntp-server", default="pool.ntp.org")
+    parser.add_argument("--no-ntp", action="store_true", help="use the computer's clock as it is")
+    parser.add_argument("--no-check", action="store_true", help="don't re-measure after setting")
+    args = parser.parse_args()
+
+    offset = 0.0 if args.no_ntp else ntp_offset(args.ntp_server)
+    print("Computer clock correction: %+.3f s" % offset)
+
+    port = serial.Serial(args.port, args.baud, timeout=0.05)
+    # Opening the port resets the Mayfly; give the bootloader time to finish
+    time.sleep(3)
+
+    ok = run(port, "S", offset, 10)
+    if ok and not args.no_check:
+        time.sleep(1.5)
+        ok = run(port, "C", offset, 10)
+    port.close()
+    return 0 if ok else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
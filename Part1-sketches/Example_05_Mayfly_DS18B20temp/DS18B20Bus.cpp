@@ -0,0 +1,201 @@
+#include "DS18B20Bus.h"
+
+#define DS18B20_FAMILY          0x28
+#define DS18B20_CONVERT         0x44
+#define DS18B20_WRITE_SCRATCH   0x4E
+#define DS18B20_READ_SCRATCH    0xBE
+#define DS18B20_READ_POWER      0xB4
+
+// Conversion time in ms for 9, 10, 11 and 12 bits
+static const uint16_t conversionMillis[4] = {94, 188, 375, 750};
+
+
+DS18B20Bus::DS18B20Bus(OneWire &bus) : wire(bus)
+{
+  count = 0;
+  parasite = false;
+  state = IDLE;
+}
+
+
+uint8_t DS18B20Bus::begin()
+{
+  uint8_t address[8];
+
+  count = 0;
+  wire.reset_search();
+  while (count < DS18B20_MAX_SENSORS && wire.search(address))
+  {
+    if (address[0] != DS18B20_FAMILY || OneWire::crc8(address, 7) != address[7])
+    {
+      continue;
+    }
+    memcpy(addresses[count], address, 8);
+    valid[count] = false;
+
+    // Read the resolution the sensor powered up with
+    uint8_t data[9];
+    resolution[count] = 12;
+    if (readScratchpad(count, data))
+    {
+      resolution[count] = 9 + ((data[4] >> 5) & 0x03);
+    }
+    count++;
+  }
+
+  // Any parasite-powered sensor pulls the bus low during this read
+  wire.reset();
+  wire.skip();
+  wire.write(DS18B20_READ_POWER);
+  parasite = (wire.read_bit() == 0);
+
+  return count;
+}
+
+
+uint8_t DS18B20Bus::getCount()
+{
+  return count;
+}
+
+
+bool DS18B20Bus::setResolution(uint8_t index, uint8_t bits)
+{
+  if (index >= count || bits < 9 || bits > 12 || state != IDLE)
+  {
+    return false;
+  }
+
+  // Keep the alarm thresholds (bytes 2 and 3) as they are
+  uint8_t data[9];
+  if (!readScratchpad(index, data))
+  {
+    return false;
+  }
+
+  wire.reset();
+  wire.select(addresses[index]);
+  wire.write(DS18B20_WRITE_SCRATCH);
+  wire.write(data[2]);
+  wire.write(data[3]);
+  wire.write(((bits - 9) << 5) | 0x1F);
+
+  resolution[index] = bits;
+  return true;
+}
+
+
+bool DS18B20Bus::startConversion()
+{
+  if (state != IDLE || count == 0)
+  {
+    return false;
+  }
+
+  // The whole bus has to wait for the slowest sensor
+  uint8_t maxBits = 9;
+  for (uint8_t i = 0; i < count; i++)
+  {
+    if (resolution[i] > maxBits)
+    {
+      maxBits = resolution[i];
+    }
+  }
+  convertMillis = conversionMillis[maxBits - 9];
+
+  wire.reset();
+  wire.skip();
+  wire.write(DS18B20_CONVERT, parasite);   // keep the bus powered for parasite sensors
+  convertStart = millis();
+  state = CONVERTING;
+  return true;
+}
+
+
+bool DS18B20Bus::update()
+{
+  switch (state)
+  {
+    case IDLE:
+      return false;
+
+    case CONVERTING:
+      // Sensors with their own power hold the bus low until they finish,
+      // so we may be able to stop waiting early.  Parasite sensors need the
+      // bus held high, so for those we can only wait out the time.
+      if (millis() - convertStart < convertMillis && (parasite || wire.read_bit() == 0))
+      {
+        return false;
+      }
+      if (parasite)
+      {
+        wire.depower();
+      }
+      readIndex = 0;
+      state = READING;
+      return false;
+
+    case READING:
+    {
+      // One sensor per call, so loop() keeps running between them
+      uint8_t data[9];
+      valid[readIndex] = readScratchpad(readIndex, data);
+      if (valid[readIndex])
+      {
+        // Bits below the resolution are undefined, so clear them
+        int16_t value = (int16_t)(data[1] << 8 | data[0]);
+        raw[readIndex] = value & ~((1 << (12 - resolution[readIndex])) - 1);
+      }
+      readIndex++;
+      if (readIndex < count)
+      {
+        return false;
+      }
+      state = IDLE;
+      return true;
+    }
+  }
+  return false;
+}
+
+
+bool DS18B20Bus::busy()
+{
+  return state != IDLE;
+}
+
+
+bool DS18B20Bus::isValid(uint8_t index)
+{
+  return index < count && valid[index];
+}
+
+
+int16_t DS18B20Bus::getCentiC(uint8_t index)
+{
+  return (int32_t)raw[index] * 100 / 16;
+}
+
+
+const uint8_t *DS18B20Bus::getAddress(uint8_t index)
+{
+  return addresses[index];
+}
+
+
+bool DS18B20Bus::readScratchpad(uint8_t index, uint8_t *data)
+{
+  if (!wire.reset())
+  {
+    return false;   // nobody answered
+  }
+  wire.select(addresses[index]);
+  wire.write(DS18B20_READ_SCRATCH);
+  for (uint8_t i = 0; i < 9; i++)
+  {
+    data[i] = wire.read();
+  }
+
+  // A missing sensor reads as all ones, which fails the CRC too
+  return OneWire::crc8(data, 8) == data[8];
+}
@@ -0,0 +1,72 @@
+/*
+  DS18B20Bus
+
+  Reads every DS18B20 on a OneWire bus without blocking loop().
+
+  begin() searches the bus once and remembers each sensor's ROM address,
+  so later reads go straight to each sensor instead of searching again.
+  startConversion() tells every sensor to convert at once with a single
+  skip-ROM command, then update() returns straight away until the
+  conversion is finished.  After that it reads one scratchpad per call,
+  checks its CRC, and returns true when the whole sweep is done.
+
+  A sweep takes one conversion period for the slowest resolution on the
+  bus (94 ms at 9 bits up to 750 ms at 12 bits), however many sensors
+  there are.
+ */
+
+#ifndef DS18B20Bus_h
+#define DS18B20Bus_h
+
+#include <Arduino.h>
+#include <OneWire.h>
+
+#define DS18B20_MAX_SENSORS 12
+
+class DS18B20Bus
+{
+  OneWire &wire;
+
+  uint8_t count;
+  uint8_t addresses[DS18B20_MAX_SENSORS][8];
+  uint8_t resolution[DS18B20_MAX_SENSORS];   // 9 to 12 bits
+  int16_t raw[DS18B20_MAX_SENSORS];          // last reading, 1/16 degree C
+  bool valid[DS18B20_MAX_SENSORS];           // last reading passed its CRC
+  bool parasite;                             // some sensor has no VDD
+
+  enum { IDLE, CONVERTING, READING } state;
+  unsigned long convertStart;
+  uint16_t convertMillis;
+  uint8_t readIndex;
+
+  public:
+  DS18B20Bus(OneWire &bus);
+
+  // Find the DS18B20s on the bus.  Returns how many there are.
+  uint8_t begin();
+  uint8_t getCount();
+
+  // Set a sensor's resolution (9 to 12 bits).  Fewer bits convert faster.
+  bool setResolution(uint8_t index, uint8_t bits);
+
+  // Start converting on every sensor.  Returns false if a sweep is
+  // already running, or there are no sensors.
+  bool startConversion();
+
+  // Call every time through loop().  Returns true once when a sweep has
+  // finished and new temperatures are available.
+  bool update();
+
+  // True from startConversion() until the sweep finishes
+  bool busy();
+
+  // The results of the last sweep
+  bool isValid(uint8_t index);
+  int16_t getCentiC(uint8_t index);   // hundredths of a degree C
+  const uint8_t *getAddress(uint8_t index);
+
+  private:
+  bool readScratchpad(uint8_t index, uint8_t *data);
+};
+
+#endif
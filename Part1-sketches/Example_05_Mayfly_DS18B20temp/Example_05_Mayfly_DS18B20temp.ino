@@ -1,7 +1,7 @@
 /********************************************************************/
 // First we include the libraries
 #include <OneWire.h>
-#include <DallasTemperature.h>
+#include "DS18B20Bus.h"   // Reads every DS18B20 on the bus without waiting
 /********************************************************************/
 // Data wire is plugged into pin 7 on the Arduino
 #define ONE_WIRE_BUS 7 // For EnviroDIY Mayfly, I am using digital pin 7.
@@ -10,44 +10,131 @@
 // (not just Maxim/Dallas temperature ICs)
 OneWire oneWire(ONE_WIRE_BUS);
 /********************************************************************/
-// Pass our oneWire reference to Dallas Temperature.
-DallasTemperature sensors(&oneWire);
+// Pass our oneWire reference to the DS18B20 reader.
+DS18B20Bus sensors(oneWire);
 /********************************************************************/
 
 #include <Arduino.h>
+#include "PowerRail.h"   // Powers the Grove sockets only while the sensors are read
 
 // define conversion factor for miliseconds to seconds (multiply by 1000)
 int time_conversion_factor = 1000;
 int delaytime = 5 * time_conversion_factor;
 
 const int8_t switchedPower = 22;  // Pin to switch power on and off (-1 if unconnected)
+PowerRail rail(switchedPower);
+
+// DS18B20s are ready almost as soon as they have power
+const uint16_t DS18B20WarmupMs = 20;
+
+// Resolution for every probe: 9 bits (0.5 C) converts in 94 ms,
+// 12 bits (0.0625 C) takes 750 ms
+const uint8_t resolutionBits = 12;
+
+unsigned long lastRequest = 0;
+bool requested = false;
+uint8_t found = 0;
+
+// After each power-up: the sensors are back at their default 12 bits
+void sensorsPowered()
+{
+ found = sensors.begin();
+ for (uint8_t i = 0; i < found; i++)
+ {
+   sensors.setResolution(i, resolutionBits);
+ }
+}
 
 
 void setup()
 {
- // Turn on switched power
- pinMode(switchedPower, OUTPUT);
- digitalWrite(switchedPower, HIGH);
- delay(delaytime);
+ // The sensors are only powered while being read
+ rail.addDevice(DS18B20WarmupMs, sensorsPowered);
+ rail.addPin(ONE_WIRE_BUS);
+ rail.begin();
 
  // start serial port
  Serial.begin(57600);
  Serial.println("DS18B20 One Wire Temperature Demo");
- // Start up the library
- sensors.begin();
+ // Find every sensor on the bus
+ rail.powerUpAndWait();
+ Serial.print("Found ");
+ Serial.print(found);
+ Serial.println(" sensors");
+ rail.powerDown();
 }
+
+// Print a ROM address as hex, like 28FF641E8416039A
+void printAddress(const uint8_t *address)
+{
+ for (uint8_t i = 0; i < 8; i++)
+ {
+   if (address[i] < 16) Serial.print('0');
+   Serial.print(address[i], HEX);
+ }
+}
+
 void loop()
 {
- // call sensors.requestTemperatures() to issue a global temperature
- // request to all devices on the bus
+ // Every delaytime, power the sensors up
+ if (!rail.isOn() && millis() - lastRequest >= (unsigned long)delaytime)
+ {
+   lastRequest = millis();
+   rail.powerUp();
+ }
+
+ // Once they're ready, ask all the sensors to convert at once.
+ // This returns straight away; the sensors work while loop() keeps going.
 /********************************************************************/
- Serial.print(" Requesting temperatures...");
- sensors.requestTemperatures(); // Send the command to get temperature readings
- Serial.println("DONE");
+ if (!requested && rail.ready())
+ {
+   Serial.println(" Requesting temperatures...");
+   requested = sensors.startConversion();
+   if (!requested)
+   {
+     // No sensors answered when the rail came up: nothing to wait for
+     Serial.println(" No sensors found");
+     rail.powerDown();
+   }
+ }
 /********************************************************************/
- Serial.print("Temperature is: ");
- Serial.print(sensors.getTempCByIndex(0)); // Why "byIndex"?
-   // You can have more than one DS18B20 on the same bus.
-   // 0 refers to the first IC on the wire
-   delay(delaytime);
+ // update() returns true once every sensor has been read
+ if (sensors.update())
+ {
+   // Finished with the sensors until next time
+   rail.powerDown();
+   requested = false;
+
+   Serial.print(" DONE after ");
+   Serial.print(millis() - lastRequest);
+   Serial.println(" ms");
+   for (uint8_t i = 0; i < sensors.getCount(); i++)
+   {
+     Serial.print("Temperature ");
+     printAddress(sensors.getAddress(i));
+     Serial.print(": ");
+     if (sensors.isValid(i))
+     {
+       int16_t centiC = sensors.getCentiC(i);
+       if (centiC < 0)
+       {
+         Serial.print('-');
+         centiC = -centiC;
+       }
+       Serial.print(centiC / 100);
+       Serial.print('.');
+       if (centiC % 100 < 10) Serial.print('0');
+       Serial.println(centiC % 100);
+     }
+     else
+     {
+       Serial.println("CRC error");
+     }
+   }
+   Serial.print("Power on ");
+   Serial.print(rail.getDutyPermille() / 10.0, 1);
+   Serial.println("% of the time");
+ }
+
+ // Anything else can happen here while the sensors are converting
 }
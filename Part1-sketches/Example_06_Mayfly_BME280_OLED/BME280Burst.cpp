@@ -0,0 +1,81 @@
+#include "BME280Burst.h"
+#include <Wire.h>
+
+#define BME280_REG_CALIB00   0x88
+#define BME280_REG_CHIPID    0xD0
+#define BME280_REG_CALIB26   0xE1
+#define BME280_REG_CTRL_HUM  0xF2
+#define BME280_REG_CTRL_MEAS 0xF4
+#define BME280_REG_CONFIG    0xF5
+#define BME280_REG_DATA      0xF7   // 8 bytes: pressure, temperature, humidity
+
+#define BME280_CHIPID 0x60
+
+
+bool BME280Burst::begin(uint8_t addr)
+{
+  i2cAddr = addr;
+  Wire.begin();
+
+  uint8_t id;
+  if (!readRegisters(BME280_REG_CHIPID, &id, 1) || id != BME280_CHIPID)
+  {
+    return false;
+  }
+
+  uint8_t c88[26];
+  uint8_t cE1[7];
+  if (!readRegisters(BME280_REG_CALIB00, c88, sizeof(c88)) ||
+      !readRegisters(BME280_REG_CALIB26, cE1, sizeof(cE1)))
+  {
+    return false;
+  }
+  BME280ParseCalibration(c88, cE1, cal);
+
+  writeRegister(BME280_REG_CTRL_MEAS, 0x00);   // sleep while changing settings
+  writeRegister(BME280_REG_CTRL_HUM, 0x05);    // humidity x16 (takes effect on the ctrl_meas write)
+  writeRegister(BME280_REG_CONFIG, 0x00);      // 0.5 ms standby, no filter
+  writeRegister(BME280_REG_CTRL_MEAS, 0xB7);   // temperature x16, pressure x16, normal mode
+  return true;
+}
+
+
+bool BME280Burst::read(BME280Sample &sample)
+{
+  uint8_t data[8];
+  if (!readRegisters(BME280_REG_DATA, data, sizeof(data)))
+  {
+    return false;
+  }
+  BME280Compensate(cal, data, sample);
+  return true;
+}
+
+
+bool BME280Burst::readRegisters(uint8_t reg, uint8_t *buffer, uint8_t length)
+{
+  Wire.beginTransmission(i2cAddr);
+  Wire.write(reg);
+  if (Wire.endTransmission(false) != 0)
+  {
+    return false;
+  }
+  if (Wire.requestFrom(i2cAddr, length) != length)
+  {
+    return false;
+  }
+  for (uint8_t i = 0; i < length; i++)
+  {
+    buffer[i] = Wire.read();
+  }
+  return true;
+}
+
+
+void BME280Burst::writeRegister(uint8_t reg, uint8_t value)
+{
+  Wire.beginTransmission(i2cAddr);
+  Wire.write(reg);
+  Wire.write(value);
+  Wire.endTransmission();
+}
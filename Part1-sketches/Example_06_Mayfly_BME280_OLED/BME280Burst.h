@@ -0,0 +1,42 @@
+/*
+  BME280Burst
+
+  Reads the BME280 with a single I2C transfer per sample.
+
+  All eight data registers (pressure, temperature, humidity) are read in
+  one burst, and the integer compensation in BME280Compensation.h runs
+  once over them.  Reading the sensor through Adafruit_BME280 costs a
+  separate transfer for every value, plus an extra temperature read inside
+  each of the others.
+
+  The sensor is set up the same way as Adafruit_BME280's begin(): normal
+  mode, 16x oversampling on everything, no filter, 0.5 ms standby.  So it
+  is always measuring, and Read() just collects the latest results.
+ */
+
+#ifndef BME280Burst_h
+#define BME280Burst_h
+
+#include <Arduino.h>
+#include "BME280Compensation.h"
+
+class BME280Burst
+{
+  uint8_t i2cAddr;
+  BME280Calibration cal;
+
+  public:
+  // Check the chip ID, load the calibration and start measuring.
+  // Returns false if no BME280 answered at this address.
+  bool begin(uint8_t addr);
+
+  // Read and compensate the latest measurement.  Returns false if the
+  // sensor didn't answer.
+  bool read(BME280Sample &sample);
+
+  private:
+  bool readRegisters(uint8_t reg, uint8_t *buffer, uint8_t length);
+  void writeRegister(uint8_t reg, uint8_t value);
+};
+
+#endif
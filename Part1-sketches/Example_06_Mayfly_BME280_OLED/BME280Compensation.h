@@ -0,0 +1,121 @@
+/*
+  BME280Compensation
+
+  Bosch's integer compensation formulas for the BME280 (datasheet BST-BME280-DS002,
+  section 4.2.3), turning raw ADC readings into temperature, pressure and
+  humidity without any floating point.
+
+  This file only needs <stdint.h>, so the math can be checked on a PC.
+ */
+
+#ifndef BME280Compensation_h
+#define BME280Compensation_h
+
+#include <stdint.h>
+
+// The factory trimming values stored in each sensor
+struct BME280Calibration
+{
+  uint16_t T1;
+  int16_t T2, T3;
+  uint16_t P1;
+  int16_t P2, P3, P4, P5, P6, P7, P8, P9;
+  uint8_t H1;
+  int16_t H2;
+  uint8_t H3;
+  int16_t H4, H5;
+  int8_t H6;
+};
+
+// One set of readings, in fixed point
+struct BME280Sample
+{
+  int32_t temperature;   // hundredths of a degree C (2508 is 25.08 C)
+  uint32_t pressure;     // Pa * 256 (24674867 is 96386.2 Pa)
+  uint32_t humidity;     // %RH * 1024 (47445 is 46.333 %RH)
+};
+
+// Unpack the calibration registers: 26 bytes from 0x88 to 0xA1, and
+// 7 bytes from 0xE1 to 0xE7
+inline void BME280ParseCalibration(const uint8_t *c88, const uint8_t *cE1, BME280Calibration &cal)
+{
+  cal.T1 = (uint16_t)(c88[1] << 8 | c88[0]);
+  cal.T2 = (int16_t)(c88[3] << 8 | c88[2]);
+  cal.T3 = (int16_t)(c88[5] << 8 | c88[4]);
+  cal.P1 = (uint16_t)(c88[7] << 8 | c88[6]);
+  cal.P2 = (int16_t)(c88[9] << 8 | c88[8]);
+  cal.P3 = (int16_t)(c88[11] << 8 | c88[10]);
+  cal.P4 = (int16_t)(c88[13] << 8 | c88[12]);
+  cal.P5 = (int16_t)(c88[15] << 8 | c88[14]);
+  cal.P6 = (int16_t)(c88[17] << 8 | c88[16]);
+  cal.P7 = (int16_t)(c88[19] << 8 | c88[18]);
+  cal.P8 = (int16_t)(c88[21] << 8 | c88[20]);
+  cal.P9 = (int16_t)(c88[23] << 8 | c88[22]);
+  cal.H1 = c88[25];
+
+  cal.H2 = (int16_t)(cE1[1] << 8 | cE1[0]);
+  cal.H3 = cE1[2];
+  cal.H4 = (int16_t)((int8_t)cE1[3] * 16 | (cE1[4] & 0x0F));
+  cal.H5 = (int16_t)((int8_t)cE1[5] * 16 | (cE1[4] >> 4));
+  cal.H6 = (int8_t)cE1[6];
+}
+
+// Temperature in hundredths of a degree C.  Also gives t_fine, which the
+// pressure and humidity formulas need.
+inline int32_t BME280CompensateT(const BME280Calibration &cal, int32_t adc_T, int32_t &t_fine)
+{
+  int32_t var1 = ((((adc_T >> 3) - ((int32_t)cal.T1 << 1))) * ((int32_t)cal.T2)) >> 11;
+  int32_t var2 = (((((adc_T >> 4) - ((int32_t)cal.T1)) * ((adc_T >> 4) - ((int32_t)cal.T1))) >> 12) *
+                  ((int32_t)cal.T3)) >> 14;
+  t_fine = var1 + var2;
+  return (t_fine * 5 + 128) >> 8;
+}
+
+// Pressure in Pa * 256
+inline uint32_t BME280CompensateP(const BME280Calibration &cal, int32_t adc_P, int32_t t_fine)
+{
+  int64_t var1 = ((int64_t)t_fine) - 128000;
+  int64_t var2 = var1 * var1 * (int64_t)cal.P6;
+  var2 = var2 + ((var1 * (int64_t)cal.P5) << 17);
+  var2 = var2 + (((int64_t)cal.P4) << 35);
+  var1 = ((var1 * var1 * (int64_t)cal.P3) >> 8) + ((var1 * (int64_t)cal.P2) << 12);
+  var1 = (((((int64_t)1) << 47) + var1)) * ((int64_t)cal.P1) >> 33;
+  if (var1 == 0)
+  {
+    return 0;   // avoid dividing by zero
+  }
+  int64_t p = 1048576 - adc_P;
+  p = (((p << 31) - var2) * 3125) / var1;
+  var1 = (((int64_t)cal.P9) * (p >> 13) * (p >> 13)) >> 25;
+  var2 = (((int64_t)cal.P8) * p) >> 19;
+  p = ((p + var1 + var2) >> 8) + (((int64_t)cal.P7) << 4);
+  return (uint32_t)p;
+}
+
+// Relative humidity in %RH * 1024
+inline uint32_t BME280CompensateH(const BME280Calibration &cal, int32_t adc_H, int32_t t_fine)
+{
+  int32_t v = t_fine - ((int32_t)76800);
+  v = (((((adc_H << 14) - (((int32_t)cal.H4) << 20) - (((int32_t)cal.H5) * v)) + ((int32_t)16384)) >> 15) *
+       (((((((v * ((int32_t)cal.H6)) >> 10) * (((v * ((int32_t)cal.H3)) >> 11) + ((int32_t)32768))) >> 10) +
+          ((int32_t)2097152)) * ((int32_t)cal.H2) + 8192) >> 14));
+  v = (v - (((((v >> 15) * (v >> 15)) >> 7) * ((int32_t)cal.H1)) >> 4));
+  v = (v < 0 ? 0 : v);
+  v = (v > 419430400 ? 419430400 : v);
+  return (uint32_t)(v >> 12);
+}
+
+// Turn the 8 data bytes read from 0xF7 to 0xFE into a sample
+inline void BME280Compensate(const BME280Calibration &cal, const uint8_t *data, BME280Sample &sample)
+{
+  int32_t adc_P = (int32_t)data[0] << 12 | (int32_t)data[1] << 4 | data[2] >> 4;
+  int32_t adc_T = (int32_t)data[3] << 12 | (int32_t)data[4] << 4 | data[5] >> 4;
+  int32_t adc_H = (int32_t)data[6] << 8 | data[7];
+
+  int32_t t_fine;
+  sample.temperature = BME280CompensateT(cal, adc_T, t_fine);
+  sample.pressure = BME280CompensateP(cal, adc_P, t_fine);
+  sample.humidity = BME280CompensateH(cal, adc_H, t_fine);
+}
+
+#endif
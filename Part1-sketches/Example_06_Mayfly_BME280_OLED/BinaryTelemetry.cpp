@@ -0,0 +1,102 @@
+#include "BinaryTelemetry.h"
+
+
+uint16_t telemetryCrc16(const uint8_t *data, uint8_t length)
+{
+  uint16_t crc = 0xFFFF;
+  for (uint8_t i = 0; i < length; i++)
+  {
+    crc ^= (uint16_t)data[i] << 8;
+    for (uint8_t bit = 0; bit < 8; bit++)
+    {
+      crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+    }
+  }
+  return crc;
+}
+
+
+BinaryTelemetry::BinaryTelemetry(Print &port) : out(port)
+{
+  length = 0;
+  sequence = 0;
+  sentLength = 0;
+}
+
+
+void BinaryTelemetry::begin(uint8_t schema)
+{
+  length = 0;
+  record[length++] = schema;
+  record[length++] = sequence++;
+}
+
+
+void BinaryTelemetry::addU8(uint8_t value)   { add(value, 1); }
+void BinaryTelemetry::addU16(uint16_t value) { add(value, 2); }
+void BinaryTelemetry::addI16(int16_t value)  { add((uint16_t)value, 2); }
+void BinaryTelemetry::addU32(uint32_t value) { add(value, 4); }
+void BinaryTelemetry::addI32(int32_t value)  { add((uint32_t)value, 4); }
+
+
+void BinaryTelemetry::add(uint32_t value, uint8_t bytes)
+{
+  if (length + bytes > TELEMETRY_MAX_RECORD)
+  {
+    return;
+  }
+  for (uint8_t i = 0; i < bytes; i++)
+  {
+    record[length++] = value & 0xFF;
+    value >>= 8;
+  }
+}
+
+
+void BinaryTelemetry::send()
+{
+  uint16_t crc = telemetryCrc16(record, length);
+  record[length++] = crc & 0xFF;
+  record[length++] = crc >> 8;
+
+  // COBS: every 0x00 is replaced by the distance to the next one, and a
+  // leading code byte gives the distance to the first.  Records are always
+  // shorter than 254 bytes, so there's only ever one block.
+  uint8_t frame[TELEMETRY_MAX_RECORD + 4];
+  uint8_t codeIndex = 0;
+  uint8_t code = 1;
+  uint8_t n = 1;
+  for (uint8_t i = 0; i < length; i++)
+  {
+    if (record[i] == 0)
+    {
+      frame[codeIndex] = code;
+      codeIndex = n++;
+      code = 1;
+    }
+    else
+    {
+      frame[n++] = record[i];
+      code++;
+    }
+  }
+  frame[codeIndex] = code;
+  frame[n++] = 0x00;   // end of frame
+
+  // Before the first frame, end whatever was printed so far
+  uint8_t lead = 0;
+  if (sentLength == 0)
+  {
+    out.write((uint8_t)0x00);
+    lead = 1;
+  }
+
+  out.write(frame, n);
+  sentLength = n + lead;
+}
+
+
+uint8_t BinaryTelemetry::frameLength()
+{
+  return sentLength;
+}
@@ -0,0 +1,64 @@
+/*
+  BinaryTelemetry
+
+  Sends fixed-point records over serial as small binary frames instead of
+  text, so a sample takes a fraction of the bytes and no float printing.
+
+  Each record is:
+    schema ID (1 byte)   - says which fields follow, and in what order
+    sequence  (1 byte)   - counts up by one per record, to spot lost frames
+    fields               - little-endian integers, added with the add*() calls
+    CRC-16    (2 bytes)  - CRC-16/CCITT-FALSE of everything above, little-endian
+
+  The record is COBS encoded, which removes every 0x00 byte from it, and a
+  single 0x00 ends the frame.  A receiver can always find the next frame
+  after a glitch just by waiting for a 0x00.  The first frame has a 0x00
+  in front of it as well, so anything printed before it, like a startup
+  banner, ends there instead of running into the frame.
+
+  decode_telemetry.py turns a stream of these frames back into CSV.
+ */
+
+#ifndef BinaryTelemetry_h
+#define BinaryTelemetry_h
+
+#include <Arduino.h>
+
+#define TELEMETRY_MAX_RECORD 64   // schema through last field
+
+// CRC-16/CCITT-FALSE (polynomial 0x1021, starting at 0xFFFF), the same as
+// Python's binascii.crc_hqx(data, 0xFFFF)
+uint16_t telemetryCrc16(const uint8_t *data, uint8_t length);
+
+class BinaryTelemetry
+{
+  Print &out;
+  uint8_t record[TELEMETRY_MAX_RECORD + 2];   // room for the CRC
+  uint8_t length;
+  uint8_t sequence;
+
+  public:
+  BinaryTelemetry(Print &port);
+
+  // Start a new record with this schema ID
+  void begin(uint8_t schema);
+
+  // Add fields.  Fields past TELEMETRY_MAX_RECORD are dropped.
+  void addU8(uint8_t value);
+  void addU16(uint16_t value);
+  void addI16(int16_t value);
+  void addU32(uint32_t value);
+  void addI32(int32_t value);
+
+  // Add the CRC, COBS encode and send the frame
+  void send();
+
+  // Bytes the last frame took on the wire, delimiter included
+  uint8_t frameLength();
+
+  private:
+  void add(uint32_t value, uint8_t bytes);
+  uint8_t sentLength;
+};
+
+#endif
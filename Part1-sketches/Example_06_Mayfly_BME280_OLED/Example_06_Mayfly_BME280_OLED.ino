@@ -17,9 +17,10 @@
 #include <Arduino.h>
 #include <Wire.h>
 #include <SPI.h>
-#include <Adafruit_Sensor.h>
-#include <Adafruit_BME280.h>
-#include <SDL_Arduino_SSD1306.h>    // Modification of Adafruit_SSD1306 for ESP8266 compatibility
+#include "BME280Burst.h"     // Reads the whole BME280 in one I2C transfer
+#include "BinaryTelemetry.h"  // Compact binary frames instead of text rows
+#include "ShadowSSD1306.h"   // SSD1306 driver that only sends the parts of the screen that changed
+#include "PowerRail.h"       // Powers the BME280 only while it is read
 #include <AMAdafruit_GFX.h>   // Needs a little change in original Adafruit library (See README.txt file)
 #include <SPI.h>            // For SPI comm (needed for not getting compile error)
 
@@ -31,25 +32,159 @@
 
 uint8_t BMEi2c_addr = 0x76;  // Address is 0x77 (Adafruit default) or 0x76 (Grove default)
 const int8_t I2CPower = 22;  // Pin to switch power on and off (-1 if unconnected)
+PowerRail rail(I2CPower);
+
+// The BME280 starts up in 2 ms, then the first measurement at 16x
+// oversampling takes up to 113 ms (BME280 datasheet, section 9.1)
+const uint16_t BME280WarmupMs = 2;
+const uint16_t BME280MeasureMs = 113;
+bool bmeFound = false;
 
 // Create an instance of the OLED display
-SDL_Arduino_SSD1306 display(4); // FOR I2C
+ShadowSSD1306 display; // FOR I2C
 
 
 #define SEALEVELPRESSURE_HPA (1013.25)
 
-Adafruit_BME280 bme; // I2C
-//Adafruit_BME280 bme(BME_CS); // hardware SPI
-//Adafruit_BME280 bme(BME_CS, BME_MOSI, BME_MISO, BME_SCK); // software SPI
+BME280Burst bme; // I2C
 
 unsigned long delayTime;
 
+// Set to 1 to send each sample as a binary frame instead of a text row.
+// Read them on the computer with decode_telemetry.py.
+#define BINARY_TELEMETRY 0
+
+// Schema ID for a BME280 sample frame: time (ms), temperature (0.01 C),
+// humidity (0.01 %RH), pressure (Pa * 256)
+#define SCHEMA_BME280 1
+
+BinaryTelemetry telemetry(Serial);
+
+// After each power-up: the BME280 is back in sleep mode, without settings
+void bmePowered()
+{
+    bmeFound = bme.begin(BMEi2c_addr);
+}
+
+// Power the BME280 up and read it once.  The rail is left on, so the
+// display can still be drawn; call rail.powerDown() afterwards.
+bool takeSample(BME280Sample &sample)
+{
+    rail.powerUpAndWait();
+    delay(BME280MeasureMs);
+    return bmeFound && bme.read(sample);
+}
+
+// How much of the time the BME280 has had power
+void printDuty()
+{
+    Serial.print("Power on ");
+    Serial.print(rail.getDutyPermille() / 10.0, 1);
+    Serial.println("% of the time");
+}
+
+// Print a fixed-point number with two decimal places.  "one" is the raw
+// value that stands for 1.00, e.g. 100 for hundredths of a degree.
+void printFixed(Print &out, int32_t value, uint16_t one)
+{
+    if (value < 0) {
+        out.print('-');
+        value = -value;
+    }
+    out.print(value / one);
+    out.print('.');
+    uint8_t hundredths = (uint32_t)(value % one) * 100 / one;
+    if (hundredths < 10) out.print('0');
+    out.print(hundredths);
+}
+
+// Send one sample as a binary frame
+void sendBinarySample(const BME280Sample &sample)
+{
+    telemetry.begin(SCHEMA_BME280);
+    telemetry.addU32(millis());
+    telemetry.addI16(sample.temperature);
+    telemetry.addU16((sample.humidity * 100 + 512) >> 10);
+    telemetry.addU32(sample.pressure);
+    telemetry.send();
+}
+
+// Altitude in meters from pressure in Pa * 256 (the same formula
+// Adafruit_BME280::readAltitude() uses)
+float altitude(uint32_t pressure)
+{
+    float hPa = pressure / 25600.0;
+    return 44330.0 * (1.0 - pow(hPa / SEALEVELPRESSURE_HPA, 0.1903));
+}
+
+// Send one sample as a row of text
+void printTextSample(const BME280Sample &sample, unsigned long readMicros)
+{
+    Serial.print("  ");
+    Serial.print(millis());
+    Serial.print(", ");
+    printFixed(Serial, sample.temperature, 100);
+    Serial.print(", ");
+    printFixed(Serial, sample.humidity, 1024);
+    Serial.print(", ");
+    printFixed(Serial, sample.pressure, 256);
+    Serial.print(", ");
+    Serial.print(altitude(sample.pressure));
+    Serial.print(", ");
+    Serial.print(readMicros);
+    Serial.println();
+}
+
+
+#ifdef TELEMETRY_BENCHMARK
+// Send the same sample as fast as the serial port allows, first as text
+// and then as binary frames, and print how many samples per second each
+// one managed.  Build with -DTELEMETRY_BENCHMARK to run it at startup.
+void benchmarkTelemetry()
+{
+    const int samples = 100;
+    BME280Sample sample;
+    takeSample(sample);
+    rail.powerDown();
+
+    Serial.flush();
+    unsigned long start = millis();
+    for (int i = 0; i < samples; i++) {
+        printTextSample(sample, 0);
+    }
+    Serial.flush();
+    unsigned long textMillis = millis() - start;
+
+    start = millis();
+    for (int i = 0; i < samples; i++) {
+        sendBinarySample(sample);
+    }
+    Serial.flush();
+    unsigned long binaryMillis = millis() - start;
+
+    Serial.println();
+    Serial.print("Text samples/s:   ");
+    Serial.println(samples * 1000.0 / textMillis);
+    Serial.print("Binary samples/s: ");
+    Serial.println(samples * 1000.0 / binaryMillis);
+    Serial.print("Binary frame bytes: ");
+    Serial.println(telemetry.frameLength());
+}
+#endif
+
+
 void setup() {
     Serial.begin(115200);
     Serial.println(F("BME280 test"));
 
+    // The BME280 is on the switched rail, and only powered while read.
+    // The display is always powered, so it keeps showing between samples.
+    rail.addDevice(BME280WarmupMs, bmePowered);
+    rail.useI2C();
+    rail.begin();
+
     pinMode(5, INPUT);
-    display.begin(SSD1306_SWITCHCAPVCC, 0x3C, false);  // initialize with the I2C addr 0x3C (for the 128x64)
+    display.begin(SSD1306_SWITCHCAPVCC, 0x3C);  // initialize with the I2C addr 0x3C (for the 128x64)
     display.clearDisplay();
     display.setTextSize(1);
     display.setTextColor(WHITE);
@@ -59,47 +194,48 @@ void setup() {
     display.display();
 
 
-    // Turn on switched power
-    pinMode(I2CPower, OUTPUT);
-    digitalWrite(I2CPower, HIGH);
-
-    bool status;
-
-    // default settings
-    // (you can also pass in a Wire library object like &Wire2)
-    status = bme.begin(BMEi2c_addr);
-    if (!status) {
+    // Power up the BME280 once to check it's there
+    rail.powerUpAndWait();
+    rail.powerDown();
+    if (!bmeFound) {
         Serial.println("Could not find a valid BME280 sensor, check wiring!");
         while (1);
     }
 
+#ifdef TELEMETRY_BENCHMARK
+    benchmarkTelemetry();
+#endif
+
     Serial.println("-- Timing Test --");
     delayTime = 1100;
 
     Serial.println();
 
     // Print table headers
-    Serial.println("  Time,  Temp, Humid,   Press,   Alt");
-    Serial.println("    ms,    *C,     %,      Pa,     m");
+    Serial.println("  Time,  Temp, Humid,   Press,   Alt, Read");
+    Serial.println("    ms,    *C,     %,      Pa,     m,   us");
 
 }
 
 
 void loop() {
 
+    BME280Sample sample;
+
     for (int i=0; i <= 30; i++)
     {
-        Serial.print("  ");
-        Serial.print(millis());
-        Serial.print(", ");
-        Serial.print(bme.readTemperature());
-        Serial.print(", ");
-        Serial.print(bme.readHumidity());
-        Serial.print(", ");
-        Serial.print(bme.readPressure());
-        Serial.print(", ");
-        Serial.print(bme.readAltitude(SEALEVELPRESSURE_HPA));
-        Serial.println();
+        rail.powerUpAndWait();
+        delay(BME280MeasureMs);
+        unsigned long readStart = micros();
+        bme.read(sample);
+        unsigned long readMicros = micros() - readStart;
+        rail.powerDown();
+
+#if BINARY_TELEMETRY
+        sendBinarySample(sample);
+#else
+        printTextSample(sample, readMicros);
+#endif
         delay(delayTime);
     }
 
@@ -107,18 +243,33 @@ void loop() {
 
     for (int i=0; i <= 30; i++)
   {
+      takeSample(sample);
+
       display.clearDisplay();
       display.setTextSize(1);
       display.setTextColor(WHITE);
       display.setCursor(0,0);
-      display.print("T: "); display.print(bme.readTemperature()); display.println(" C");
-      display.print("H: "); display.print(bme.readHumidity()); display.println(" %");
-      display.print("P: "); display.print(bme.readPressure()); display.println(" Pa");
+      display.print("T: "); printFixed(display, sample.temperature, 100); display.println(" C");
+      display.print("H: "); printFixed(display, sample.humidity, 1024); display.println(" %");
+      display.print("P: "); printFixed(display, sample.pressure, 256); display.println(" Pa");
       display.display();
+      rail.powerDown();
+
+#if !BINARY_TELEMETRY
+      // Only the digits that changed are sent, see ShadowSSD1306.h
+      Serial.print("OLED refresh: ");
+      Serial.print(display.lastBytes);
+      Serial.print(" bytes, ");
+      Serial.print(display.lastMicros);
+      Serial.println(" us");
+#endif
 
       delay(delayTime);
   }
 
+#if !BINARY_TELEMETRY
+    printDuty();
+#endif
 
     delay(100000);
 }
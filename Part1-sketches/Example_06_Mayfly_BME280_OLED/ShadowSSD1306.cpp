@@ -0,0 +1,151 @@
+#include "ShadowSSD1306.h"
+#include <Wire.h>
+
+// Data bytes per I2C transfer.  With the address and control byte this
+// stays inside the Wire library's 32 byte buffer.
+#define OLED_CHUNK 16
+
+
+ShadowSSD1306::ShadowSSD1306() : Adafruit_GFX(OLED_WIDTH, OLED_HEIGHT)
+{
+  shadowValid = false;
+  lastBytes = 0;
+  lastMicros = 0;
+  memset(buffer, 0, sizeof(buffer));
+}
+
+
+void ShadowSSD1306::begin(uint8_t vccstate, uint8_t i2caddr)
+{
+  bool external = (vccstate == SSD1306_EXTERNALVCC);
+  i2cAddr = i2caddr;
+  Wire.begin();
+
+  // The same start-up sequence as the Adafruit SSD1306 driver, except
+  // that it uses horizontal addressing so a column range can be written
+  // in one go
+  command(0xAE);                        // display off
+  command(0xD5); command(0x80);         // clock divide ratio
+  command(0xA8); command(OLED_HEIGHT - 1);   // multiplex ratio
+  command(0xD3); command(0x00);         // no display offset
+  command(0x40);                        // start line 0
+  command(0x8D); command(external ? 0x10 : 0x14);   // charge pump
+  command(0x20); command(0x00);         // horizontal addressing mode
+  command(0xA1);                        // column 127 is SEG0
+  command(0xC8);                        // scan COM outputs from the bottom
+  command(0xDA); command(0x12);         // COM pins for 128x64
+  command(0x81); command(external ? 0x9F : 0xCF);   // contrast
+  command(0xD9); command(external ? 0x22 : 0xF1);   // pre-charge period
+  command(0xDB); command(0x40);         // VCOMH level
+  command(0xA4);                        // show the RAM contents
+  command(0xA6);                        // not inverted
+  command(0x2E);                        // no scrolling
+  command(0xAF);                        // display on
+
+  shadowValid = false;                  // we don't know what's in its RAM yet
+}
+
+
+void ShadowSSD1306::clearDisplay()
+{
+  memset(buffer, 0, sizeof(buffer));
+}
+
+
+void ShadowSSD1306::display()
+{
+  unsigned long start = micros();
+  lastBytes = 0;
+
+  for (uint8_t page = 0; page < OLED_PAGES; page++)
+  {
+    uint8_t *row = buffer + page * OLED_WIDTH;
+    uint8_t *shown = shadow + page * OLED_WIDTH;
+
+    int16_t first = 0;
+    int16_t last = OLED_WIDTH - 1;
+    if (shadowValid)
+    {
+      // Trim unchanged columns off both ends
+      while (first < OLED_WIDTH && row[first] == shown[first]) first++;
+      if (first == OLED_WIDTH)
+      {
+        continue;   // nothing changed on this page
+      }
+      while (row[last] == shown[last]) last--;
+    }
+
+    sendColumns(page, first, last);
+    memcpy(shown + first, row + first, last - first + 1);
+  }
+
+  shadowValid = true;
+  lastMicros = micros() - start;
+}
+
+
+void ShadowSSD1306::drawPixel(int16_t x, int16_t y, uint16_t color)
+{
+  if (x < 0 || x >= width() || y < 0 || y >= height())
+  {
+    return;
+  }
+
+  int16_t t;
+  switch (getRotation())
+  {
+    case 1:
+      t = x; x = y; y = t;
+      x = WIDTH - x - 1;
+      break;
+    case 2:
+      x = WIDTH - x - 1;
+      y = HEIGHT - y - 1;
+      break;
+    case 3:
+      t = x; x = y; y = t;
+      y = HEIGHT - y - 1;
+      break;
+  }
+
+  uint8_t &b = buffer[x + (y / 8) * OLED_WIDTH];
+  uint8_t bit = 1 << (y & 7);
+  switch (color)
+  {
+    case WHITE:   b |= bit;  break;
+    case BLACK:   b &= ~bit; break;
+    case INVERSE: b ^= bit;  break;
+  }
+}
+
+
+void ShadowSSD1306::command(uint8_t c)
+{
+  Wire.beginTransmission(i2cAddr);
+  Wire.write((uint8_t)0x00);   // control byte: a command follows
+  Wire.write(c);
+  Wire.endTransmission();
+  lastBytes += 2;
+}
+
+
+// Point the panel at one page and a column range, then send those bytes
+void ShadowSSD1306::sendColumns(uint8_t page, uint8_t first, uint8_t last)
+{
+  command(0x21); command(first); command(last);   // column range
+  command(0x22); command(page); command(page);    // page range
+
+  uint8_t *data = buffer + page * OLED_WIDTH;
+  for (uint8_t x = first; x <= last; )
+  {
+    Wire.beginTransmission(i2cAddr);
+    Wire.write((uint8_t)0x40);   // control byte: data follows
+    lastBytes++;
+    for (uint8_t n = 0; n < OLED_CHUNK && x <= last; n++, x++)
+    {
+      Wire.write(data[x]);
+      lastBytes++;
+    }
+    Wire.endTransmission();
+  }
+}
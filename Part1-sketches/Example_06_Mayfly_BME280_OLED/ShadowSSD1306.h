@@ -0,0 +1,62 @@
+/*
+  ShadowSSD1306
+
+  A 128x64 SSD1306 OLED driver that only sends what changed.
+
+  Drawing goes into a framebuffer as usual.  A second "shadow" copy
+  remembers what the panel is actually showing, and display() compares the
+  two page by page (a page is a band 8 pixels high).  For each page that
+  differs it sends only the columns from the first to the last changed
+  byte.  So clearDisplay() followed by redrawing nearly the same screen
+  costs only the few digits that changed, instead of the whole 1 KB.
+
+  Drawing functions (print, setCursor, drawLine, ...) come from
+  Adafruit_GFX, just like SDL_Arduino_SSD1306.
+ */
+
+#ifndef ShadowSSD1306_h
+#define ShadowSSD1306_h
+
+#include <Arduino.h>
+#include <AMAdafruit_GFX.h>
+
+#ifndef BLACK
+#define BLACK 0
+#define WHITE 1
+#define INVERSE 2
+#endif
+
+#ifndef SSD1306_SWITCHCAPVCC
+#define SSD1306_EXTERNALVCC 0x1
+#define SSD1306_SWITCHCAPVCC 0x2
+#endif
+
+#define OLED_WIDTH 128
+#define OLED_HEIGHT 64
+#define OLED_PAGES (OLED_HEIGHT / 8)
+
+class ShadowSSD1306 : public Adafruit_GFX
+{
+  uint8_t i2cAddr;
+  uint8_t buffer[OLED_WIDTH * OLED_PAGES];   // what we're drawing
+  uint8_t shadow[OLED_WIDTH * OLED_PAGES];   // what the panel shows
+  bool shadowValid;                          // false until the first display()
+
+  public:
+  // What the last display() cost, so you can see the savings
+  unsigned int lastBytes;          // I2C bytes sent, commands included
+  unsigned long lastMicros;        // time taken
+
+  ShadowSSD1306();
+
+  void begin(uint8_t vccstate, uint8_t i2caddr);
+  void clearDisplay();
+  void display();
+  void drawPixel(int16_t x, int16_t y, uint16_t color);
+
+  private:
+  void command(uint8_t c);
+  void sendColumns(uint8_t page, uint8_t first, uint8_t last);
+};
+
+#endif
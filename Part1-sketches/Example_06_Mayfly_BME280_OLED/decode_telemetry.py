@@ -0,0 +1,117 @@
+#!/usr/bin/env python3
+"""
+Turn the binary telemetry frames from Example_06 back into CSV.
+
+Reads from a serial port (needs pyserial) or from a file captured
+earlier, and prints one CSV row per good frame.  Frames that fail their
+CRC are counted and skipped, and gaps in the sequence numbers are
+reported on stderr.
+
+    python decode_telemetry.py /dev/ttyUSB0 --baud 115200 > samples.csv
+    python decode_telemetry.py capture.bin > samples.csv
+
+See BinaryTelemetry.h for the frame format.
+"""
+
+import argparse
+import binascii
+import struct
+import sys
+
+# Schema ID -> (struct format of the fields, CSV column names, converters)
+SCHEMAS = {
+    1: ("<IhHI",
+        ["time_ms", "temp_C", "humidity_pct", "pressure_Pa"],
+        [lambda v: v,
+         lambda v: "%.2f" % (v / 100.0),
+         lambda v: "%.2f" % (v / 100.0),
+         lambda v: "%.2f" % (v / 256.0)]),
+}
+
+
+def cobs_decode(data):
+    out = bytearray()
+    i = 0
+    while i < len(data):
+        code = data[i]
+        # The block is the code and the code - 1 bytes after it
+        if code == 0 or i + code > len(data):
+            raise ValueError("bad COBS code")
+        out += data[i + 1:i + code]
+        i += code
+        if code < 0xFF and i < len(data):
+            out.append(0)
+    return bytes(out)
+
+
+def frames(stream):
+    """Yield the bytes between 0x00 delimiters."""
+    pending = bytearray()
+    while True:
+        chunk = stream.read(256)
+        if not chunk:
+            break
+        for b in bytearray(chunk):
+            if b == 0:
+                if pending:
+                    yield bytes(pending)
+                pending = bytearray()
+            else:
+                pending.append(b)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument("source", help="serial port or capture file")
+    parser.add_argument("--baud", type=int, default=115200)
+    args = parser.parse_args()
+
+    if args.source.startswith("/dev/") or args.source.upper().startswith("COM"):
+        import serial
+        stream = serial.Serial(args.source, args.baud, timeout=1)
+    else:
+        stream = open(args.source, "rb")
+
+    header_schema = None
+    bad = 0
+    last_sequence = None
+    for frame in frames(stream):
+        try:
+            record = cobs_decode(frame)
+        except ValueError:
+            bad += 1
+            continue
+        if len(record) < 4:
+            bad += 1
+            continue
+        body, crc = record[:-2], struct.unpack("<H", record[-2:])[0]
+        if binascii.crc_hqx(body, 0xFFFF) != crc:
+            bad += 1
+            continue
+
+        schema, sequence = bytearray(body[:2])
+        if schema not in SCHEMAS:
+            sys.stderr.write("unknown schema %d\n" % schema)
+            continue
+        fmt, columns, converters = SCHEMAS[schema]
+        if len(body) - 2 != struct.calcsize(fmt):
+            bad += 1
+            continue
+
+        if last_sequence is not None and sequence != (last_sequence + 1) & 0xFF:
+            sys.stderr.write("lost %d frames\n" % ((sequence - last_sequence - 1) & 0xFF))
+        last_sequence = sequence
+
+        if schema != header_schema:
+            print(",".join(columns))
+            header_schema = schema
+        values = struct.unpack(fmt, body[2:])
+        print(",".join(str(c(v)) for c, v in zip(converters, values)))
+        sys.stdout.flush()
+
+    if bad:
+        sys.stderr.write("%d bad frames skipped\n" % bad)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,132 @@
+/*
+  BME280CompensationTest
+
+  Checks the integer compensation in BME280Compensation.h against the
+  datasheet: the worked example (adc_T 519888 is 25.08 C with t_fine
+  128422, and adc_P 415148 is 100653.27 Pa), and Bosch's floating point
+  formulas over a spread of raw readings.  Also unpacks the humidity
+  calibration bytes, whose H4 and H5 share a byte and can be negative.
+
+  Build and run from this folder:
+    g++ -std=c++11 -Wall -I.. -o BME280CompensationTest BME280CompensationTest.cpp && ./BME280CompensationTest
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "BME280Compensation.h"
+
+static int failures = 0;
+
+static void expect(bool ok, const char *what)
+{
+  if (!ok)
+  {
+    printf("FAIL %s\n", what);
+    failures++;
+  }
+}
+
+// The datasheet's double precision versions, for comparison
+static double floatT(const BME280Calibration &c, int32_t adc_T, double &t_fine)
+{
+  double var1 = (adc_T / 16384.0 - c.T1 / 1024.0) * c.T2;
+  double var2 = (adc_T / 131072.0 - c.T1 / 8192.0) * (adc_T / 131072.0 - c.T1 / 8192.0) * c.T3;
+  t_fine = var1 + var2;
+  return t_fine / 5120.0;
+}
+
+static double floatP(const BME280Calibration &c, int32_t adc_P, double t_fine)
+{
+  double var1 = t_fine / 2.0 - 64000.0;
+  double var2 = var1 * var1 * c.P6 / 32768.0;
+  var2 = var2 + var1 * c.P5 * 2.0;
+  var2 = var2 / 4.0 + c.P4 * 65536.0;
+  var1 = (c.P3 * var1 * var1 / 524288.0 + c.P2 * var1) / 524288.0;
+  var1 = (1.0 + var1 / 32768.0) * c.P1;
+  double p = 1048576.0 - adc_P;
+  p = (p - var2 / 4096.0) * 6250.0 / var1;
+  var1 = c.P9 * p * p / 2147483648.0;
+  var2 = p * c.P8 / 32768.0;
+  return p + (var1 + var2 + c.P7) / 16.0;
+}
+
+static double floatH(const BME280Calibration &c, int32_t adc_H, double t_fine)
+{
+  double h = t_fine - 76800.0;
+  h = (adc_H - (c.H4 * 64.0 + c.H5 / 16384.0 * h)) *
+      (c.H2 / 65536.0 * (1.0 + c.H6 / 67108864.0 * h * (1.0 + c.H3 / 67108864.0 * h)));
+  h = h * (1.0 - c.H1 * h / 524288.0);
+  return h < 0 ? 0 : h > 100 ? 100 : h;
+}
+
+
+int main()
+{
+  // The datasheet's example calibration, with typical humidity values
+  BME280Calibration cal = {};
+  cal.T1 = 27504; cal.T2 = 26435; cal.T3 = -1000;
+  cal.P1 = 36477; cal.P2 = -10685; cal.P3 = 3024; cal.P4 = 2855; cal.P5 = 140;
+  cal.P6 = -7; cal.P7 = 15500; cal.P8 = -14600; cal.P9 = 6000;
+  cal.H1 = 75; cal.H2 = 362; cal.H3 = 0; cal.H4 = 313; cal.H5 = 50; cal.H6 = 30;
+
+  int32_t t_fine;
+  expect(BME280CompensateT(cal, 519888, t_fine) == 2508, "example temperature is 25.08 C");
+  expect(t_fine == 128422, "example t_fine is 128422");
+  double pa = BME280CompensateP(cal, 415148, t_fine) / 256.0;
+  expect(fabs(pa - 100653.27) < 0.1, "example pressure is 100653.27 Pa");
+
+  // Over the sensor's range: -40 to 85 C, 300 to 1100 hPa, 0 to 100 %RH
+  srand(1);
+  double worstT = 0, worstP = 0, worstH = 0;
+  for (long i = 0; i < 100000; i++)
+  {
+    int32_t adc_T = 380000 + rand() % 260000;
+    int32_t adc_P = 200000 + rand() % 500000;
+    int32_t adc_H = rand() % 65536;
+
+    double fine;
+    double t = floatT(cal, adc_T, fine);
+    if (t < -40 || t > 85)
+    {
+      continue;
+    }
+    double p = floatP(cal, adc_P, fine);
+    if (p < 30000 || p > 110000)
+    {
+      continue;
+    }
+    double h = floatH(cal, adc_H, fine);
+
+    // The same readings as the 8 data bytes from 0xF7
+    uint8_t data[8] = {
+      (uint8_t)(adc_P >> 12), (uint8_t)(adc_P >> 4), (uint8_t)(adc_P << 4),
+      (uint8_t)(adc_T >> 12), (uint8_t)(adc_T >> 4), (uint8_t)(adc_T << 4),
+      (uint8_t)(adc_H >> 8), (uint8_t)adc_H };
+    BME280Sample sample;
+    BME280Compensate(cal, data, sample);
+
+    worstT = fmax(worstT, fabs(sample.temperature / 100.0 - t));
+    worstP = fmax(worstP, fabs(sample.pressure / 256.0 - p));
+    worstH = fmax(worstH, fabs(sample.humidity / 1024.0 - h));
+  }
+  printf("worst against floating point: %.4f C, %.3f Pa, %.4f %%RH\n", worstT, worstP, worstH);
+  expect(worstT <= 0.01, "temperature within 0.01 C of floating point");
+  expect(worstP <= 1.0, "pressure within 1 Pa of floating point");
+  expect(worstH <= 0.05, "humidity within 0.05 %RH of floating point");
+
+  // H4 and H5 are 12 bits each, sharing 0xE5, and signed
+  uint8_t c88[26] = {};
+  uint8_t positive[7] = { 0x6A, 0x01, 0x00, 0x13, 0x2F, 0x03, 0x1E };
+  BME280Calibration parsed;
+  BME280ParseCalibration(c88, positive, parsed);
+  expect(parsed.H2 == 362 && parsed.H3 == 0 && parsed.H4 == 319 && parsed.H5 == 50 &&
+    parsed.H6 == 30, "humidity calibration unpacked");
+  uint8_t negative[7] = { 0x00, 0x00, 0x00, 0xF3, 0xA5, 0xF6, 0xE2 };
+  BME280ParseCalibration(c88, negative, parsed);
+  expect(parsed.H4 == -203 && parsed.H5 == -150 && parsed.H6 == -30,
+    "negative humidity calibration unpacked");
+
+  printf(failures ? "FAILED\n" : "PASSED\n");
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,199 @@
+#include "DHTCapture.h"
+
+// Room for the response edge, 40 bits and the final edge, plus a spare
+#define DHT_MAX_EDGES 44
+
+static volatile uint16_t edgeMicros[DHT_MAX_EDGES];  // low 16 bits are enough for gaps
+static volatile uint8_t edgeCount = 0;
+static volatile bool capturing = false;
+
+static volatile uint8_t *dhtPinReg;
+static uint8_t dhtMask;
+
+
+DHTCapture::DHTCapture(uint8_t dhtPin, uint8_t dhtType)
+{
+  pin = dhtPin;
+  type = dhtType;
+  state = IDLE;
+  autoStart = true;
+  haveReading = false;
+  lastResult = DHT_OK;
+  failures = 0;
+}
+
+
+bool DHTCapture::begin()
+{
+  if (digitalPinToPCICRbit(pin) != 1)
+  {
+    return false;
+  }
+
+  pinMode(pin, INPUT_PULLUP);
+  dhtPinReg = portInputRegister(digitalPinToPort(pin));
+  dhtMask = digitalPinToBitMask(pin);
+
+  *digitalPinToPCMSK(pin) |= _BV(digitalPinToPCMSKbit(pin));
+  PCIFR = _BV(digitalPinToPCICRbit(pin));
+  *digitalPinToPCICR(pin) |= _BV(digitalPinToPCICRbit(pin));
+
+  // The sensor needs a moment after power up, so wait one interval
+  lastStart = millis();
+  return true;
+}
+
+
+void DHTCapture::powerRestored()
+{
+  capturing = false;
+  state = IDLE;
+  pinMode(pin, INPUT_PULLUP);
+  lastStart = millis() - MinIntervalMs;
+}
+
+
+bool DHTCapture::update()
+{
+  unsigned long now = millis();
+
+  switch (state)
+  {
+    case IDLE:
+      if (autoStart)
+      {
+        startReading();
+      }
+      return false;
+
+    case STARTING:
+      if (now - stateMillis < (type == DHT11 ? StartLowMs : StartLowMs22))
+      {
+        return false;
+      }
+      // Let go and listen.  The sensor answers within 40 us.
+      edgeCount = 0;
+      capturing = true;
+      pinMode(pin, INPUT_PULLUP);
+      stateMillis = now;
+      state = RECEIVING;
+      return false;
+
+    case RECEIVING:
+      // Wait out the whole transfer rather than stopping at the 42nd
+      // edge, so an extra edge from noise is counted and the reading
+      // thrown away
+      if (now - stateMillis < TimeoutMs)
+      {
+        return false;
+      }
+      break;
+  }
+
+  capturing = false;
+  state = IDLE;
+
+  // Gaps between falling edges.  The ISR has stopped, so no need to
+  // turn interrupts off to read them.
+  uint16_t gaps[DHT_MAX_EDGES - 1];
+  uint8_t count = edgeCount > 0 ? edgeCount - 1 : 0;
+  for (uint8_t i = 0; i < count; i++)
+  {
+    gaps[i] = edgeMicros[i + 1] - edgeMicros[i];
+  }
+
+  uint8_t data[5];
+  lastResult = dhtDecode(gaps, count, data);
+  if (lastResult == DHT_OK)
+  {
+    humidity = dhtHumidityTenths(type, data);
+    temperature = dhtTemperatureTenths(type, data);
+    readingMillis = now;
+    haveReading = true;
+  }
+  else
+  {
+    failures++;
+  }
+  return true;
+}
+
+
+bool DHTCapture::startReading()
+{
+  unsigned long now = millis();
+  if (state != IDLE || now - lastStart < MinIntervalMs)
+  {
+    return false;
+  }
+
+  // Start signal: hold the line low
+  lastStart = now;
+  stateMillis = now;
+  digitalWrite(pin, LOW);
+  pinMode(pin, OUTPUT);
+  state = STARTING;
+  return true;
+}
+
+
+void DHTCapture::setAutoStart(bool on)
+{
+  autoStart = on;
+}
+
+
+bool DHTCapture::busy()
+{
+  return state != IDLE;
+}
+
+
+float DHTCapture::readHumidity()
+{
+  return haveReading ? humidity / 10.0 : NAN;
+}
+
+
+float DHTCapture::readTemperature()
+{
+  return haveReading ? temperature / 10.0 : NAN;
+}
+
+
+bool DHTCapture::getTenths(int16_t &humidityTenths, int16_t &temperatureTenths)
+{
+  humidityTenths = humidity;
+  temperatureTenths = temperature;
+  return haveReading;
+}
+
+
+unsigned long DHTCapture::getAge()
+{
+  return millis() - readingMillis;
+}
+
+
+DHTResult DHTCapture::getLastResult()
+{
+  return lastResult;
+}
+
+
+uint16_t DHTCapture::getFailures()
+{
+  return failures;
+}
+
+
+ISR(PCINT1_vect)
+{
+  // Only falling edges on the DHT pin, and only while listening.  Other
+  // pins on the port share this interrupt.
+  if (!capturing || (*dhtPinReg & dhtMask) || edgeCount >= DHT_MAX_EDGES)
+  {
+    return;
+  }
+  edgeMicros[edgeCount++] = micros();
+}
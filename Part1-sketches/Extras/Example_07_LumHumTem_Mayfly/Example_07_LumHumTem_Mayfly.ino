@@ -2,12 +2,13 @@
 
 #include <Arduino.h>
 #include <Wire.h>
-#include "DHT.h"      // Includes the Adafruit DHT-sensor-library 1.3.0+, which was updated to require the Unified Adafruit_Sensor sensor
-#include <Adafruit_TSL2561_U.h>  // Adafruit_TSL2561 library for the TSL2561 digital luminosity (light) sensors
+#include "DHTCapture.h"   // Reads the DHT from a pin change interrupt, without turning interrupts off
+#include "TSL2561AutoRange.h"  // Reads the TSL2561 without waiting, picking its gain and integration time
+#include "PowerRail.h"    // Powers the Grove sockets only while the sensors are read
 
 
 // Create an instance of the TLS Sensor, using the correct I2C address
-Adafruit_TSL2561_Unified tsl(TSL2561_ADDR_LOW);  // I2C address 0x29 (addr pin set LOW)
+TSL2561AutoRange tsl(TSL2561_ADDR_LOW);  // I2C address 0x29 (addr pin set LOW)
 
 #define DHTPIN 10     // what pin the DHT signal is connected to
 
@@ -25,13 +26,74 @@ Adafruit_TSL2561_Unified tsl(TSL2561_ADDR_LOW);  // I2C address 0x29 (addr pin s
 // Create variables for the full spectrum (broadband) and IR luminosity results
 uint16_t broadband, ir;
 
-DHT dht(DHTPIN, DHTTYPE);
+DHTCapture dht(DHTPIN, DHTTYPE);
+
+// Pin 22 powers the Grove Ports.  Both sensors share one warm-up, so the
+// rail is on for the DHT's second plus the slowest reading.
+PowerRail rail(22);
+
+// The TSL2561 answers as soon as it has power; the DHT won't for a second
+// (DHT11 and DHT22 datasheets)
+const uint16_t TSLWarmupMs = 1;
+const uint16_t DHTWarmupMs = 1000;
+bool tslFound = false;
+
+// How often to take a sample, in ms
+const unsigned long readingInterval = 5000;
+unsigned long lastReading = 0;
+
+// One sample from every sensor.  Both sensors are started together and
+// each result is collected when it's ready, so a sample takes as long as
+// the slowest sensor rather than all of them added up.
+struct Sample
+{
+  unsigned long startMillis;   // when the sensors were started
+  bool lightRead;              // the light fields below are from this sample
+  bool luxValid;
+  bool luxError;               // the light sensor didn't answer
+  uint16_t broadband, ir;
+  uint32_t lux;
+  bool dhtValid;
+  float humidity, temperature;
+  // How long each stage took, from startMillis
+  unsigned long lightMillis;
+  unsigned long dhtMillis;
+  unsigned long totalMillis;
+};
+
+Sample sample;
+bool sampling = false;
+bool lightDone, dhtDone;
+
+// After each power-up: both sensors have forgotten their settings
+void tslPowered()
+{
+  tslFound = tsl.begin();
+}
+
+void dhtPowered()
+{
+  dht.powerRestored();
+}
 
 void setup()
 {
   Serial.begin(57600);
 
-  if (tsl.begin())
+  dht.begin();
+  dht.setAutoStart(false);   // the sample pipeline starts it
+
+  // Starts with the rail off, and the I2C and DHT pins let go
+  rail.addDevice(TSLWarmupMs, tslPowered);
+  rail.addDevice(DHTWarmupMs, dhtPowered);
+  rail.useI2C();
+  rail.addPin(DHTPIN);
+  rail.begin();
+
+  // Power up once to check the light sensor is there
+  rail.powerUpAndWait();
+  rail.powerDown();
+  if (tslFound)
   {
     Serial.println("Luminosity sensor");
   }
@@ -41,55 +103,122 @@ void setup()
     while (1);
   }
 
-  // You can change the gain on the fly, to adapt to brighter/dimmer light situations
-  //tsl.setGain(TSL2561_GAIN_1X);         // set no gain (for bright situtations)
-  tsl.setGain(TSL2561_GAIN_16X);      // set 16x gain (for dim situations)
-
-  // Changing the integration time gives you a longer time over which to sense light
-  // longer timelines are slower, but are good in very low light situtations!
-  tsl.setIntegrationTime(TSL2561_INTEGRATIONTIME_13MS);  // shortest integration time (bright light)
-  //tsl.setIntegrationTime(TSL2561_INTEGRATIONTIME_101MS);  // medium integration time (medium light)
-  //tsl.setIntegrationTime(TSL2561_INTEGRATIONTIME_402MS);  // longest integration time (dim light)
-    
-    
-    pinMode(22, OUTPUT);    // Setting up Pin 22 to provide power to Grove Ports
-    digitalWrite(22, HIGH); // Provide power to D10-11 and D6-7 Grove Ports
-    delay(200);
-    Serial.begin(57600);
-    Serial.println("Digital Humidity/Temperature");
-
-    dht.begin();
+  // There's no gain or integration time to set: each reading picks the
+  // shortest integration time and lowest gain that still give enough
+  // counts (see TSL2561Ranging.h)
+
+  Serial.println("Digital Humidity/Temperature");
 }
 
-void loop()
+// Print a finished sample, and how long each stage took
+void publishSample(const Sample &record)
 {
+  if (!record.lightRead)
+  {
+    // The sensor was still busy, so there's nothing new to show
+    Serial.println("Light: no reading this time");
+  }
+  else
+  {
+    // The broadband/full spectrum and IR light intensity from the sensor
+    // These values are raw ADC outputs (non-standard units)
+    broadband = record.broadband;
+    ir = record.ir;
+    // Print results to the serial port
+    Serial.print("IR: "); Serial.print(ir);   Serial.print("\t\t");
+    Serial.print("Full: "); Serial.print(broadband);   Serial.print(" \t");
+    Serial.print("Visible: "); Serial.print(broadband - ir);   Serial.print("\t");
+
+    // Calculate and print illuminance in lux (ie, convert sensor units to the standard SI unit)
+    Serial.print("Lux: ");
+    if (record.luxValid)
+    {
+      Serial.println(record.lux);
+    }
+    else if (record.luxError)
+    {
+      Serial.println("sensor error");
+    }
+    else
+    {
+      Serial.println("saturated");
+    }
+  }
 
-    
-    // Reading temperature or humidity takes about 250 milliseconds
-    // Sensor readings may also be up to 2 seconds old
-    float h = dht.readHumidity();
-    float t = dht.readTemperature();
-
+  if (!record.dhtValid)
+  {
+    Serial.println("Failed to read from DHT");
+  }
+  else
+  {
+    Serial.print("Humidity: ");
+    Serial.print(record.humidity);
+    Serial.print(" %\t");
+    Serial.print("Temperature: ");
+    Serial.print(record.temperature);
+    Serial.println(" *C");
+  }
 
-  // Get both the broadband/full spectrum and IR light intensity from the sensor
-  // These values are returned as raw ADC outputs (non-standard units)
-  tsl.getLuminosity(&broadband, &ir);
-  // Print results to the serial port
-  Serial.print("IR: "); Serial.print(ir);   Serial.print("\t\t");
-  Serial.print("Full: "); Serial.print(broadband);   Serial.print(" \t");
-  Serial.print("Visible: "); Serial.print(broadband - ir);   Serial.print("\t");
+  // The slowest stage is the one worth speeding up
+  Serial.print("Stages: light "); Serial.print(record.lightMillis);
+  Serial.print(" ms, DHT "); Serial.print(record.dhtMillis);
+  Serial.print(" ms, sample "); Serial.print(record.totalMillis);
+  Serial.println(record.lightMillis >= record.dhtMillis ? " ms (light is the critical path)"
+                                                        : " ms (DHT is the critical path)");
+  Serial.print("Power on ");
+  Serial.print(rail.getDutyPermille() / 10.0, 1);
+  Serial.println("% of the time");
+}
 
-  // Calculate and print illuminance in lux (ie, convert sensor units to the standard SI unit)
-  Serial.print("Lux: "); Serial.println(tsl.calculateLux(broadband, ir));
+void loop()
+{
+  // Every readingInterval, power the sensors up
+  if (!rail.isOn() && millis() - lastReading >= readingInterval)
+  {
+    lastReading = millis();
+    rail.powerUp();
+  }
 
-        Serial.print("Humidity: ");
-        Serial.print(h);
-        Serial.print(" %\t");
-        Serial.print("Temperature: ");
-        Serial.print(t);
-        Serial.println(" *C");
+  // Once both have warmed up, start them together.  Both return straight
+  // away and work while loop() keeps going.
+  if (!sampling && rail.ready())
+  {
+    sample.startMillis = millis();
+    sampling = true;
+    lightDone = !tsl.startReading();
+    sample.lightRead = false;   // until update() fills in the light fields
+    dhtDone = !dht.startReading();   // if it isn't ready, use its last reading
+    sample.lightMillis = 0;
+    sample.dhtMillis = 0;
+  }
 
-  delay(1000);
+  // Collect each result as soon as it's ready
+  if (tsl.update())
+  {
+    sample.lightMillis = millis() - sample.startMillis;
+    sample.luxValid = tsl.isValid();
+    sample.luxError = tsl.isError();
+    sample.broadband = tsl.getBroadband();
+    sample.ir = tsl.getIR();
+    sample.lux = tsl.getLux();
+    sample.lightRead = true;
+    lightDone = true;
+  }
 
+  if (dht.update())
+  {
+    sample.dhtMillis = millis() - sample.startMillis;
+    dhtDone = true;
+  }
 
+  if (sampling && lightDone && dhtDone)
+  {
+    sample.totalMillis = millis() - sample.startMillis;
+    sample.humidity = dht.readHumidity();
+    sample.temperature = dht.readTemperature();
+    sample.dhtValid = dht.getLastResult() == DHT_OK && !isnan(sample.humidity);
+    sampling = false;
+    rail.powerDown();
+    publishSample(sample);
+  }
 }
@@ -0,0 +1,174 @@
+#include "PowerRail.h"
+#include <Wire.h>
+
+
+PowerRail::PowerRail(int8_t pin)
+{
+  railPin = pin;
+  deviceCount = 0;
+  warmupMillis = 0;
+  pinCount = 0;
+  i2c = false;
+  on = false;
+  warm = false;
+  onMillis = 0;
+  beginMillis = 0;
+}
+
+
+bool PowerRail::addDevice(uint16_t warmupMs, void (*setup)())
+{
+  if (deviceCount >= POWER_RAIL_MAX_DEVICES)
+  {
+    return false;
+  }
+  setups[deviceCount++] = setup;
+  if (warmupMs > warmupMillis)
+  {
+    warmupMillis = warmupMs;
+  }
+  return true;
+}
+
+
+bool PowerRail::addPin(uint8_t pin)
+{
+  if (pinCount >= POWER_RAIL_MAX_PINS)
+  {
+    return false;
+  }
+  pins[pinCount++] = pin;
+  return true;
+}
+
+
+void PowerRail::useI2C()
+{
+  i2c = true;
+}
+
+
+void PowerRail::begin()
+{
+  if (railPin >= 0)
+  {
+    pinMode(railPin, OUTPUT);
+  }
+  on = true;   // so powerDown() floats the pins too
+  onSince = millis();
+  powerDown();
+  onMillis = 0;
+  beginMillis = millis();
+}
+
+
+void PowerRail::powerUp()
+{
+  if (on)
+  {
+    return;
+  }
+  if (railPin >= 0)
+  {
+    digitalWrite(railPin, HIGH);
+  }
+  on = true;
+  warm = false;
+  onSince = millis();
+}
+
+
+bool PowerRail::ready()
+{
+  if (!on)
+  {
+    return false;
+  }
+  if (warm)
+  {
+    return true;
+  }
+  if (millis() - onSince < warmupMillis)
+  {
+    return false;
+  }
+
+  // Everything on the rail has just started from nothing
+  if (i2c)
+  {
+    Wire.begin();
+  }
+  for (uint8_t i = 0; i < deviceCount; i++)
+  {
+    if (setups[i])
+    {
+      setups[i]();
+    }
+  }
+  warm = true;
+  return true;
+}
+
+
+void PowerRail::powerUpAndWait()
+{
+  powerUp();
+  while (!ready())
+  {
+  }
+}
+
+
+void PowerRail::powerDown()
+{
+  if (!on)
+  {
+    return;
+  }
+
+  // Let go of every line into the rail's devices, pull-ups included
+  if (i2c)
+  {
+    Wire.end();
+    pinMode(SDA, INPUT);
+    digitalWrite(SDA, LOW);
+    pinMode(SCL, INPUT);
+    digitalWrite(SCL, LOW);
+  }
+  for (uint8_t i = 0; i < pinCount; i++)
+  {
+    pinMode(pins[i], INPUT);
+    digitalWrite(pins[i], LOW);
+  }
+
+  if (railPin >= 0)
+  {
+    digitalWrite(railPin, LOW);
+  }
+  on = false;
+  warm = false;
+  onMillis += millis() - onSince;
+}
+
+
+bool PowerRail::isOn()
+{
+  return on;
+}
+
+
+unsigned long PowerRail::getOnMillis()
+{
+  return on ? onMillis + (millis() - onSince) : onMillis;
+}
+
+
+uint16_t PowerRail::getDutyPermille()
+{
+  unsigned long total = millis() - beginMillis;
+  if (total == 0)
+  {
+    return on ? 1000 : 0;
+  }
+  return (uint64_t)getOnMillis() * 1000 / total;
+}
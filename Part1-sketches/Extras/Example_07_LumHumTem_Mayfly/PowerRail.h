@@ -0,0 +1,88 @@
+/*
+  PowerRail
+
+  Turns the Mayfly's switched power rail (pin 22, which feeds the Grove
+  sockets) on only while the sensors on it are being read.
+
+  Each sensor is added with how long it needs after power-up before it
+  can be used, and optionally a function that sets it up again (a sensor
+  forgets its settings when it loses power).  Once per sampling cycle:
+
+    rail.powerUp();           // returns straight away
+    ...
+    if (rail.ready())         // the longest warm-up has passed
+      ... read every sensor ...
+    rail.powerDown();
+
+  The first time ready() returns true after a power-up, it restarts the
+  I2C bus (if useI2C() was called) and calls every sensor's setup
+  function.  powerDown() stops the I2C bus and turns off the pull-ups on
+  SDA, SCL and any pins given to addPin(), so the unpowered sensors
+  aren't fed through their signal pins.
+
+  getDutyPermille() says how much of the time the rail has been on.
+ */
+
+#ifndef PowerRail_h
+#define PowerRail_h
+
+#include <Arduino.h>
+
+#define POWER_RAIL_MAX_DEVICES 6
+#define POWER_RAIL_MAX_PINS 4
+
+class PowerRail
+{
+  int8_t railPin;            // -1 if there is no switch
+
+  uint8_t deviceCount;
+  void (*setups[POWER_RAIL_MAX_DEVICES])();
+  uint16_t warmupMillis;     // the longest warm-up of all the devices
+
+  uint8_t pinCount;
+  uint8_t pins[POWER_RAIL_MAX_PINS];
+  bool i2c;
+
+  bool on;
+  bool warm;                 // ready() has set everything up since power-up
+  unsigned long onSince;
+  unsigned long onMillis;    // on time of the finished cycles
+  unsigned long beginMillis;
+
+  public:
+  PowerRail(int8_t pin);
+
+  // Add a device on the rail.  setup may be NULL.  Returns false if there
+  // are too many.
+  bool addDevice(uint16_t warmupMs, void (*setup)() = NULL);
+
+  // A signal pin that goes to a device on the rail
+  bool addPin(uint8_t pin);
+
+  // A device on the rail uses the I2C bus
+  void useI2C();
+
+  // Set up the switch pin, with the rail off
+  void begin();
+
+  // Switch the rail on.  Returns straight away.
+  void powerUp();
+
+  // True once every device has warmed up, and set up again (see above)
+  bool ready();
+
+  // powerUp() and wait until ready(), for sketches that use delay()
+  void powerUpAndWait();
+
+  // Switch the rail off
+  void powerDown();
+
+  bool isOn();
+
+  // Time the rail has been on since begin(), in ms and in tenths of a
+  // percent of the time since begin()
+  unsigned long getOnMillis();
+  uint16_t getDutyPermille();
+};
+
+#endif
@@ -0,0 +1,183 @@
+#include "TSL2561AutoRange.h"
+#include <Wire.h>
+
+#define TSL2561_COMMAND     0x80
+#define TSL2561_WORD        0x20
+#define TSL2561_CONTROL     0x00
+#define TSL2561_TIMING      0x01
+#define TSL2561_DATA0       0x0C   // broadband, low byte first
+#define TSL2561_DATA1       0x0E   // infrared
+#define TSL2561_POWER_ON    0x03
+#define TSL2561_POWER_OFF   0x00
+
+
+TSL2561AutoRange::TSL2561AutoRange(uint8_t i2cAddress)
+{
+  address = i2cAddress;
+  level = 2;   // start in the middle
+  state = IDLE;
+  readLevel = level;
+  timingSet = false;
+  broadband = 0;
+  ir = 0;
+  valid = false;
+  readError = false;
+  onMillis = 0;
+  validReadings = 0;
+}
+
+
+bool TSL2561AutoRange::begin()
+{
+  // Also called after the sensor has lost power, which resets its timing
+  timingSet = false;
+  Wire.begin();
+  return write8(TSL2561_CONTROL, TSL2561_POWER_OFF);
+}
+
+
+bool TSL2561AutoRange::startReading()
+{
+  if (state != IDLE)
+  {
+    return false;
+  }
+  powerUp();
+  return true;
+}
+
+
+bool TSL2561AutoRange::update()
+{
+  if (state != INTEGRATING)
+  {
+    return false;
+  }
+  unsigned long elapsed = millis() - startMillis;
+  if (elapsed < tsl2561WaitMillis[readLevel])
+  {
+    return false;
+  }
+
+  readError = !read16(TSL2561_DATA0, broadband) || !read16(TSL2561_DATA1, ir);
+  write8(TSL2561_CONTROL, TSL2561_POWER_OFF);
+  onMillis += elapsed;
+
+  if (readError)
+  {
+    // A missing reply reads as all ones, which would look like saturation
+    broadband = 0;
+    ir = 0;
+    valid = false;
+    state = IDLE;
+    return true;
+  }
+
+  uint8_t next = tsl2561NextLevel(readLevel, broadband, ir, valid);
+  if (!valid && next != readLevel)
+  {
+    // Too bright for this setting; try again less sensitive
+    level = next;
+    powerUp();
+    return false;
+  }
+
+  level = next;
+  if (valid)
+  {
+    validReadings++;
+  }
+  state = IDLE;
+  return true;
+}
+
+
+bool TSL2561AutoRange::busy()
+{
+  return state != IDLE;
+}
+
+
+bool TSL2561AutoRange::isValid()
+{
+  return valid;
+}
+
+
+bool TSL2561AutoRange::isError()
+{
+  return readError;
+}
+
+
+uint16_t TSL2561AutoRange::getBroadband()
+{
+  return broadband;
+}
+
+
+uint16_t TSL2561AutoRange::getIR()
+{
+  return ir;
+}
+
+
+uint32_t TSL2561AutoRange::getLux()
+{
+  return tsl2561Lux(readLevel, broadband, ir);
+}
+
+
+uint8_t TSL2561AutoRange::getLevel()
+{
+  return readLevel;
+}
+
+
+unsigned long TSL2561AutoRange::getOnMillisPerReading()
+{
+  return validReadings ? onMillis / validReadings : 0;
+}
+
+
+void TSL2561AutoRange::powerUp()
+{
+  // The timing register only takes a write while powered, and integration
+  // starts when the sensor powers up, so a change of setting is written
+  // first and the sensor cycled (as Adafruit's library does)
+  if (level != readLevel || !timingSet)
+  {
+    write8(TSL2561_CONTROL, TSL2561_POWER_ON);
+    write8(TSL2561_TIMING, tsl2561Timing[level]);
+    write8(TSL2561_CONTROL, TSL2561_POWER_OFF);
+    timingSet = true;
+  }
+  readLevel = level;
+  write8(TSL2561_CONTROL, TSL2561_POWER_ON);
+  startMillis = millis();
+  state = INTEGRATING;
+}
+
+
+bool TSL2561AutoRange::write8(uint8_t reg, uint8_t value)
+{
+  Wire.beginTransmission(address);
+  Wire.write(TSL2561_COMMAND | reg);
+  Wire.write(value);
+  return Wire.endTransmission() == 0;
+}
+
+
+bool TSL2561AutoRange::read16(uint8_t reg, uint16_t &value)
+{
+  Wire.beginTransmission(address);
+  Wire.write(TSL2561_COMMAND | TSL2561_WORD | reg);
+  if (Wire.endTransmission() != 0 || Wire.requestFrom(address, (uint8_t)2) != 2)
+  {
+    return false;
+  }
+  uint16_t low = Wire.read();
+  uint16_t high = Wire.read();
+  value = high << 8 | low;
+  return true;
+}
@@ -0,0 +1,163 @@
+#include "ButtonEvents.h"
+#include <avr/sleep.h>
+
+// Edges waiting for loop().  The size must be a power of two.
+#define EDGE_QUEUE_SIZE 16
+
+static volatile unsigned long edgeMillis[EDGE_QUEUE_SIZE];
+static volatile uint8_t edgeHead = 0;   // written only by the interrupt
+static volatile uint8_t edgeTail = 0;   // written only by loop()
+static volatile uint8_t edgesDropped = 0;
+
+static volatile uint8_t *buttonPinReg;
+static uint8_t buttonMask;
+static volatile bool lastIsrLevel;
+
+// Debouncer state, used only by loop()
+static bool stableLevel = false;     // debounced button level, true is pressed
+static bool settling = false;        // edges seen, waiting for them to stop
+static unsigned long burstMillis;    // first edge of the current bounce burst
+static unsigned long lastEdgeMillis; // latest edge of the current bounce burst
+static unsigned long pressMillis;    // when the button was last pressed
+static bool longReported = true;     // long press already sent for this press
+static bool doubleArmed = false;     // a single press could still become a double
+
+
+static bool buttonLevel()
+{
+  return (*buttonPinReg & buttonMask) != 0;
+}
+
+
+bool ButtonEvents::Begin(uint8_t pin)
+{
+  if (digitalPinToPCICRbit(pin) != 2)
+  {
+    return false;
+  }
+
+  pinMode(pin, INPUT);
+  buttonPinReg = portInputRegister(digitalPinToPort(pin));
+  buttonMask = digitalPinToBitMask(pin);
+
+  stableLevel = buttonLevel();
+  lastIsrLevel = stableLevel;
+
+  *digitalPinToPCMSK(pin) |= _BV(digitalPinToPCMSKbit(pin));
+  PCIFR = _BV(digitalPinToPCICRbit(pin));
+  *digitalPinToPCICR(pin) |= _BV(digitalPinToPCICRbit(pin));
+  return true;
+}
+
+
+ButtonEvent ButtonEvents::Read()
+{
+  // Empty the queue, remembering when this burst of bouncing started and
+  // when it was last seen
+  while (edgeTail != edgeHead)
+  {
+    unsigned long edge = edgeMillis[edgeTail];
+    if (!settling)
+    {
+      settling = true;
+      burstMillis = edge;
+    }
+    lastEdgeMillis = edge;
+    edgeTail = (edgeTail + 1) & (EDGE_QUEUE_SIZE - 1);
+  }
+
+  // Only now, so no edge just taken from the queue is later than now
+  unsigned long now = millis();
+
+  if (doubleArmed && now - pressMillis > DoublePressMs)
+  {
+    doubleArmed = false;
+  }
+
+  // Once the contacts have been quiet for DebounceMs, read where they
+  // settled.  Reading the pin rather than counting edges means a dropped
+  // edge can't leave us out of step.
+  if (settling && now - lastEdgeMillis >= DebounceMs)
+  {
+    settling = false;
+    bool level = buttonLevel();
+    if (level != stableLevel)
+    {
+      stableLevel = level;
+      if (!level)
+      {
+        return BUTTON_RELEASE;
+      }
+
+      longReported = false;
+      bool isDouble = doubleArmed && burstMillis - pressMillis <= DoublePressMs;
+      pressMillis = burstMillis;
+      doubleArmed = !isDouble;
+      return isDouble ? BUTTON_DOUBLE_PRESS : BUTTON_PRESS;
+    }
+  }
+
+  if (stableLevel && !longReported && now - pressMillis >= LongPressMs)
+  {
+    longReported = true;
+    return BUTTON_LONG_PRESS;
+  }
+
+  return BUTTON_NONE;
+}
+
+
+bool ButtonEvents::Busy()
+{
+  // millis() stops while powered down, so stay awake through any timing
+  // that depends on it
+  return edgeTail != edgeHead || settling || doubleArmed ||
+         (stableLevel && !longReported);
+}
+
+
+void ButtonEvents::Sleep()
+{
+  set_sleep_mode(Busy() ? SLEEP_MODE_IDLE : SLEEP_MODE_PWR_DOWN);
+
+  // Check the queue with interrupts off, so an edge can't sneak in between
+  // the check and the sleep.  The instruction after sei() always runs
+  // before any interrupt, so the CPU is asleep before one can fire.
+  cli();
+  if (edgeTail == edgeHead)
+  {
+    sleep_enable();
+    sei();
+    sleep_cpu();
+    sleep_disable();
+  }
+  sei();
+}
+
+
+uint8_t ButtonEvents::Dropped()
+{
+  return edgesDropped;
+}
+
+
+ISR(PCINT2_vect)
+{
+  // Other pins on the port share this interrupt, so ignore it unless the
+  // button itself changed
+  bool level = buttonLevel();
+  if (level == lastIsrLevel)
+  {
+    return;
+  }
+  lastIsrLevel = level;
+
+  uint8_t next = (edgeHead + 1) & (EDGE_QUEUE_SIZE - 1);
+  if (next == edgeTail)
+  {
+    edgesDropped++;
+    return;
+  }
+  edgeMillis[edgeHead] = millis();
+  edgeHead = next;
+}
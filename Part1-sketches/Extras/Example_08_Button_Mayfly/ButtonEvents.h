@@ -0,0 +1,60 @@
+/*
+  ButtonEvents
+
+  Turns the Mayfly pushbutton into press, release, long-press and
+  double-press events without polling it.
+
+  A pin change interrupt timestamps every edge on the button pin and puts
+  it in a small ring buffer.  Only the interrupt writes the head and only
+  loop() writes the tail, so neither side has to turn interrupts off.
+  Read() empties the buffer, waits for the contacts to stop bouncing, and
+  returns one event at a time.
+
+  Because nothing needs polling, Sleep() can power the board down until
+  the button is touched, as long as no debounce or long-press timing is
+  in progress.
+
+  The interrupt handler is for port C (pins 16 to 23), where the Mayfly
+  button (pin 21) is.
+ */
+
+#ifndef ButtonEvents_h
+#define ButtonEvents_h
+
+#include <Arduino.h>
+
+enum ButtonEvent
+{
+  BUTTON_NONE,
+  BUTTON_PRESS,
+  BUTTON_RELEASE,
+  BUTTON_LONG_PRESS,     // still held LongPressMs after pressing
+  BUTTON_DOUBLE_PRESS,   // pressed again within DoublePressMs (instead of BUTTON_PRESS)
+};
+
+class ButtonEvents
+{
+  public:
+  static const unsigned long DebounceMs = 20;
+  static const unsigned long LongPressMs = 1000;
+  static const unsigned long DoublePressMs = 400;
+
+  // Start watching a button that reads HIGH when pressed.  Returns false
+  // if the pin isn't on port C.
+  static bool Begin(uint8_t pin);
+
+  // The next button event, or BUTTON_NONE
+  static ButtonEvent Read();
+
+  // True while an event may still come without the button changing
+  static bool Busy();
+
+  // Sleep until there is something to do: power down if not Busy(),
+  // otherwise idle until the next millis() tick.
+  static void Sleep();
+
+  // How many edges were lost because the buffer was full
+  static uint8_t Dropped();
+};
+
+#endif
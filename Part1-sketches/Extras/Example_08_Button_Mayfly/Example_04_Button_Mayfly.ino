@@ -4,45 +4,70 @@
  Turns on and off a light emitting diode(LED) connected to digital
  pin 8, when pressing the Mayfly pushbutton
 
+ The button is watched with a pin change interrupt (see ButtonEvents.h)
+ instead of being read over and over, so each press is counted exactly
+ once and the Mayfly sleeps while nobody is touching it.
+
  */
 
  #include <Arduino.h>
  #include <Wire.h>
+ #include "ButtonEvents.h"
 
 const int buttonPin = 21;     // the number of the pushbutton pin
 const int greenLEDpin = 8;      // the number of the green LED pin
+const int redLEDpin = 9;        // the number of the red LED pin
 
 int i = 0;
-// variables will change:
-int buttonState = 0;         // variable for reading the pushbutton status
 
 void setup() {
 
   Serial.begin(57600);   // We'll send debugging information via the Serial monitor
   Serial.println("Mayfly Button testing sketch");
-  // initialize the LED pin as an output:
+  // initialize the LED pins as outputs:
   pinMode(greenLEDpin, OUTPUT);
-  // initialize the pushbutton pin as an input:
-  pinMode(buttonPin, INPUT);
+  pinMode(redLEDpin, OUTPUT);
+  // start watching the pushbutton:
+  ButtonEvents::Begin(buttonPin);
 
 }
 
 void loop(){
-  // read the state of the pushbutton value:
-  buttonState = digitalRead(buttonPin);
-
-  // check if the pushbutton is pressed.
-  // if it is, the buttonState is HIGH:
-  if (buttonState == HIGH) {
-    // turn LED on:
-    digitalWrite(greenLEDpin, HIGH);
-    i++;
-    Serial.print("Button!  ");
-    Serial.println(i);
-    delay(50);
-  }
-  else {
-    // turn LED off:
-    digitalWrite(greenLEDpin, LOW);
+  // get the next thing the pushbutton did
+  ButtonEvent event = ButtonEvents::Read();
+
+  switch (event) {
+    case BUTTON_PRESS:
+      // turn LED on:
+      digitalWrite(greenLEDpin, HIGH);
+      i++;
+      Serial.print("Button!  ");
+      Serial.println(i);
+      break;
+
+    case BUTTON_DOUBLE_PRESS:
+      digitalWrite(greenLEDpin, HIGH);
+      i++;
+      Serial.print("Double press!  ");
+      Serial.println(i);
+      break;
+
+    case BUTTON_LONG_PRESS:
+      // the red LED shows a long press
+      digitalWrite(redLEDpin, HIGH);
+      Serial.println("Long press");
+      break;
+
+    case BUTTON_RELEASE:
+      // turn LEDs off:
+      digitalWrite(greenLEDpin, LOW);
+      digitalWrite(redLEDpin, LOW);
+      break;
+
+    case BUTTON_NONE:
+      // nothing to do, so finish sending and sleep until there is
+      Serial.flush();
+      ButtonEvents::Sleep();
+      break;
   }
 }
@@ -4,18 +4,23 @@
 
 #include <Arduino.h>
 #include <Wire.h>
-#include <Adafruit_TSL2561_U.h>  // Adafruit_TSL2561 library for the TSL2561 digital luminosity (light) sensors
+#include "TSL2561AutoRange.h"  // Reads the TSL2561 without waiting, picking its gain and integration time
 
 
 // Create an instance of the TLS Sensor, using the correct I2C address
 // Un-comment the correct one
-Adafruit_TSL2561_Unified tsl(TSL2561_ADDR_LOW);  // I2C address 0x29 (addr pin set LOW)
-// Adafruit_TSL2561_Unified tsl(TSL2561_ADDR_FLOAT);  // I2C address 0x39 (addr pin left floating)
-// Adafruit_TSL2561_Unified tsl(TSL2561_ADDR_HIGH);  // I2C address 0x49 (addr pin set high)
+TSL2561AutoRange tsl(TSL2561_ADDR_LOW);  // I2C address 0x29 (addr pin set LOW)
+// TSL2561AutoRange tsl(TSL2561_ADDR_FLOAT);  // I2C address 0x39 (addr pin left floating)
+// TSL2561AutoRange tsl(TSL2561_ADDR_HIGH);  // I2C address 0x49 (addr pin set high)
 
 // Create variables for the full spectrum (broadband) and IR luminosity results
 uint16_t broadband, ir;
 
+// How often to start a reading, in ms
+const unsigned long readingInterval = 100;
+unsigned long lastReading = 0;
+uint8_t readingsPrinted = 0;
+
 
 // The main setup function
 void setup(void)
@@ -32,15 +37,10 @@ void setup(void)
     while (1);
   }
 
-  // You can change the gain on the fly, to adapt to brighter/dimmer light situations
-  //tsl.setGain(TSL2561_GAIN_1X);         // set no gain (for bright situtations)
-  tsl.setGain(TSL2561_GAIN_16X);      // set 16x gain (for dim situations)
-
-  // Changing the integration time gives you a longer time over which to sense light
-  // longer timelines are slower, but are good in very low light situtations!
-  tsl.setIntegrationTime(TSL2561_INTEGRATIONTIME_13MS);  // shortest integration time (bright light)
-  //tsl.setIntegrationTime(TSL2561_INTEGRATIONTIME_101MS);  // medium integration time (medium light)
-  //tsl.setIntegrationTime(TSL2561_INTEGRATIONTIME_402MS);  // longest integration time (dim light)
+  // There's no gain or integration time to set: each reading picks the
+  // shortest integration time and lowest gain that still give enough
+  // counts, from 13 ms at 1x in sun up to 402 ms at 16x at dusk
+  // (see TSL2561Ranging.h)
 
   // Now we're ready to get readings!
 }
@@ -49,17 +49,51 @@ void setup(void)
 // The loop function, which will run repeatedly
 void loop(void)
 {
+  // Start a reading every readingInterval.  This returns straight away;
+  // the sensor integrates while loop() keeps going.
+  if (!tsl.busy() && millis() - lastReading >= readingInterval)
+  {
+    lastReading = millis();
+    tsl.startReading();
+  }
+
+  // update() returns true once the reading is done
+  if (!tsl.update())
+  {
+    return;
+  }
+
+  if (tsl.isError())
+  {
+    Serial.println("Sensor error: no answer on I2C");
+    return;
+  }
+
+  if (!tsl.isValid())
+  {
+    Serial.println("Too bright: the sensor saturated even at its least sensitive");
+    return;
+  }
 
   // Get both the broadband/full spectrum and IR light intensity from the sensor
   // These values are returned as raw ADC outputs (non-standard units)
-  tsl.getLuminosity(&broadband, &ir);
+  broadband = tsl.getBroadband();
+  ir = tsl.getIR();
   // Print results to the serial port
   Serial.print("IR: "); Serial.print(ir);   Serial.print("\t\t");
   Serial.print("Full: "); Serial.print(broadband);   Serial.print(" \t");
   Serial.print("Visible: "); Serial.print(broadband - ir);   Serial.print("\t");
 
   // Calculate and print illuminance in lux (ie, convert sensor units to the standard SI unit)
-  Serial.print("Lux: "); Serial.println(tsl.calculateLux(broadband, ir));
+  Serial.print("Lux: "); Serial.print(tsl.getLux());
+  Serial.print("\tLevel: "); Serial.println(tsl.getLevel());
 
-  delay(100);
+  // Every so often, show how long the sensor is kept on for each reading
+  if (++readingsPrinted >= 50)
+  {
+    readingsPrinted = 0;
+    Serial.print("Sensor on for ");
+    Serial.print(tsl.getOnMillisPerReading());
+    Serial.println(" ms per reading");
+  }
 }
@@ -0,0 +1,206 @@
+/*
+  TSL2561RangingTest
+
+  Replays light curves through TSL2561Ranging.h against a pretend
+  TSL2561, reading once a minute the way TSL2561AutoRange does: a reading
+  too close to saturating is retried a level down straight away.  The
+  sensor's counts come from the datasheet lux formula run backwards, and
+  stop at each setting's full scale.  Checks that:
+
+  - every reading up to 30000 lux ends valid, within 2% of the true lux
+    when it has enough counts, and within a couple of counts when not
+  - a reading with next to no counts always moves up a level for the
+    next, however the light is changing
+  - under steady light the level settles and stays put
+  - the sensor is on for well under the 402 ms a fixed setting needs
+    for dusk
+
+  Build and run from this folder:
+    g++ -std=c++11 -Wall -I.. -o TSL2561RangingTest TSL2561RangingTest.cpp && ./TSL2561RangingTest
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "TSL2561Ranging.h"
+
+// Full scale counts at each level (13.7 ms, 13.7 ms, 101 ms, 402 ms)
+static const uint16_t fullScale[TSL2561_LEVELS] = {5047, 5047, 37177, 65535};
+
+// Daylight: IR is about 0.3 of broadband, which is the 0x00C0 piece of
+// the formula
+static const double IR_RATIO = 0.3;
+static const double LUX_PER_COUNT = (0x023F - IR_RATIO * 0x037B) / 16384.0;   // at 402 ms, 16x
+
+static const double MAX_LUX = 30000;
+
+static int failures = 0;
+
+static uint16_t sensorCounts(double counts402, uint8_t level)
+{
+  double counts = counts402 * 1024 / tsl2561Scale[level];
+  return counts >= fullScale[level] ? fullScale[level] : (uint16_t)counts;
+}
+
+struct Reading
+{
+  bool valid;
+  double lux;
+  uint8_t level;        // the level it was made at
+  uint16_t broadband;
+  uint16_t onMillis;    // for it and any retries
+};
+
+// One reading, retried a level down until it is valid or can't go lower
+static Reading readSensor(uint8_t &level, double lux)
+{
+  Reading r = { false, 0, level, 0, 0 };
+  for (uint8_t tries = 0; tries < TSL2561_LEVELS && !r.valid; tries++)
+  {
+    double counts402 = lux / LUX_PER_COUNT;
+    uint16_t broadband = sensorCounts(counts402, level);
+    uint16_t ir = sensorCounts(counts402 * IR_RATIO, level);
+    r.onMillis += tsl2561WaitMillis[level];
+    r.level = level;
+    r.broadband = broadband;
+    level = tsl2561NextLevel(level, broadband, ir, r.valid);
+    if (r.valid)
+    {
+      r.lux = tsl2561Lux(r.level, broadband, ir);
+    }
+    else if (r.level == 0)
+    {
+      break;   // brighter than the sensor can read
+    }
+  }
+  return r;
+}
+
+static void checkReading(const char *curve, int minute, double lux, const Reading &r)
+{
+  if (lux > MAX_LUX)
+  {
+    return;
+  }
+  // 2%, and half a lux as tsl2561Lux() gives whole lux.  With only a few
+  // counts, a count either way in each channel as well.
+  double allowed = 0.02 * lux + 0.5;
+  if (r.broadband < TSL2561_LOW_COUNTS)
+  {
+    allowed += 2 * LUX_PER_COUNT * tsl2561Scale[r.level] / 1024;
+  }
+  if (!r.valid || fabs(r.lux - lux) > allowed)
+  {
+    printf("FAIL %s, minute %d: %.2f lux read as %s %.2f at level %u\n",
+      curve, minute, lux, r.valid ? "valid" : "invalid", r.lux, r.level);
+    failures++;
+  }
+}
+
+
+// Light curves, one value a minute over a day
+static double clearDay(int minute)
+{
+  double h = minute / 60.0;
+  double sun = h > 6 && h < 20 ? sin((h - 6) / 14 * M_PI) : 0;
+  return 0.2 + (MAX_LUX - 0.2) * sun * sun;
+}
+
+// Clouds passing every few minutes cut the light to a fifth
+static double brokenCloud(int minute)
+{
+  return rand() % 3 == 0 ? clearDay(minute) / 5 : clearDay(minute);
+}
+
+// A lamp switched on and off at random, in a dark room
+static double lamp(int)
+{
+  static const double levels[] = { 0.05, 3, 400, 2000 };
+  return levels[rand() % 4];
+}
+
+// Full sun, too bright for the sensor, then a storm
+static double overRange(int minute)
+{
+  return minute < 720 ? 45000 : 2 + 3 * (minute % 7);
+}
+
+static void replay(const char *curve, double (*light)(int), double maxOnMillis)
+{
+  uint8_t level = 0;
+  uint32_t onMillis = 0, readings = 0;
+  for (int minute = 0; minute < 1440; minute++)
+  {
+    double lux = light(minute);
+    Reading r = readSensor(level, lux);
+    checkReading(curve, minute, lux, r);
+    if (lux > MAX_LUX && (r.valid || level != 0))
+    {
+      printf("FAIL %s, minute %d: too bright, but valid or not at level 0\n", curve, minute);
+      failures++;
+    }
+    // Levels are at most 16 times apart, so this many counts can't come
+    // near the top half of the next level's range
+    if (r.valid && r.broadband < TSL2561_LOW_COUNTS / 16 && r.level + 1 < TSL2561_LEVELS &&
+        level <= r.level)
+    {
+      printf("FAIL %s, minute %d: %u counts at level %u, but not moving up\n",
+        curve, minute, r.broadband, r.level);
+      failures++;
+    }
+    onMillis += r.onMillis;
+    readings += r.valid;
+  }
+  double perReading = readings ? (double)onMillis / readings : 0;
+  printf("%-12s %4u/1440 valid, %5.1f ms on per valid reading\n", curve, readings, perReading);
+  if (perReading > maxOnMillis)
+  {
+    printf("FAIL %s: on %.1f ms per reading, wanted under %.0f\n", curve, perReading, maxOnMillis);
+    failures++;
+  }
+}
+
+
+// Under steady light, from any level, it climbs or drops a level a
+// reading until it reaches the right one, then stays put
+static void testSettles()
+{
+  for (double lux = 0.05; lux <= MAX_LUX; lux *= 1.01)
+  {
+    for (uint8_t start = 0; start < TSL2561_LEVELS; start++)
+    {
+      uint8_t level = start;
+      for (uint8_t i = 0; i < TSL2561_LEVELS - 1; i++)
+      {
+        readSensor(level, lux);
+      }
+      uint8_t settled = level;
+      for (int i = 0; i < 20; i++)
+      {
+        Reading r = readSensor(level, lux);
+        checkReading("steady", i, lux, r);
+        if (level != settled || r.onMillis != tsl2561WaitMillis[settled])
+        {
+          printf("FAIL steady %.2f lux from level %u: moved from %u to %u\n",
+            lux, start, settled, level);
+          failures++;
+          break;
+        }
+      }
+    }
+  }
+}
+
+
+int main()
+{
+  srand(1);
+  testSettles();
+  // Dusk and night need level 3, so a clear day averages well under 402
+  replay("clear day", clearDay, 201);
+  replay("broken cloud", brokenCloud, 201);
+  replay("lamp", lamp, 402);
+  replay("over range", overRange, 500);   // saturated readings cost time too
+  printf(failures ? "FAILED\n" : "PASSED\n");
+  return failures ? 1 : 0;
+}
@@ -4,23 +4,28 @@
 
 #include <Arduino.h>
 #include <Wire.h>
-#include <Adafruit_TSL2561_U.h>  // Adafruit_TSL2561 library for the TSL2561 digital luminosity (light) sensors
-#include <SDL_Arduino_SSD1306.h>    // Modification of Adafruit_SSD1306 for ESP8266 compatibility
+#include "TSL2561AutoRange.h"  // Reads the TSL2561 without waiting, picking its gain and integration time
+#include "ShadowSSD1306.h"   // SSD1306 driver that only sends the parts of the screen that changed
 #include <AMAdafruit_GFX.h>   // Needs a little change in original Adafruit library (See README.txt file)
 #include <SPI.h>            // For SPI comm (needed for not getting compile error)
 
 
 // Create an instance of the TLS Sensor, using the correct I2C address
 // Un-comment the correct one
-Adafruit_TSL2561_Unified tsl(TSL2561_ADDR_LOW);  // I2C address 0x29 (addr pin set LOW)
-// Adafruit_TSL2561_Unified tsl(TSL2561_ADDR_FLOAT);  // I2C address 0x39 (addr pin left floating)
-// Adafruit_TSL2561_Unified tsl(TSL2561_ADDR_HIGH);  // I2C address 0x49 (addr pin set high)
+TSL2561AutoRange tsl(TSL2561_ADDR_LOW);  // I2C address 0x29 (addr pin set LOW)
+// TSL2561AutoRange tsl(TSL2561_ADDR_FLOAT);  // I2C address 0x39 (addr pin left floating)
+// TSL2561AutoRange tsl(TSL2561_ADDR_HIGH);  // I2C address 0x49 (addr pin set high)
 
 // Create variables for the full spectrum (broadband) and IR luminosity results
-uint16_t broadband, ir, visible, lux;
+uint16_t broadband, ir, visible;
+uint32_t lux;
+
+// How often to start a reading, in ms
+const unsigned long readingInterval = 700;
+unsigned long lastReading = 0;
 
 // Create an instance of the OLED display
-SDL_Arduino_SSD1306 display(4); // FOR I2C
+ShadowSSD1306 display; // FOR I2C
 
 
 // The main setup function
@@ -29,7 +34,7 @@ void setup()
   Serial.begin(57600);
 
   pinMode(5, INPUT);
-  display.begin(SSD1306_SWITCHCAPVCC, 0x3C, false);  // initialize with the I2C addr 0x3C (for the 128x64)
+  display.begin(SSD1306_SWITCHCAPVCC, 0x3C);  // initialize with the I2C addr 0x3C (for the 128x64)
   display.clearDisplay();
   display.setTextSize(2);
   display.setTextColor(WHITE);
@@ -48,15 +53,9 @@ void setup()
     while (1);
   }
 
-  // You can change the gain on the fly, to adapt to brighter/dimmer light situations
-  tsl.setGain(TSL2561_GAIN_1X);         // set no gain (for bright situtations)
-  //tsl.setGain(TSL2561_GAIN_16X);      // set 16x gain (for dim situations)
-
-  // Changing the integration time gives you a longer time over which to sense light
-  // longer timelines are slower, but are good in very low light situtations!
-  tsl.setIntegrationTime(TSL2561_INTEGRATIONTIME_13MS);  // shortest integration time (bright light)
-  //tsl.setIntegrationTime(TSL2561_INTEGRATIONTIME_101MS);  // medium integration time (medium light)
-  //tsl.setIntegrationTime(TSL2561_INTEGRATIONTIME_402MS);  // longest integration time (dim light)
+  // There's no gain or integration time to set: each reading picks the
+  // shortest integration time and lowest gain that still give enough
+  // counts (see TSL2561Ranging.h)
 
   delay(3000);
 
@@ -67,19 +66,47 @@ void setup()
 // The loop function, which will run repeatedly
 void loop()
 {
+  // Start a reading every readingInterval.  This returns straight away;
+  // the sensor integrates while loop() keeps going.
+  if (!tsl.busy() && millis() - lastReading >= readingInterval)
+  {
+    lastReading = millis();
+    tsl.startReading();
+  }
+
+  // update() returns true once the reading is done
+  if (!tsl.update())
+  {
+    return;
+  }
+
   // Get both the broadband/full spectrum and IR light intensity from the sensor
   // These values are returned as raw ADC outputs (non-standard units)
-  tsl.getLuminosity(&broadband, &ir);
+  broadband = tsl.getBroadband();
+  ir = tsl.getIR();
   visible = broadband - ir;
   // Calculate and illuminance in lux (ie, convert sensor units to the standard SI unit)
-  lux = tsl.calculateLux(broadband, ir);
+  lux = tsl.getLux();
 
   // Print results to the OLED
 
-      if (isnan(broadband))
+      if (tsl.isError())
     {
-        Serial.println("Failed to read from Lumin");
-        display.println("Lumin failed");
+        Serial.println("Lumin sensor error: no answer on I2C");
+        display.clearDisplay();
+        display.setCursor(0,0);
+        display.println("Lumin: ");
+        display.println("sensor error");
+        display.display();
+    }
+    else if (!tsl.isValid())
+    {
+        Serial.println("Lumin saturated");
+        display.clearDisplay();
+        display.setCursor(0,0);
+        display.println("Lumin: ");
+        display.println("too bright");
+        display.display();
     }
     else
     {
@@ -90,7 +117,14 @@ void loop()
         display.println("Lumin: "); display.print(lux); display.println(" LUX");
         display.display();
 
-        delay(700);
+        // Only the digits that changed are sent, see ShadowSSD1306.h
+        Serial.print("OLED refresh: ");
+        Serial.print(display.lastBytes);
+        Serial.print(" bytes, ");
+        Serial.print(display.lastMicros);
+        Serial.print(" us, sensor on ");
+        Serial.print(tsl.getOnMillisPerReading());
+        Serial.println(" ms per reading");
     }
 
 
@@ -0,0 +1,87 @@
+/*
+  TSL2561AutoRange
+
+  Reads a TSL2561 light sensor without blocking loop(), choosing the gain
+  and integration time for each reading from the one before (see
+  TSL2561Ranging.h), so it neither saturates in sun nor reads 0 at dusk.
+
+  startReading() powers the sensor up, which starts it integrating, and
+  returns straight away.  update() returns straight away too until the
+  integration time has gone by, then reads both channels and powers the
+  sensor down again.  If the reading was close to saturating it is
+  retried at the next level down before update() reports it.  If the
+  sensor doesn't answer on I2C, the reading finishes as an error instead,
+  and the level is left alone, as a failed read says nothing about the
+  light.
+
+  The sensor is only powered while integrating, and the shortest
+  integration time that gives enough counts is used, so
+  getOnMillisPerReading() should stay small except in dim light.
+ */
+
+#ifndef TSL2561AutoRange_h
+#define TSL2561AutoRange_h
+
+#include <Arduino.h>
+#include "TSL2561Ranging.h"
+
+// I2C addresses, set by the ADDR pin
+#define TSL2561_ADDR_LOW   0x29
+#define TSL2561_ADDR_FLOAT 0x39
+#define TSL2561_ADDR_HIGH  0x49
+
+class TSL2561AutoRange
+{
+  uint8_t address;
+  uint8_t level;             // the setting for the next reading (0 to 3)
+
+  enum { IDLE, INTEGRATING } state;
+  unsigned long startMillis;
+  uint8_t readLevel;         // the setting the last reading was made at
+  bool timingSet;            // the sensor has readLevel's timing
+  uint16_t broadband, ir;
+  bool valid;
+  bool readError;            // the last reading failed on I2C
+
+  unsigned long onMillis;    // sensor powered, in total
+  uint16_t validReadings;
+
+  public:
+  TSL2561AutoRange(uint8_t i2cAddress);
+
+  // Check the sensor answers and power it down.  Returns false if not.
+  // Call again if the sensor has been without power.
+  bool begin();
+
+  // Start a reading.  Returns false if one is already running.
+  bool startReading();
+
+  // Call every time through loop().  Returns true once when a reading has
+  // finished.
+  bool update();
+
+  // True from startReading() until the reading finishes
+  bool busy();
+
+  // The last reading.  Not valid if it saturated even at the least
+  // sensitive setting, or if it couldn't be read.
+  bool isValid();
+  uint16_t getBroadband();
+  uint16_t getIR();
+  uint32_t getLux();
+  uint8_t getLevel();        // what it was read at, 0 (bright) to 3 (dim)
+
+  // True if the last reading failed because the sensor didn't answer on
+  // I2C, rather than because it was too bright
+  bool isError();
+
+  // Average time the sensor was powered for each valid reading, in ms
+  unsigned long getOnMillisPerReading();
+
+  private:
+  bool write8(uint8_t reg, uint8_t value);
+  bool read16(uint8_t reg, uint16_t &value);
+  void powerUp();
+};
+
+#endif
@@ -0,0 +1,109 @@
+/*
+  TSL2561Ranging
+
+  Picks the TSL2561 gain and integration time for the next reading from
+  the counts of the last one, and turns counts into lux.
+
+  The settings form a ladder, from least to most sensitive, that never
+  uses a longer integration time than it has to:
+
+    level 0:  13.7 ms, 1x gain      (bright sun)
+    level 1:  13.7 ms, 16x gain
+    level 2:  101 ms,  16x gain
+    level 3:  402 ms,  16x gain     (dusk)
+
+  A reading near the top of its range is thrown away and the next one is
+  made a level lower.  A level higher is only used when the counts are
+  too few to say much (below TSL2561_LOW_COUNTS) and would still sit in
+  the bottom half of the higher level's range.  A level lower is used as
+  soon as it would still give TSL2561_HIGH_COUNTS.  The gap between the
+  two thresholds keeps it from hopping back and forth.
+
+  The lux formula is the integer one from the TSL2561 datasheet (T, FN
+  and CL packages), the same one Adafruit's library uses.
+
+  This file only needs <stdint.h>, so the math can be checked on a PC.
+ */
+
+#ifndef TSL2561Ranging_h
+#define TSL2561Ranging_h
+
+#include <stdint.h>
+
+#define TSL2561_LEVELS 4
+#define TSL2561_LOW_COUNTS 200    // fewer counts than this and a level up helps
+#define TSL2561_HIGH_COUNTS 800   // a level down is fine if it still gives this many
+
+// Timing register value (gain bit 0x10, integration 0 to 2) for each level
+static const uint8_t tsl2561Timing[TSL2561_LEVELS] = {0x00, 0x10, 0x11, 0x12};
+
+// How long to wait for each level's integration to finish, in ms
+static const uint16_t tsl2561WaitMillis[TSL2561_LEVELS] = {15, 15, 103, 404};
+
+// Counts above this are too close to saturating (90% of full scale: 5047
+// counts at 13.7 ms, 37177 at 101 ms, 65535 at 402 ms)
+static const uint16_t tsl2561Clip[TSL2561_LEVELS] = {4542, 4542, 33459, 58981};
+
+// What each level's counts are multiplied by to match 402 ms at 16x, in
+// 1/1024ths (datasheet CHSCALE)
+static const uint32_t tsl2561Scale[TSL2561_LEVELS] = {0x7517UL << 4, 0x7517, 0x0FE7, 0x0400};
+
+
+// What a count at one level would read at another
+inline uint32_t tsl2561Predict(uint16_t counts, uint8_t from, uint8_t to)
+{
+  return (uint32_t)((uint64_t)counts * tsl2561Scale[from] / tsl2561Scale[to]);
+}
+
+// The level for the next reading.  valid says whether this reading can be
+// used, or was too close to saturating.
+inline uint8_t tsl2561NextLevel(uint8_t level, uint16_t broadband, uint16_t ir, bool &valid)
+{
+  valid = broadband < tsl2561Clip[level] && ir < tsl2561Clip[level];
+  if (!valid)
+  {
+    return level > 0 ? level - 1 : 0;
+  }
+  if (level + 1 < TSL2561_LEVELS && broadband < TSL2561_LOW_COUNTS &&
+      tsl2561Predict(broadband, level, level + 1) < tsl2561Clip[level + 1] / 2)
+  {
+    return level + 1;
+  }
+  if (level > 0 && tsl2561Predict(broadband, level, level - 1) >= TSL2561_HIGH_COUNTS)
+  {
+    return level - 1;
+  }
+  return level;
+}
+
+// Lux from a reading made at a level
+inline uint32_t tsl2561Lux(uint8_t level, uint16_t broadband, uint16_t ir)
+{
+  // Scale both channels to 402 ms at 16x
+  uint32_t channel0 = ((uint64_t)broadband * tsl2561Scale[level]) >> 10;
+  uint32_t channel1 = ((uint64_t)ir * tsl2561Scale[level]) >> 10;
+
+  // The IR to broadband ratio picks a piece of the response curve
+  uint32_t ratio = 0;
+  if (channel0 != 0)
+  {
+    ratio = ((channel1 << 10) / channel0 + 1) >> 1;
+  }
+
+  uint32_t b, m;
+  if (ratio <= 0x0040)      { b = 0x01F2; m = 0x01BE; }
+  else if (ratio <= 0x0080) { b = 0x0214; m = 0x02D1; }
+  else if (ratio <= 0x00C0) { b = 0x023F; m = 0x037B; }
+  else if (ratio <= 0x0100) { b = 0x0270; m = 0x03FE; }
+  else if (ratio <= 0x0138) { b = 0x016F; m = 0x01FC; }
+  else if (ratio <= 0x019A) { b = 0x00D2; m = 0x00FB; }
+  else if (ratio <= 0x029A) { b = 0x0018; m = 0x0012; }
+  else                      { b = 0x0000; m = 0x0000; }
+
+  uint32_t plus = channel0 * b;
+  uint32_t minus = channel1 * m;
+  uint32_t temp = plus > minus ? plus - minus : 0;
+  return (temp + (1UL << 13)) >> 14;
+}
+
+#endif
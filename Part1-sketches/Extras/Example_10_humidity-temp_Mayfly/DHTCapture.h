@@ -0,0 +1,93 @@
+/*
+  DHTCapture
+
+  Reads a DHT11/DHT22 humidity and temperature sensor without turning
+  interrupts off and without blocking loop().
+
+  Adafruit's library times every bit in a loop with interrupts off for
+  about 5 ms, and reads the sensor again on every call.  Here update()
+  sends the start signal (holding the line low, timed with millis()),
+  then lets go and a pin change interrupt notes micros() at every
+  falling edge.  Once the sensor is done, update() decodes the gaps
+  between edges (see DHTDecode.h) and keeps the result.
+
+  A new reading is only started MinIntervalMs after the last one, as the
+  sensor needs, so readHumidity() and readTemperature() can be called as
+  often as you like: they return the last good reading, or NAN before the
+  first one.
+
+  The interrupt handler is for port B (pins 8 to 15), where the Mayfly's
+  D10-11 Grove connector is.
+ */
+
+#ifndef DHTCapture_h
+#define DHTCapture_h
+
+#include <Arduino.h>
+#include "DHTDecode.h"
+
+class DHTCapture
+{
+  uint8_t pin;
+  uint8_t type;
+
+  enum { IDLE, STARTING, RECEIVING } state;
+  unsigned long stateMillis;
+  unsigned long lastStart;
+  bool autoStart;
+
+  bool haveReading;
+  int16_t humidity;          // tenths of a percent
+  int16_t temperature;       // tenths of a degree C
+  unsigned long readingMillis;
+  DHTResult lastResult;
+  uint16_t failures;
+
+  public:
+  static const unsigned long MinIntervalMs = 2000;
+  static const unsigned long StartLowMs = 20;     // the start signal for a DHT11
+  static const unsigned long StartLowMs22 = 2;    // DHT21/22 want 1 to 10 ms
+  static const unsigned long TimeoutMs = 10;      // a whole transfer takes about 5 ms
+
+  DHTCapture(uint8_t pin, uint8_t type);
+
+  // Set up the pin and its interrupt.  Returns false if the pin isn't on
+  // port B.
+  bool begin();
+
+  // Call once the sensor has power again after being switched off, and
+  // has had its warm-up (see PowerRail.h).  Drops any reading that was
+  // cut short and lets the next one start straight away.
+  void powerRestored();
+
+  // Call every time through loop().  Starts a reading whenever
+  // MinIntervalMs has passed (unless auto start is off), and returns true
+  // once when one finishes (good or not).
+  bool update();
+
+  // Start a reading now.  Returns false if one is running or
+  // MinIntervalMs hasn't passed since the last.
+  bool startReading();
+
+  // Whether update() starts readings by itself (it does unless told not to)
+  void setAutoStart(bool on);
+
+  // True while a reading is in progress
+  bool busy();
+
+  // The last good reading, or NAN if there hasn't been one
+  float readHumidity();
+  float readTemperature();
+
+  // The same, in tenths.  Return false if there hasn't been a good reading.
+  bool getTenths(int16_t &humidityTenths, int16_t &temperatureTenths);
+
+  // How long ago the last good reading was taken, in ms
+  unsigned long getAge();
+
+  // How the last reading went, and how many have failed
+  DHTResult getLastResult();
+  uint16_t getFailures();
+};
+
+#endif
@@ -0,0 +1,110 @@
+/*
+  DHTDecode
+
+  Turns the pulse train from a DHT11/DHT22 into humidity and temperature.
+
+  After the start signal the sensor answers with an 80 us low and an 80 us
+  high, then sends 40 bits, each a 50 us low followed by a high of about
+  27 us for a 0 or 70 us for a 1, and finally a 50 us low.  So the time
+  from one falling edge to the next is about 77 us for a 0 and 120 us for
+  a 1.  After the 160 us of the answer come 40 of those gaps, the data,
+  most significant bit first.  The fifth byte is the sum of the other four.
+
+  Exactly 41 gaps are wanted.  Two 0 bits with the edge between them
+  missed look just like a 1, and noise can split a bit in two, so a
+  missed or extra edge would otherwise only be caught by the checksum,
+  and one time in 256 not at all.
+
+  This file only needs <stdint.h>, so it can be checked on a PC against
+  recorded gaps.
+ */
+
+#ifndef DHTDecode_h
+#define DHTDecode_h
+
+#include <stdint.h>
+
+// Sensor types, as numbered by Adafruit's library
+#ifndef DHT11
+#define DHT11 11
+#define DHT22 22
+#define DHT21 21
+#endif
+
+#define DHT_BITS 40
+#define DHT_MIN_GAP_US 50     // shorter than any real bit: noise
+#define DHT_ONE_GAP_US 100    // gaps longer than this are 1s
+#define DHT_MAX_GAP_US 200    // longer than any real bit: an edge was missed
+#define DHT_MIN_START_GAP_US 130   // the answer's 80 us low and 80 us high
+
+enum DHTResult
+{
+  DHT_OK,
+  DHT_TOO_FEW_EDGES,  // the sensor didn't answer, stopped part way, or an edge was missed
+  DHT_BAD_GAP,        // a gap was too short or too long to be a bit, or noise added an edge
+  DHT_BAD_CHECKSUM,
+};
+
+// Decode the gaps between falling edges (in us, oldest first, from the
+// start of the answer to the end of the last bit) into the sensor's 5 bytes
+inline DHTResult dhtDecode(const uint16_t *gaps, uint8_t count, uint8_t *data)
+{
+  if (count < DHT_BITS + 1)
+  {
+    return DHT_TOO_FEW_EDGES;
+  }
+  if (count > DHT_BITS + 1 || gaps[0] < DHT_MIN_START_GAP_US || gaps[0] > DHT_MAX_GAP_US)
+  {
+    return DHT_BAD_GAP;
+  }
+  gaps++;
+
+  for (uint8_t i = 0; i < 5; i++)
+  {
+    data[i] = 0;
+  }
+  for (uint8_t i = 0; i < DHT_BITS; i++)
+  {
+    if (gaps[i] < DHT_MIN_GAP_US || gaps[i] > DHT_MAX_GAP_US)
+    {
+      return DHT_BAD_GAP;
+    }
+    data[i / 8] <<= 1;
+    if (gaps[i] > DHT_ONE_GAP_US)
+    {
+      data[i / 8] |= 1;
+    }
+  }
+
+  if ((uint8_t)(data[0] + data[1] + data[2] + data[3]) != data[4])
+  {
+    return DHT_BAD_CHECKSUM;
+  }
+  return DHT_OK;
+}
+
+// Relative humidity in tenths of a percent
+inline int16_t dhtHumidityTenths(uint8_t type, const uint8_t *data)
+{
+  if (type == DHT11)
+  {
+    return data[0] * 10 + data[1] % 10;
+  }
+  return (int16_t)(data[0] << 8 | data[1]);
+}
+
+// Temperature in tenths of a degree C
+inline int16_t dhtTemperatureTenths(uint8_t type, const uint8_t *data)
+{
+  int16_t t;
+  if (type == DHT11)
+  {
+    // Newer DHT11s send a tenths digit, and set bit 7 below 0 C
+    t = data[2] * 10 + (data[3] & 0x0F);
+    return (data[3] & 0x80) ? -t : t;
+  }
+  t = (int16_t)((data[2] & 0x7F) << 8 | data[3]);
+  return (data[2] & 0x80) ? -t : t;
+}
+
+#endif
@@ -2,7 +2,9 @@
 
 #include <Arduino.h>
 #include <Wire.h>
-#include "DHT.h"      // Includes the Adafruit DHT-sensor-library 1.3.0+, which was updated to require the Unified Adafruit_Sensor sensor
+#include "DHTCapture.h"   // Reads the DHT from a pin change interrupt, without turning interrupts off
+#include "PowerRail.h"    // Powers the Grove sockets only while the sensor is read
+#include "FixedConvert.h" // Unit conversions without float math
 
 #define DHTPIN 10     // what pin the DHT signal is connected to
 
@@ -16,39 +18,96 @@
 // Connect pin 4 (on the right) of the sensor to GROUND
 // Connect a 10K resistor from pin 2 (data) to pin 1 (power) of the sensor
 
-DHT dht(DHTPIN, DHTTYPE);
+DHTCapture dht(DHTPIN, DHTTYPE);
+
+// Pin 22 powers the D10-11 and D6-7 Grove Ports
+PowerRail rail(22);
+
+// The DHT won't answer for a second after power up (DHT11 and DHT22 datasheets)
+const uint16_t DHTWarmupMs = 1000;
+
+// How often to take a reading, in ms
+const unsigned long readingInterval = 5000;
+unsigned long lastReading = 0;
+bool requested = false;
+
+// After each power-up
+void dhtPowered()
+{
+    dht.powerRestored();
+}
+
+// Print a number of tenths, like 72.5
+void printTenths(long tenths)
+{
+    if (tenths < 0)
+    {
+        Serial.print('-');
+        tenths = -tenths;
+    }
+    Serial.print(tenths / 10);
+    Serial.print('.');
+    Serial.print(tenths % 10);
+}
 
 void setup()
 {
-    pinMode(22, OUTPUT);    // Setting up Pin 22 to provide power to Grove Ports
-    digitalWrite(22, HIGH); // Provide power to D10-11 and D6-7 Grove Ports
-    delay(200);
     Serial.begin(57600);
     Serial.println("Digital Humidity/Temperature");
 
     dht.begin();
+    dht.setAutoStart(false);   // only read while the rail is on
+
+    // Starts with the rail off, and the DHT pin let go
+    rail.addDevice(DHTWarmupMs, dhtPowered);
+    rail.addPin(DHTPIN);
+    rail.begin();
 }
 
 void loop()
 {
-    // Reading temperature or humidity takes about 250 milliseconds
-    // Sensor readings may also be up to 2 seconds old
-    float h = dht.readHumidity();
-    float t = dht.readTemperature();
-    float tf = (t*9.0/5.0)+32;
-
-    // check if returns are valid, if they are NaN (not a number) then something went wrong
-    if (isnan(t) || isnan(h))
+    // Every readingInterval, power the sensor up
+    if (!rail.isOn() && millis() - lastReading >= readingInterval)
+    {
+        lastReading = millis();
+        rail.powerUp();
+    }
+
+    // Once it has warmed up, start a reading
+    if (!requested && rail.ready())
+    {
+        requested = dht.startReading();
+    }
+
+    // update() returns true when the reading has finished
+    if (!dht.update())
+    {
+        return;
+    }
+    rail.powerDown();
+    requested = false;
+
+    // The last good reading, in tenths, straight away.  Whole numbers
+    // keep float math (slow, in software on the AVR) out of the sketch.
+    int16_t h, t;
+    bool valid = dht.getTenths(h, t);
+    long tf = fahrenheitFromCelsius(t, 10);
+
+    // check the reading is good, and that there has been one at all
+    if (dht.getLastResult() != DHT_OK || !valid)
     {
         Serial.println("Failed to read from DHT");
     }
     else
     {
         Serial.print("Humidity: ");
-        Serial.print(h);
+        printTenths(h);
         Serial.print(" %\tf");
         Serial.print("Temperature: ");
-        Serial.print(tf);
+        printTenths(tf);
         Serial.println(" *F");
     }
+    Serial.print("Power on ");
+    printTenths(rail.getDutyPermille());
+    Serial.println("% of the time");
 }
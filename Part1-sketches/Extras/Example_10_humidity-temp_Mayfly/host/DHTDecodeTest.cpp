@@ -0,0 +1,195 @@
+/*
+  DHTDecodeTest
+
+  Builds the pulse trains a DHT11 or DHT22 sends, with every low and high
+  anywhere in the datasheet's range, and stamps each falling edge the way
+  DHTCapture's interrupt does: micros() in 8 us steps on the 8 MHz Mayfly,
+  up to 12 us late for another interrupt, and only the low 16 bits.
+  Checks that dhtDecode():
+
+  - reads every such trace right, with the humidity and temperature the
+    datasheets' examples give
+  - refuses a trace with an edge missed, or stopped part way, as too few
+    edges, and one with an extra edge from noise as a bad gap
+
+  Build and run from this folder:
+    g++ -std=c++11 -Wall -I.. -o DHTDecodeTest DHTDecodeTest.cpp && ./DHTDecodeTest
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "DHTDecode.h"
+
+#define EDGES (DHT_BITS + 2)   // the response, 40 bits, and the final low
+
+static int failures = 0;
+
+static void expect(bool ok, const char *what)
+{
+  if (!ok)
+  {
+    printf("FAIL %s\n", what);
+    failures++;
+  }
+}
+
+static double randomBetween(double low, double high)
+{
+  return low + (high - low) * rand() / RAND_MAX;
+}
+
+// The times of the falling edges a sensor sending these bytes makes, in us
+static void makeTrace(const uint8_t *data, double *edges)
+{
+  double t = randomBetween(0, 100000);
+  edges[0] = t;
+  t += randomBetween(75, 85) + randomBetween(75, 85);   // response low and high
+  for (uint8_t i = 0; i < DHT_BITS; i++)
+  {
+    edges[i + 1] = t;
+    bool one = (data[i / 8] >> (7 - i % 8)) & 1;
+    t += randomBetween(48, 55) + (one ? randomBetween(68, 75) : randomBetween(22, 30));
+  }
+  edges[DHT_BITS + 1] = t;
+}
+
+// What the interrupt would have stamped each edge with
+static uint16_t stamp(double edge)
+{
+  uint32_t late = (uint32_t)(edge + randomBetween(0, 12));
+  return (uint16_t)(late & ~7U);
+}
+
+// Gaps between the stamps of the edges that were seen, as DHTCapture
+// works them out
+static uint8_t gapsFor(const double *edges, uint8_t count, uint16_t *gaps)
+{
+  uint16_t last = stamp(edges[0]);
+  for (uint8_t i = 1; i < count; i++)
+  {
+    uint16_t now = stamp(edges[i]);
+    gaps[i - 1] = now - last;
+    last = now;
+  }
+  return count - 1;
+}
+
+static void randomFrame(uint8_t *data)
+{
+  for (uint8_t i = 0; i < 4; i++)
+  {
+    data[i] = rand();
+  }
+  data[4] = data[0] + data[1] + data[2] + data[3];
+}
+
+
+static void testKnownReadings()
+{
+  uint16_t gaps[EDGES];
+  double edges[EDGES];
+  uint8_t got[5];
+
+  // DHT22 datasheet: 65.2 %RH, 35.1 C, and -10.1 C
+  const uint8_t dht22[5] = { 0x02, 0x8C, 0x01, 0x5F, 0xEE };
+  makeTrace(dht22, edges);
+  expect(dhtDecode(gaps, gapsFor(edges, EDGES, gaps), got) == DHT_OK &&
+    dhtHumidityTenths(DHT22, got) == 652 && dhtTemperatureTenths(DHT22, got) == 351,
+    "DHT22 65.2 %, 35.1 C");
+
+  const uint8_t dht22cold[5] = { 0x02, 0x8C, 0x80, 0x65, 0x73 };
+  makeTrace(dht22cold, edges);
+  expect(dhtDecode(gaps, gapsFor(edges, EDGES, gaps), got) == DHT_OK &&
+    dhtTemperatureTenths(DHT22, got) == -101, "DHT22 -10.1 C");
+
+  // DHT11: whole degrees, and a tenths digit on newer parts
+  const uint8_t dht11[5] = { 0x37, 0x00, 0x17, 0x00, 0x4E };
+  makeTrace(dht11, edges);
+  expect(dhtDecode(gaps, gapsFor(edges, EDGES, gaps), got) == DHT_OK &&
+    dhtHumidityTenths(DHT11, got) == 550 && dhtTemperatureTenths(DHT11, got) == 230,
+    "DHT11 55 %, 23 C");
+
+  const uint8_t dht11cold[5] = { 0x37, 0x00, 0x02, 0x84, 0xBD };
+  makeTrace(dht11cold, edges);
+  expect(dhtDecode(gaps, gapsFor(edges, EDGES, gaps), got) == DHT_OK &&
+    dhtTemperatureTenths(DHT11, got) == -24, "DHT11 -2.4 C");
+
+  expect(dhtDecode(gaps, 0, got) == DHT_TOO_FEW_EDGES, "no answer");
+}
+
+
+static void testTraces()
+{
+  uint16_t gaps[EDGES + 1];
+  double edges[EDGES + 1];
+  uint8_t data[5], got[5];
+
+  uint32_t n;
+  for (n = 0; n < 100000 && failures < 10; n++)
+  {
+    randomFrame(data);
+    makeTrace(data, edges);
+
+    // Every edge seen
+    DHTResult result = dhtDecode(gaps, gapsFor(edges, EDGES, gaps), got);
+    if (result != DHT_OK || memcmp(data, got, 5) != 0)
+    {
+      printf("FAIL trace %u: result %d\n", n, result);
+      failures++;
+    }
+
+    // Stopped part way
+    uint8_t seen = 1 + rand() % (EDGES - 1);
+    if (dhtDecode(gaps, gapsFor(edges, seen, gaps), got) != DHT_TOO_FEW_EDGES)
+    {
+      printf("FAIL trace %u: only %u edges, but not too few\n", n, seen);
+      failures++;
+    }
+
+    // One edge missed
+    double missed[EDGES];
+    uint8_t skip = rand() % EDGES;
+    for (uint8_t i = 0, j = 0; i < EDGES; i++)
+    {
+      if (i != skip)
+      {
+        missed[j++] = edges[i];
+      }
+    }
+    if (dhtDecode(gaps, gapsFor(missed, EDGES - 1, gaps), got) != DHT_TOO_FEW_EDGES)
+    {
+      printf("FAIL trace %u: edge %u missed, but not too few\n", n, skip);
+      failures++;
+    }
+
+    // An extra edge from noise, somewhere in the bits
+    double noisy[EDGES + 1];
+    uint8_t after = 1 + rand() % DHT_BITS;
+    for (uint8_t i = 0, j = 0; i < EDGES; i++)
+    {
+      noisy[j++] = edges[i];
+      if (i == after)
+      {
+        noisy[j++] = edges[i] + randomBetween(2, edges[i + 1] - edges[i] - 2);
+      }
+    }
+    result = dhtDecode(gaps, gapsFor(noisy, EDGES + 1, gaps), got);
+    if (result != DHT_BAD_GAP)
+    {
+      printf("FAIL trace %u: noise after edge %u, but result %d\n", n, after, result);
+      failures++;
+    }
+  }
+  printf("%u traces, each also cut short, with an edge missed and with noise\n", n);
+}
+
+
+int main()
+{
+  srand(1);
+  testKnownReadings();
+  testTraces();
+  printf(failures ? "FAILED\n" : "PASSED\n");
+  return failures ? 1 : 0;
+}
@@ -2,7 +2,7 @@
 
 #include <Arduino.h>
 #include <Wire.h>
-#include "DHT.h"      // Includes the Adafruit DHT-sensor-library 1.3.0+, which was updated to require the Unified Adafruit_Sensor sensor
+#include "DHTCapture.h"   // Reads the DHT from a pin change interrupt, without turning interrupts off
 
 #define DHTPIN 10     // what pin the DHT signal is connected to
 
@@ -16,7 +16,7 @@
 // Connect pin 4 (on the right) of the sensor to GROUND
 // Connect a 10K resistor from pin 2 (data) to pin 1 (power) of the sensor
 
-DHT dht(DHTPIN, DHTTYPE);
+DHTCapture dht(DHTPIN, DHTTYPE);
 
 void setup()
 {
@@ -31,15 +31,21 @@ void setup()
 
 void loop()
 {
-    // Reading temperature or humidity takes about 250 milliseconds
-    // Sensor readings may also be up to 2 seconds old
+    // A new reading is started every 2 seconds, the fastest the sensor
+    // allows.  update() returns true when one has finished.
+    if (!dht.update())
+    {
+        return;
+    }
+
+    // These return the last good reading straight away
     float h = dht.readHumidity();
     float t = dht.readTemperature();
     // now convert to Fahrenheight
     float temperatureF = (t * 9.0 / 5.0) + 32.0;
 
     // check if returns are valid, if they are NaN (not a number) then something went wrong
-    if (isnan(t) || isnan(h))
+    if (dht.getLastResult() != DHT_OK || isnan(t) || isnan(h))
     {
         Serial.println("Failed to read from DHT");
     }
@@ -54,7 +60,6 @@ void loop()
         Serial.print("       Temp: ");
         Serial.print(temperatureF); 
         Serial.println(" *F");
-        delay(1000);
     }
 
  
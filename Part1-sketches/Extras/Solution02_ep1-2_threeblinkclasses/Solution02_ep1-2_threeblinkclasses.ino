@@ -1,4 +1,19 @@
+/*
+  Three Flashers, each blinking an LED with its own on and off times,
+  run from a scheduler that keeps them in order of their next change and
+  idles the CPU in between.
+
+  Idle mode is as deep as it can sleep and still keep millis(), so the
+  Timer0 interrupt that counts millis() wakes it every 1.024 ms at 16 MHz
+  and every 2.048 ms on the 8 MHz Mayfly, whatever the LEDs are doing.
+  That tick, not the blink rate, bounds the wakeups: about 490 a second
+  on the Mayfly.  The statistics printed every 10 s count them.
+ */
+
 #include <Arduino.h>
+#ifdef __AVR__
+#include <avr/sleep.h>
+#endif
 
 class Flasher
 {
@@ -11,6 +26,7 @@ class Flasher
   // These maintain the current state
   int ledState;                 // ledState used to set the LED
   unsigned long previousMillis;   // will store last time LED was updated
+  unsigned long nextMillis;       // when the LED is next due to change
 
   // Constructor - creates a Flasher 
   // and initializes the member variables and state
@@ -25,6 +41,7 @@ class Flasher
   
   ledState = LOW; 
   previousMillis = 0;
+  nextMillis = off;
   }
 
   void Update()
@@ -32,19 +49,190 @@ class Flasher
     // check to see if it's time to change the state of the LED
     unsigned long currentMillis = millis();
      
-    if((ledState == HIGH) && (currentMillis - previousMillis >= OnTime))
+    if((ledState == HIGH) && (currentMillis - previousMillis >= (unsigned long)OnTime))
     {
       ledState = LOW;  // Turn it off
       previousMillis = currentMillis;  // Remember the time
       digitalWrite(ledPin, ledState);  // Update the actual LED
     }
-    else if ((ledState == LOW) && (currentMillis - previousMillis >= OffTime))
+    else if ((ledState == LOW) && (currentMillis - previousMillis >= (unsigned long)OffTime))
     {
       ledState = HIGH;  // turn it on
       previousMillis = currentMillis;   // Remember the time
       digitalWrite(ledPin, ledState);   // Update the actual LED
     }
   }
+
+  // False if the on or off time is zero (or less), so the LED would
+  // never wait
+  bool Valid()
+  {
+    return OnTime > 0 && OffTime > 0;
+  }
+
+  // The time the LED is next due to change, used by the FlasherScheduler
+  unsigned long Deadline()
+  {
+    return nextMillis;
+  }
+
+  // Change the LED and work out when it is due to change again.
+  // The next deadline is counted from the old one, not from "now",
+  // so a late wakeup doesn't make the blink pattern drift.
+  void Toggle()
+  {
+    previousMillis = nextMillis;
+    if (ledState == HIGH)
+    {
+      ledState = LOW;  // Turn it off
+      nextMillis += OffTime;
+    }
+    else
+    {
+      ledState = HIGH;  // turn it on
+      nextMillis += OnTime;
+    }
+    digitalWrite(ledPin, ledState);  // Update the actual LED
+  }
+};
+
+
+// True if time a comes before time b, even when millis() wraps around.
+// millis() is 32 bits, so the difference is taken as 32 bits too (the
+// same as long on the AVR, and still right where long is 64 bits).
+bool isBefore(unsigned long a, unsigned long b)
+{
+  return (int32_t)(a - b) < 0;
+}
+
+
+// Keeps every Flasher in a min-heap ordered by its next deadline, so each
+// pass only looks at the Flashers that are actually due, and the board can
+// sleep until the earliest one instead of polling them all.
+#define MAX_FLASHERS 32
+
+class FlasherScheduler
+{
+  Flasher *heap[MAX_FLASHERS];   // heap[0] is always the earliest deadline
+  uint8_t count;
+
+  public:
+  // These are statistics, so we can see what the scheduler costs
+  unsigned long wakeups;      // times the CPU came back from sleep
+  unsigned long events;       // LED changes made
+  unsigned long busyMicros;   // time spent picking and re-queueing Flashers
+
+  FlasherScheduler()
+  {
+    count = 0;
+    wakeups = 0;
+    events = 0;
+    busyMicros = 0;
+  }
+
+  // Add a Flasher to the schedule.  Returns false if the schedule is full,
+  // or the Flasher has a zero on or off time: it would always be due, and
+  // Run() would never get past it.
+  bool Add(Flasher *flasher)
+  {
+    if (count >= MAX_FLASHERS || !flasher->Valid())
+    {
+      return false;
+    }
+    heap[count] = flasher;
+    siftUp(count);
+    count++;
+    return true;
+  }
+
+  // Run every Flasher that is due, then sleep until the next one is
+  void Run()
+  {
+    if (count == 0)
+    {
+      return;
+    }
+
+    unsigned long start = micros();
+    unsigned long currentMillis = millis();
+    while (!isBefore(currentMillis, heap[0]->Deadline()))
+    {
+      heap[0]->Toggle();
+      events++;
+      siftDown(0);   // its deadline moved later, so push it back down
+    }
+    busyMicros += micros() - start;
+
+    sleepUntil(heap[0]->Deadline());
+  }
+
+  private:
+  void siftUp(uint8_t i)
+  {
+    while (i > 0)
+    {
+      uint8_t parent = (i - 1) / 2;
+      if (!isBefore(heap[i]->Deadline(), heap[parent]->Deadline()))
+      {
+        break;
+      }
+      swap(i, parent);
+      i = parent;
+    }
+  }
+
+  void siftDown(uint8_t i)
+  {
+    while (true)
+    {
+      uint8_t smallest = i;
+      uint8_t left = 2 * i + 1;
+      uint8_t right = left + 1;
+      if (left < count && isBefore(heap[left]->Deadline(), heap[smallest]->Deadline()))
+      {
+        smallest = left;
+      }
+      if (right < count && isBefore(heap[right]->Deadline(), heap[smallest]->Deadline()))
+      {
+        smallest = right;
+      }
+      if (smallest == i)
+      {
+        break;
+      }
+      swap(i, smallest);
+      i = smallest;
+    }
+  }
+
+  void swap(uint8_t a, uint8_t b)
+  {
+    Flasher *temp = heap[a];
+    heap[a] = heap[b];
+    heap[b] = temp;
+  }
+
+  // Idle the CPU until the deadline.  The timer that runs millis() keeps
+  // ticking in idle mode and wakes us every 1 or 2 ms; we only compare
+  // against the one saved deadline before going back to sleep.
+  // Every one of those wakeups is counted, as each costs power.
+  // (Power-save mode would stop that timer, and the Mayfly has no watch
+  // crystal on Timer2 to keep time with instead.)
+  void sleepUntil(unsigned long deadline)
+  {
+#ifdef __AVR__
+    set_sleep_mode(SLEEP_MODE_IDLE);
+    while (isBefore(millis(), deadline))
+    {
+      sleep_enable();
+      sleep_cpu();
+      sleep_disable();
+      wakeups++;
+    }
+#else
+    (void)deadline;   // nothing to sleep on, off the board
+#endif
+  }
 };
 
 
@@ -52,13 +240,34 @@ Flasher led1(8, 100, 400);
 Flasher led2(9, 350, 350);
 Flasher led3(22, 500, 1000);
 
+FlasherScheduler scheduler;
+
+unsigned long reportMillis = 0;
+const unsigned long reportInterval = 10000;   // print statistics every 10 s
+
 void setup()
 {
+  Serial.begin(57600);
+
+  scheduler.Add(&led1);
+  scheduler.Add(&led2);
+  scheduler.Add(&led3);
 }
 
 void loop()
 {
-  led1.Update();
-  led2.Update();
-  led3.Update();
+  scheduler.Run();
+
+  // Every so often, print how often we woke up and what each LED change cost
+  if (millis() - reportMillis >= reportInterval)
+  {
+    reportMillis += reportInterval;
+    Serial.print("wakeups/s: ");
+    Serial.print(scheduler.wakeups * 1000.0 / reportInterval);
+    Serial.print("  us/event: ");
+    Serial.println(scheduler.events ? (float)scheduler.busyMicros / scheduler.events : 0.0);
+    scheduler.wakeups = 0;
+    scheduler.events = 0;
+    scheduler.busyMicros = 0;
+  }
 }
@@ -0,0 +1,54 @@
+/*
+  Just enough of Arduino.h to build the sketch on a PC, with a pretend
+  clock that the test moves on by hand, and pins that only remember what
+  was written to them.
+ */
+
+#ifndef Arduino_h
+#define Arduino_h
+
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define HIGH 1
+#define LOW 0
+#define OUTPUT 1
+
+// The pretend clock is 32 bits, as the AVR's is, so millis() wraps round
+// after 49.7 days the same way here even where long is 64 bits.
+extern uint32_t hostMillis;
+extern uint8_t hostPins[64];
+extern uint32_t hostWrites[64];   // digitalWrite()s to each pin
+
+inline unsigned long millis()
+{
+  return hostMillis;
+}
+
+inline unsigned long micros()
+{
+  return (uint32_t)(hostMillis * 1000);
+}
+
+inline void pinMode(int, int)
+{
+}
+
+inline void digitalWrite(int pin, int level)
+{
+  hostPins[pin] = level;
+  hostWrites[pin]++;
+}
+
+struct HostSerial
+{
+  void begin(unsigned long) {}
+  template <class T> void print(T) {}
+  template <class T> void println(T) {}
+};
+
+extern HostSerial Serial;
+
+#endif
@@ -0,0 +1,176 @@
+/*
+  FlasherSchedulerTest
+
+  Builds the Solution02 sketch on a PC against a pretend clock, and checks
+  that every LED changes exactly when its on and off times say it should:
+  with loop() running every millisecond, with late and bunched-up wakeups,
+  and across the day millis() wraps round to 0.  Also checks that the
+  scheduler refuses a Flasher with a zero on or off time.
+
+  Prints, for each run, the LED changes per second of pretend time and
+  what Run() took per change on this PC.  Sleeping is left out off the
+  board, so wakeups can't be counted here; on the board Timer0 wakes the
+  idle CPU every 1 or 2 ms (see the sketch's header).
+
+  Build and run from this folder:
+    g++ -std=c++11 -Wall -Wextra -I. -o FlasherSchedulerTest FlasherSchedulerTest.cpp && ./FlasherSchedulerTest
+ */
+
+#include <chrono>
+#include "Arduino.h"
+#include "../Solution02_ep1-2_threeblinkclasses.ino"
+
+uint32_t hostMillis = 0;
+uint8_t hostPins[64];
+uint32_t hostWrites[64];
+HostSerial Serial;
+
+static int failures = 0;
+
+struct Pattern
+{
+  uint8_t pin;
+  uint32_t on;
+  uint32_t off;
+};
+
+// How many times a Flasher should have changed by a time, counting past
+// the wrap: it turns on at off, off + period, ... and off at period, ...
+static uint64_t expectedChanges(const Pattern &p, uint64_t now)
+{
+  uint64_t period = p.on + p.off;
+  return 2 * (now / period) + (now % period >= p.off ? 1 : 0);
+}
+
+static void check(const Pattern &p, uint64_t now, const char *test)
+{
+  uint64_t expected = expectedChanges(p, now);
+  if (hostWrites[p.pin] != (uint32_t)expected || hostPins[p.pin] != (expected & 1))
+  {
+    printf("FAIL %s: pin %u at %" PRIu64 " ms changed %u times, expected %" PRIu64 "\n",
+      test, p.pin, now, hostWrites[p.pin], expected);
+    failures++;
+  }
+}
+
+static void resetPins()
+{
+  for (uint8_t i = 0; i < 64; i++)
+  {
+    hostPins[i] = LOW;
+    hostWrites[i] = 0;
+  }
+}
+
+
+// The sketch itself, with loop() called every millisecond for a minute
+static void testSketch()
+{
+  const Pattern leds[] = { { 8, 100, 400 }, { 9, 350, 350 }, { 22, 500, 1000 } };
+
+  resetPins();
+  hostMillis = 0;
+  setup();
+  for (uint64_t now = 0; now <= 60000; now++)
+  {
+    hostMillis = now;
+    loop();
+    for (uint8_t i = 0; i < 3; i++)
+    {
+      check(leds[i], now, "sketch");
+    }
+  }
+}
+
+
+// Run a set of Flashers, moving the clock on by a random 0 to maxStep ms
+// between passes, until the end time
+static void runPatterns(const Pattern *patterns, uint8_t n, uint32_t maxStep,
+  uint64_t end, const char *test)
+{
+  resetPins();
+  hostMillis = 0;
+  FlasherScheduler schedule;
+  Flasher *flashers[MAX_FLASHERS];
+  for (uint8_t i = 0; i < n; i++)
+  {
+    flashers[i] = new Flasher(patterns[i].pin, patterns[i].on, patterns[i].off);
+    schedule.Add(flashers[i]);
+  }
+
+  uint64_t now = 0;
+  std::chrono::steady_clock::duration busy(0);
+  while (now <= end && failures == 0)
+  {
+    hostMillis = (uint32_t)now;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    schedule.Run();
+    busy += std::chrono::steady_clock::now() - start;
+    for (uint8_t i = 0; i < n; i++)
+    {
+      check(patterns[i], now, test);
+    }
+    now += rand() % (maxStep + 1);
+  }
+
+  double seconds = end / 1000.0;
+  double busyUs = std::chrono::duration<double, std::micro>(busy).count();
+  printf("%s: %lu changes in %.0f s, %.1f/s, %.3f us each on this PC\n", test,
+    schedule.events, seconds, schedule.events / seconds,
+    schedule.events ? busyUs / schedule.events : 0.0);
+
+  for (uint8_t i = 0; i < n; i++)
+  {
+    delete flashers[i];
+  }
+}
+
+
+static void testAdd()
+{
+  FlasherScheduler schedule;
+  Flasher noOn(40, 0, 100);
+  Flasher noOff(41, 100, 0);
+  if (schedule.Add(&noOn) || schedule.Add(&noOff))
+  {
+    printf("FAIL add: a zero on or off time was accepted\n");
+    failures++;
+  }
+
+  Flasher ok(42, 1, 1);
+  for (uint8_t i = 0; i < MAX_FLASHERS; i++)
+  {
+    if (!schedule.Add(&ok))
+    {
+      printf("FAIL add: refused Flasher %u of %u\n", i + 1, MAX_FLASHERS);
+      failures++;
+    }
+  }
+  if (schedule.Add(&ok))
+  {
+    printf("FAIL add: accepted more than MAX_FLASHERS\n");
+    failures++;
+  }
+}
+
+
+int main()
+{
+  srand(1);
+
+  testAdd();
+  testSketch();
+
+  // Late wakeups: the pattern mustn't drift however late each pass is
+  const Pattern busy[] = { { 30, 100, 400 }, { 31, 350, 350 }, { 32, 500, 1000 },
+    { 33, 1, 1 }, { 34, 7, 13 }, { 35, 1, 997 } };
+  runPatterns(busy, 6, 40, 3600000UL, "late wakeups");
+
+  // Past the wrap, 2^32 ms, in big steps with slower patterns
+  const Pattern slow[] = { { 36, 100000, 250000 }, { 37, 333333, 444444 },
+    { 38, 65535, 1 }, { 39, 1, 65535 }, { 40, 1000, 3000 } };
+  runPatterns(slow, 5, 5000, 0x100000000ULL + 600000, "millis() wrap");
+
+  printf(failures ? "FAILED\n" : "PASSED\n");
+  return failures ? 1 : 0;
+}
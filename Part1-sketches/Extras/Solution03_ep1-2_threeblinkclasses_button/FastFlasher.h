@@ -0,0 +1,80 @@
+/*
+  FastFlasher
+
+  A Flasher whose pin and timing are fixed when the sketch is compiled.
+
+  digitalWrite() has to look up which port and bit a pin number belongs
+  to, and turns interrupts off while it changes the port, every time it
+  is called.  When the pin is known at compile time the compiler can do
+  that lookup once, so changing the LED is a single write to the pin's
+  PINx register (writing a 1 to a PINx bit toggles that output).
+
+  Only the Mayfly pins listed below are mapped.  Using any other pin is a
+  compile error - use the ordinary runtime Flasher class for those.
+ */
+
+#ifndef FastFlasher_h
+#define FastFlasher_h
+
+#include <Arduino.h>
+
+// Which port and bit each Mayfly pin lives on (from the Mayfly variant's
+// pins_arduino.h).  Only pins that have a specialization can be used.
+template<uint8_t Pin> struct MayflyPin;
+
+#define MAYFLY_PIN(pin, port, bit) \
+  template<> struct MayflyPin<pin> \
+  { \
+    static volatile uint8_t &Ddr()   { return DDR##port; } \
+    static volatile uint8_t &Port()  { return PORT##port; } \
+    static volatile uint8_t &Input() { return PIN##port; } \
+    static const uint8_t Mask = _BV(bit); \
+  };
+
+MAYFLY_PIN(8,  B, 0)   // green LED
+MAYFLY_PIN(9,  B, 1)   // red LED
+MAYFLY_PIN(21, C, 5)   // user button
+MAYFLY_PIN(22, C, 6)   // switched power
+
+#undef MAYFLY_PIN
+
+
+template<uint8_t Pin, unsigned long OnMs, unsigned long OffMs>
+class FastFlasher
+{
+  typedef MayflyPin<Pin> LedPin;
+
+  // These maintain the current state
+  bool ledOn;                     // true while the LED is on
+  unsigned long previousMillis;   // will store last time LED was updated
+
+  public:
+  FastFlasher()
+  {
+    LedPin::Ddr() |= LedPin::Mask;   // the same as pinMode(Pin, OUTPUT)
+
+    ledOn = false;
+    previousMillis = 0;
+  }
+
+  void Update()
+  {
+    // check to see if it's time to change the state of the LED
+    unsigned long currentMillis = millis();
+
+    if (currentMillis - previousMillis >= (ledOn ? OnMs : OffMs))
+    {
+      ledOn = !ledOn;
+      previousMillis = currentMillis;  // Remember the time
+      Toggle();                        // Update the actual LED
+    }
+  }
+
+  // Flip the LED with one register write
+  static void Toggle()
+  {
+    LedPin::Input() = LedPin::Mask;
+  }
+};
+
+#endif
@@ -1,4 +1,5 @@
 #include <Arduino.h>
+#include "FastFlasher.h"   // Flasher with its pin fixed at compile time
 
 class Flasher
 {
@@ -48,12 +49,57 @@ class Flasher
 };
 
 
-Flasher led1(8, 100, 400);
-Flasher led2(9, 350, 350);
-Flasher led3(22, 500, 1000);
+// The Flasher class above works with any pin chosen while the sketch runs.
+// These LEDs are always on the same pins, so use FastFlasher instead,
+// which toggles them with a single register write.
+FastFlasher<8, 100, 400> led1;
+FastFlasher<9, 350, 350> led2;
+FastFlasher<22, 500, 1000> led3;
+
+
+#ifdef FLASHER_BENCHMARK
+// Count CPU cycles for 100 LED changes each way using Timer1 running at the
+// CPU clock.  Build with -DFLASHER_BENCHMARK and run on the board or simavr.
+const int benchmarkToggles = 100;
+
+void benchmarkFlashers()
+{
+  uint16_t runtimeCycles, fastCycles;
+  int state = LOW;
+
+  TCCR1A = 0;
+  TCCR1B = _BV(CS10);   // no prescaler, one count per CPU cycle
+
+  TCNT1 = 0;
+  for (int i = 0; i < benchmarkToggles; i++)
+  {
+    state = !state;
+    digitalWrite(8, state);
+  }
+  runtimeCycles = TCNT1;
+
+  TCNT1 = 0;
+  for (int i = 0; i < benchmarkToggles; i++)
+  {
+    FastFlasher<8, 100, 400>::Toggle();
+  }
+  fastCycles = TCNT1;
+
+  TCCR1B = 0;
+
+  Serial.print("digitalWrite cycles/toggle: ");
+  Serial.println(runtimeCycles / benchmarkToggles);
+  Serial.print("FastFlasher cycles/toggle:  ");
+  Serial.println(fastCycles / benchmarkToggles);
+}
+#endif
 
 void setup()
 {
+#ifdef FLASHER_BENCHMARK
+  Serial.begin(57600);
+  benchmarkFlashers();
+#endif
 }
 
 void loop()
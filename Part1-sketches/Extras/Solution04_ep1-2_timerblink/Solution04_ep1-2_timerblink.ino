@@ -0,0 +1,183 @@
+/*
+  Blink from the hardware timers
+
+  Blinks the Mayfly's green (pin 8) and red (pin 9) LEDs with TimerBlink,
+  while loop() is kept busy reading a BME280 and printing the results the
+  same way Example_06 does.  The LEDs keep time, because nothing in loop()
+  has to run for them to change.  Neither LED is on a timer's compare
+  output, so both are toggled from Timer3's compare interrupts, and an
+  edge is only as late as the interrupt is.
+
+  Every 10 seconds the sketch prints the worst lateness of an LED edge, in
+  microseconds.  Uncomment SOFTWARE_BLINK below to blink with the Flasher
+  class from Solution02 instead, and compare how late the edges get when
+  loop() is stuck waiting on I2C and Serial.  Both ways are timed with
+  the same 1 us clock from Timer3, TimerBlink::Micros().
+
+  Pin 22 is left switched on here because it powers the BME280, but
+  TimerBlink::Start(22, ...) would blink it from one of Timer1's compare
+  interrupts in the same way.
+ */
+
+#include <Arduino.h>
+#include <Wire.h>
+#include <Adafruit_Sensor.h>
+#include <Adafruit_BME280.h>
+#include "TimerBlink.h"
+
+// #define SOFTWARE_BLINK   // blink in loop() to compare
+
+uint8_t BMEi2c_addr = 0x76;  // Address is 0x77 (Adafruit default) or 0x76 (Grove default)
+const int8_t I2CPower = 22;  // Pin to switch power on and off (-1 if unconnected)
+
+#define SEALEVELPRESSURE_HPA (1013.25)
+
+Adafruit_BME280 bme; // I2C
+
+
+#ifdef SOFTWARE_BLINK
+// The Flasher from Solution02, plus a record of how late each change was.
+// It keeps time with TimerBlink::Micros(), as micros() only counts in
+// steps of 8 us at 8 MHz.
+class Flasher
+{
+  int ledPin;      // the number of the LED pin
+  long OnTime;     // milliseconds of on-time
+  long OffTime;    // milliseconds of off-time
+
+  int ledState;                 // ledState used to set the LED
+  unsigned long previousMicros;   // when the LED was due to change last time
+
+  public:
+  unsigned long maxLateMicros;    // the latest a change has been made
+
+  Flasher(int pin, long on, long off)
+  {
+  ledPin = pin;
+  pinMode(ledPin, OUTPUT);
+
+  OnTime = on;
+  OffTime = off;
+
+  ledState = LOW;
+  previousMicros = 0;
+  maxLateMicros = 0;
+  }
+
+  void Update()
+  {
+    unsigned long currentMicros = TimerBlink::Micros();
+    unsigned long waitMicros = (ledState == HIGH ? OnTime : OffTime) * 1000UL;
+
+    if (currentMicros - previousMicros >= waitMicros)
+    {
+      unsigned long late = currentMicros - previousMicros - waitMicros;
+      if (late > maxLateMicros)
+      {
+        maxLateMicros = late;
+      }
+      ledState = !ledState;
+      previousMicros += waitMicros;   // when it should have changed
+      digitalWrite(ledPin, ledState);
+    }
+  }
+};
+
+Flasher led1(8, 100, 400);
+Flasher led2(9, 350, 350);
+#endif
+
+
+unsigned long reportMillis = 0;
+const unsigned long reportInterval = 10000;   // print statistics every 10 s
+
+void setup()
+{
+    Serial.begin(115200);
+
+    // Turn on switched power
+    pinMode(I2CPower, OUTPUT);
+    digitalWrite(I2CPower, HIGH);
+
+    if (!bme.begin(BMEi2c_addr)) {
+        Serial.println("Could not find a valid BME280 sensor, check wiring!");
+        while (1);
+    }
+
+#ifdef SOFTWARE_BLINK
+    TimerBlink::Begin();   // for the 1 us clock
+#else
+    startBlink(8, 100, 400);
+    startBlink(9, 350, 350);
+#endif
+
+    Serial.println("  Time,  Temp, Humid,   Press,   Alt");
+    Serial.println("    ms,    *C,     %,      Pa,     m");
+}
+
+
+void startBlink(uint8_t pin, unsigned long onMs, unsigned long offMs)
+{
+    switch (TimerBlink::Start(pin, onMs, offMs))
+    {
+    case TimerBlink::Started:
+        return;
+    case TimerBlink::BadTime:
+        Serial.print("Can't blink that fast or slow, pin ");
+        break;
+    case TimerBlink::NoChannel:
+        Serial.print("No timer channel left to blink pin ");
+        break;
+    }
+    Serial.println(pin);
+}
+
+
+void updateLEDs()
+{
+#ifdef SOFTWARE_BLINK
+    led1.Update();
+    led2.Update();
+#endif
+}
+
+
+void loop()
+{
+    // Read the sensor and print as fast as we can, checking the LEDs
+    // between each step like a busy sketch would
+    updateLEDs();
+    Serial.print("  ");
+    Serial.print(millis());
+    Serial.print(", ");
+    Serial.print(bme.readTemperature());
+    updateLEDs();
+    Serial.print(", ");
+    Serial.print(bme.readHumidity());
+    updateLEDs();
+    Serial.print(", ");
+    Serial.print(bme.readPressure());
+    updateLEDs();
+    Serial.print(", ");
+    Serial.print(bme.readAltitude(SEALEVELPRESSURE_HPA));
+    Serial.println();
+
+    if (millis() - reportMillis >= reportInterval)
+    {
+        reportMillis += reportInterval;
+#ifdef SOFTWARE_BLINK
+        Serial.print("Flasher max lateness us, pin 8: ");
+        Serial.print(led1.maxLateMicros);
+        Serial.print("  pin 9: ");
+        Serial.println(led2.maxLateMicros);
+        led1.maxLateMicros = 0;
+        led2.maxLateMicros = 0;
+#else
+        Serial.print("TimerBlink max lateness us, pin 8: ");
+        Serial.print(TimerBlink::MaxLateMicros(8));
+        Serial.print("  pin 9: ");
+        Serial.println(TimerBlink::MaxLateMicros(9));
+        TimerBlink::ClearStats();
+#endif
+    }
+}
@@ -0,0 +1,321 @@
+#include "TimerBlink.h"
+
+// One blinking pin.  Channels 0 and 1 are Timer1's compare registers A and
+// B, channels 2 and 3 are Timer3's.  A pin on Timer1's compare output is
+// changed by the timer itself; any other pin is toggled in the interrupt.
+struct BlinkChannel
+{
+  bool used;
+  uint8_t pin;
+  volatile uint8_t *pinReg;   // PINx register to toggle, NULL for hardware pins
+  uint8_t mask;
+  uint32_t onTicks;
+  uint32_t offTicks;
+  uint32_t remaining;         // ticks from the compare register to the edge
+  bool on;
+  uint16_t maxLate;           // worst lateness of a software edge, in ticks
+};
+
+static BlinkChannel channels[4];
+
+static bool timer1Running = false;
+static bool timer3Running = false;
+static volatile uint16_t timer3Overflows = 0;   // the top half of Micros()
+
+// The longest step the compare register is moved on at once.  Anything
+// up to 0xC000 goes in one step, so the last step of a long time is never
+// shorter than 0x4000 ticks and the interrupt is always well ahead of it.
+#define MAX_STEP 0x8000UL
+
+
+static uint32_t msToTicks(unsigned long ms)
+{
+  return ms * BLINK_TICKS_PER_MS;
+}
+
+static volatile uint16_t &compareRegister(uint8_t c)
+{
+  switch (c)
+  {
+    case 0: return OCR1A;
+    case 1: return OCR1B;
+    case 2: return OCR3A;
+    default: return OCR3B;
+  }
+}
+
+static volatile uint16_t &counterRegister(uint8_t c)
+{
+  return c < 2 ? TCNT1 : TCNT3;
+}
+
+static int8_t findChannel(uint8_t pin)
+{
+  for (uint8_t c = 0; c < 4; c++)
+  {
+    if (channels[c].used && channels[c].pin == pin)
+    {
+      return c;
+    }
+  }
+  return -1;
+}
+
+// Switch a timer from the PWM mode init() leaves it in to counting freely
+// at F_CPU/8.  Once running it is left alone, so the other channel and
+// Micros() keep their time.
+static void startTimer(uint8_t c)
+{
+  if (c < 2)
+  {
+    if (!timer1Running)
+    {
+      TCCR1A &= ~(_BV(WGM11) | _BV(WGM10));
+      TCCR1B = _BV(CS11);
+      timer1Running = true;
+    }
+  }
+  else
+  {
+    if (!timer3Running)
+    {
+      TCCR3A &= ~(_BV(WGM31) | _BV(WGM30));
+      TCCR3B = _BV(CS31);
+      TIFR3 = _BV(TOV3);
+      TIMSK3 |= _BV(TOIE3);
+      timer3Running = true;
+    }
+  }
+}
+
+// What a Timer1 compare output does at the next match: set the pin HIGH
+// or clear it LOW.  A match that isn't an edge yet sets the level the pin
+// already has, so it changes nothing.
+static void setCompareOutput(uint8_t c, bool high)
+{
+  uint8_t com1 = c == 0 ? _BV(COM1A1) : _BV(COM1B1);
+  uint8_t com0 = c == 0 ? _BV(COM1A0) : _BV(COM1B0);
+  TCCR1A = (TCCR1A & ~(com1 | com0)) | com1 | (high ? com0 : 0);
+}
+
+// Move the compare register on towards the next edge, by the whole of the
+// remaining time or one step of it
+static void advance(uint8_t c)
+{
+  BlinkChannel &ch = channels[c];
+
+  uint32_t step = ch.remaining > MAX_STEP + MAX_STEP / 2 ? MAX_STEP : ch.remaining;
+  compareRegister(c) += (uint16_t)step;
+  ch.remaining -= step;
+
+  if (ch.pinReg == NULL)
+  {
+    // At the edge the output goes to the other level, until then it stays
+    setCompareOutput(c, ch.remaining == 0 ? !ch.on : ch.on);
+  }
+}
+
+
+void TimerBlink::Begin()
+{
+  uint8_t oldSREG = SREG;
+  cli();
+  startTimer(2);
+  SREG = oldSREG;
+}
+
+
+TimerBlink::Result TimerBlink::Start(uint8_t pin, unsigned long onMs, unsigned long offMs)
+{
+  if (onMs == 0 || offMs == 0 || onMs > MaxMs || offMs > MaxMs)
+  {
+    return BadTime;
+  }
+
+  Stop(pin);
+
+  // A free compare output for the pin itself, or else the first free
+  // channel to toggle it from, Timer3's before Timer1's
+  int8_t c = -1;
+  uint8_t timer = digitalPinToTimer(pin);
+  if (timer == TIMER1A && !channels[0].used) c = 0;
+  else if (timer == TIMER1B && !channels[1].used) c = 1;
+  else if (!channels[2].used) c = 2;
+  else if (!channels[3].used) c = 3;
+  else if (!channels[0].used) c = 0;
+  else if (!channels[1].used) c = 1;
+  if (c < 0)
+  {
+    return NoChannel;
+  }
+  bool hardware = (c == 0 && timer == TIMER1A) || (c == 1 && timer == TIMER1B);
+
+  pinMode(pin, OUTPUT);
+  digitalWrite(pin, LOW);
+
+  uint8_t oldSREG = SREG;
+  cli();
+
+  startTimer(c);
+
+  BlinkChannel &ch = channels[c];
+  ch.pin = pin;
+  ch.onTicks = msToTicks(onMs);
+  ch.offTicks = msToTicks(offMs);
+  ch.on = false;
+  ch.maxLate = 0;
+  if (hardware)
+  {
+    // Force a match in clear mode, so the output starts LOW even if it
+    // was left HIGH when the pin last stopped blinking
+    ch.pinReg = NULL;
+    setCompareOutput(c, false);
+    TCCR1C = c == 0 ? _BV(FOC1A) : _BV(FOC1B);
+  }
+  else
+  {
+    ch.pinReg = portInputRegister(digitalPinToPort(pin));
+    ch.mask = digitalPinToBitMask(pin);
+  }
+  ch.used = true;
+
+  // The first edge (turning the pin on) comes after one off-time
+  compareRegister(c) = counterRegister(c);
+  ch.remaining = ch.offTicks;
+  advance(c);
+
+  switch (c)
+  {
+    case 0:
+      TIFR1 = _BV(OCF1A);
+      TIMSK1 |= _BV(OCIE1A);
+      break;
+    case 1:
+      TIFR1 = _BV(OCF1B);
+      TIMSK1 |= _BV(OCIE1B);
+      break;
+    case 2:
+      TIFR3 = _BV(OCF3A);
+      TIMSK3 |= _BV(OCIE3A);
+      break;
+    case 3:
+      TIFR3 = _BV(OCF3B);
+      TIMSK3 |= _BV(OCIE3B);
+      break;
+  }
+
+  SREG = oldSREG;
+  return Started;
+}
+
+
+void TimerBlink::Stop(uint8_t pin)
+{
+  int8_t c = findChannel(pin);
+  if (c < 0)
+  {
+    return;
+  }
+
+  uint8_t oldSREG = SREG;
+  cli();
+  switch (c)
+  {
+    case 0:
+      TIMSK1 &= ~_BV(OCIE1A);
+      TCCR1A &= ~(_BV(COM1A1) | _BV(COM1A0));   // hand the pin back to PORTx
+      break;
+    case 1:
+      TIMSK1 &= ~_BV(OCIE1B);
+      TCCR1A &= ~(_BV(COM1B1) | _BV(COM1B0));
+      break;
+    case 2:
+      TIMSK3 &= ~_BV(OCIE3A);
+      break;
+    case 3:
+      TIMSK3 &= ~_BV(OCIE3B);
+      break;
+  }
+  channels[c].used = false;
+  SREG = oldSREG;
+
+  digitalWrite(pin, LOW);
+}
+
+
+unsigned long TimerBlink::MaxLateMicros(uint8_t pin)
+{
+  int8_t c = findChannel(pin);
+  if (c < 0)
+  {
+    return 0;
+  }
+
+  uint8_t oldSREG = SREG;
+  cli();
+  uint16_t late = channels[c].maxLate;
+  SREG = oldSREG;
+
+  return late;   // one tick is 1 us
+}
+
+
+void TimerBlink::ClearStats()
+{
+  uint8_t oldSREG = SREG;
+  cli();
+  for (uint8_t c = 0; c < 4; c++)
+  {
+    channels[c].maxLate = 0;
+  }
+  SREG = oldSREG;
+}
+
+
+unsigned long TimerBlink::Micros()
+{
+  uint8_t oldSREG = SREG;
+  cli();
+  uint16_t high = timer3Overflows;
+  uint16_t low = TCNT3;
+  // An overflow that hasn't been counted yet, because interrupts are off
+  if ((TIFR3 & _BV(TOV3)) && low < 0x8000)
+  {
+    high++;
+  }
+  SREG = oldSREG;
+
+  return (uint32_t)high << 16 | low;
+}
+
+
+// Runs at every compare match.  Part way through a long time it only
+// moves the compare register on; at an edge it toggles a software pin
+// first, and starts on the length of the state just entered.
+static inline void nextEdge(uint8_t c)
+{
+  BlinkChannel &ch = channels[c];
+
+  if (ch.remaining == 0)
+  {
+    if (ch.pinReg)
+    {
+      *ch.pinReg = ch.mask;
+      uint16_t late = counterRegister(c) - compareRegister(c);
+      if (late > ch.maxLate)
+      {
+        ch.maxLate = late;
+      }
+    }
+    ch.on = !ch.on;
+    ch.remaining = ch.on ? ch.onTicks : ch.offTicks;
+  }
+
+  advance(c);
+}
+
+ISR(TIMER1_COMPA_vect) { nextEdge(0); }
+ISR(TIMER1_COMPB_vect) { nextEdge(1); }
+ISR(TIMER3_COMPA_vect) { nextEdge(2); }
+ISR(TIMER3_COMPB_vect) { nextEdge(3); }
+ISR(TIMER3_OVF_vect) { timer3Overflows++; }
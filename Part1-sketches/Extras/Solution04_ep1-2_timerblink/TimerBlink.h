@@ -0,0 +1,72 @@
+/*
+  TimerBlink
+
+  Blinks LEDs from the hardware timers, so loop() doesn't have to do
+  anything to keep them going.
+
+  Timer1 and Timer3 count freely at F_CPU/8, which is 1 us per tick on the
+  8 MHz Mayfly.  Each blinking pin owns one of their four output-compare
+  registers, and the compare interrupt only moves that register on to the
+  next edge.  Times longer than a 16-bit count are covered in several
+  steps, so an on or off time can be over an hour.
+
+  - A pin that is one of Timer1's compare outputs (OC1A or OC1B, PD5 and
+    PD4, as digitalPinToTimer() reports) is changed by the timer hardware
+    itself at the exact compare tick, so the edge stays put however long
+    the interrupt has to wait.
+  - Any other pin, including the Mayfly's LEDs on pins 8 and 9 and the
+    switched power rail on pin 22, is toggled inside the compare
+    interrupt.  Its edges move only by the interrupt latency, a few
+    microseconds.  These use Timer3's two channels first, then whichever
+    of Timer1's are left, so four pins can blink at once.
+
+  Micros() reads Timer3 as a 1 us clock, to time things at a finer step
+  than micros() manages at 8 MHz (8 us).
+
+  Timer1 is also used by the Servo library, so don't use both together.
+ */
+
+#ifndef TimerBlink_h
+#define TimerBlink_h
+
+#include <Arduino.h>
+
+#if F_CPU != 8000000L
+#error "TimerBlink counts 1 us ticks, so needs the 8 MHz Mayfly clock"
+#endif
+
+#define BLINK_PRESCALE 8UL
+#define BLINK_TICKS_PER_MS (F_CPU / BLINK_PRESCALE / 1000)
+
+class TimerBlink
+{
+  public:
+  // The longest on or off time the tick counts can hold
+  static const unsigned long MaxMs = 0xFFFFFFFFUL / BLINK_TICKS_PER_MS;
+
+  enum Result
+  {
+    Started,
+    BadTime,      // zero, or longer than MaxMs
+    NoChannel     // all four compare channels are blinking other pins
+  };
+
+  // Start the timers and the 1 us clock.  Start() does this too.
+  static void Begin();
+
+  // Start blinking a pin, off first
+  static Result Start(uint8_t pin, unsigned long onMs, unsigned long offMs);
+
+  // Stop blinking a pin and leave it LOW
+  static void Stop(uint8_t pin);
+
+  // The most a pin's edge has landed after its scheduled tick since the
+  // last ClearStats(), in microseconds.  Always 0 for the hardware pins.
+  static unsigned long MaxLateMicros(uint8_t pin);
+  static void ClearStats();
+
+  // Microseconds since Begin(), from Timer3
+  static unsigned long Micros();
+};
+
+#endif
@@ -0,0 +1,174 @@
+#include "LightRange.h"
+#include <EEPROM.h>
+
+
+LightRange::LightRange(int eepromAddress)
+  : eepromAddress(eepromAddress), started(false), nextSlot(0), sequence(0)
+{
+}
+
+
+uint8_t LightRange::checkByte(const Slot &slot)
+{
+  // Erased EEPROM (all 0xFF) doesn't pass
+  return 0x5A ^ slot.sequence ^ (slot.minLevel & 0xFF) ^ (slot.minLevel >> 8) ^
+         (slot.maxLevel & 0xFF) ^ (slot.maxLevel >> 8);
+}
+
+
+bool LightRange::begin()
+{
+  // The newest good slot is the one with the highest sequence number,
+  // counting round from 255 to 0
+  bool found = false;
+  Slot newest;
+  for (uint8_t i = 0; i < LIGHT_RANGE_SLOTS; i++)
+  {
+    Slot slot;
+    EEPROM.get(eepromAddress + i * sizeof(Slot), slot);
+    if (slot.check != checkByte(slot) || slot.maxLevel > 1023 ||
+        slot.maxLevel < slot.minLevel + MinSpan)
+    {
+      continue;
+    }
+    if (!found || (int8_t)(slot.sequence - newest.sequence) > 0)
+    {
+      newest = slot;
+      nextSlot = (i + 1) % LIGHT_RANGE_SLOTS;
+      found = true;
+    }
+  }
+
+  lastDecay = millis();
+  lastSave = lastDecay;
+  if (!found)
+  {
+    return false;
+  }
+
+  sequence = newest.sequence;
+  minLevel = newest.minLevel;
+  maxLevel = newest.maxLevel;
+  minEnvelope = (uint32_t)minLevel << 16;
+  maxEnvelope = (uint32_t)maxLevel << 16;
+  savedMin = minLevel;
+  savedMax = maxLevel;
+  setScale();
+  started = true;
+  return true;
+}
+
+
+void LightRange::setScale()
+{
+  // Rounded up, so the brightest level comes out as 255 and not 254.
+  // scale() clamps anything that rounds past it.
+  uint16_t span = maxLevel - minLevel;
+  scaleFactor = ((255UL << 16) + span - 1) / span;
+}
+
+
+uint8_t LightRange::scale(uint16_t level)
+{
+  lastLevel = level;
+
+  if (!started)
+  {
+    // Nothing learned yet: start with MinSpan around the first reading
+    minLevel = level > MinSpan / 2 ? level - MinSpan / 2 : 0;
+    maxLevel = minLevel + MinSpan;
+    minEnvelope = (uint32_t)minLevel << 16;
+    maxEnvelope = (uint32_t)maxLevel << 16;
+    savedMin = 0;
+    savedMax = 0;
+    setScale();
+    started = true;
+  }
+
+  // A new extreme moves its envelope straight away
+  if (level < minLevel)
+  {
+    minLevel = level;
+    minEnvelope = (uint32_t)level << 16;
+    setScale();
+  }
+  else if (level > maxLevel)
+  {
+    maxLevel = level;
+    maxEnvelope = (uint32_t)level << 16;
+    setScale();
+  }
+
+  uint32_t scaled = ((uint32_t)(level - minLevel) * scaleFactor) >> 16;
+  return scaled > 255 ? 255 : scaled;
+}
+
+
+void LightRange::update()
+{
+  if (!started)
+  {
+    return;
+  }
+
+  unsigned long now = millis();
+  if (now - lastDecay >= DecayMs)
+  {
+    lastDecay = now;
+
+    // Move each envelope a little towards the latest reading, as long as
+    // that leaves them MinSpan apart
+    int32_t target = (int32_t)lastLevel << 16;
+    uint32_t newMin = minEnvelope + ((target - (int32_t)minEnvelope) >> DecayShift);
+    uint32_t newMax = maxEnvelope + ((target - (int32_t)maxEnvelope) >> DecayShift);
+    if (newMax >= newMin + ((uint32_t)MinSpan << 16))
+    {
+      minEnvelope = newMin;
+      maxEnvelope = newMax;
+      uint16_t newMinLevel = minEnvelope >> 16;
+      uint16_t newMaxLevel = (maxEnvelope + 0xFFFF) >> 16;   // round up, so it stays a span
+      if (newMinLevel != minLevel || newMaxLevel != maxLevel)
+      {
+        minLevel = newMinLevel;
+        maxLevel = newMaxLevel;
+        setScale();
+      }
+    }
+  }
+
+  if (now - lastSave >= SaveMs)
+  {
+    lastSave = now;
+    if (abs((int)minLevel - (int)savedMin) >= SaveChange ||
+        abs((int)maxLevel - (int)savedMax) >= SaveChange)
+    {
+      save();
+    }
+  }
+}
+
+
+void LightRange::save()
+{
+  Slot slot;
+  slot.sequence = ++sequence;
+  slot.minLevel = minLevel;
+  slot.maxLevel = maxLevel;
+  slot.check = checkByte(slot);
+  EEPROM.put(eepromAddress + nextSlot * sizeof(Slot), slot);
+  nextSlot = (nextSlot + 1) % LIGHT_RANGE_SLOTS;
+  savedMin = minLevel;
+  savedMax = maxLevel;
+}
+
+
+uint16_t LightRange::getMin()
+{
+  return minLevel;
+}
+
+
+uint16_t LightRange::getMax()
+{
+  return maxLevel;
+}
@@ -0,0 +1,91 @@
+/*
+  LightRange
+
+  Learns the darkest and brightest light levels in the room and scales
+  each reading to 0 - 255 between them, like autoRange() did, but without
+  holding on to a single flash of light forever.
+
+  The dark and bright levels are envelopes.  A reading below the dark one
+  (or above the bright one) moves it there at once.  Otherwise every
+  DecayMs each envelope moves 1/2^DecayShift of the way towards the
+  current reading, so an old extreme fades out over a couple of minutes
+  unless it is seen again.  They are never let closer than MinSpan, so a
+  steady light doesn't turn sensor noise into a flickering LED.
+
+  Scaling is (reading - dark) * scale >> 16, with scale = 255 * 65536 /
+  span worked out only when an envelope moves, instead of the divide in
+  every map().
+
+  The levels are saved in EEPROM every SaveMs if they have moved, so
+  after a reset the sketch starts with the room it last saw.  Each save
+  goes in the next of SaveSlots slots with a sequence number, so the
+  writes are spread over all of them; at one save every 10 minutes the
+  EEPROM's 100,000 writes last for decades.
+ */
+
+#ifndef LightRange_h
+#define LightRange_h
+
+#include <Arduino.h>
+
+#define LIGHT_RANGE_SLOTS 16
+
+class LightRange
+{
+  public:
+  static const unsigned long DecayMs = 100;
+  static const uint8_t DecayShift = 11;        // about 3 minutes to fade
+  static const uint16_t MinSpan = 32;          // readings
+  static const unsigned long SaveMs = 600000;  // 10 minutes
+  static const uint16_t SaveChange = 8;        // readings moved before saving
+
+  // Uses LIGHT_RANGE_SLOTS * 6 bytes of EEPROM from eepromAddress
+  LightRange(int eepromAddress);
+
+  // Load the last saved levels.  Returns false if there were none, so
+  // the range starts from the first readings.
+  bool begin();
+
+  // Take a reading (0 - 1023) and return it scaled to 0 - 255
+  uint8_t scale(uint16_t level);
+
+  // Call from loop(): fades the envelopes and saves them now and then
+  void update();
+
+  // The current dark and bright levels
+  uint16_t getMin();
+  uint16_t getMax();
+
+  private:
+  struct Slot
+  {
+    uint8_t sequence;
+    uint16_t minLevel;
+    uint16_t maxLevel;
+    uint8_t check;
+  };
+
+  static uint8_t checkByte(const Slot &slot);
+  void setScale();
+  void save();
+
+  int eepromAddress;
+
+  // Envelopes in 1/65536ths of a reading, so slow fades don't stall
+  uint32_t minEnvelope;
+  uint32_t maxEnvelope;
+  uint16_t minLevel;
+  uint16_t maxLevel;
+  uint32_t scaleFactor;
+  uint16_t lastLevel;
+  bool started;
+
+  unsigned long lastDecay;
+  unsigned long lastSave;
+  uint16_t savedMin;
+  uint16_t savedMax;
+  uint8_t nextSlot;
+  uint8_t sequence;
+};
+
+#endif
@@ -17,6 +17,8 @@
  * Version 2.1 9/2014 BCH
 /*****************************************************************/
 
+#include "LightRange.h"  // Learns the room's light range, and remembers it
+
 // As usual, we'll create constants to name the pins we're using.
 // This will make it easier to follow the code below.
 
@@ -26,54 +28,47 @@ const int ledPin = 9;
 // We'll also set up some global variables for the light level:
 int lightLevel;
 int calibratedlightLevel; // used to store the scaled / calibrated lightLevel
-int maxThreshold = 0;     // used for setting the "max" light level
-int minThreshold = 1023;   // used for setting the "min" light level
+
+// The darkest and brightest levels seen lately. Move your hand / light
+// source / etc so that your light sensor sees a full range of values.
+// Unlike the old autoRange(), one flash of light doesn't spoil the range
+// for good: it fades after a few minutes. The range is kept in EEPROM
+// (from address 0), so the LED is right from the start next time.
+LightRange range(0);
+
+// How often to print the light level.  At 9600 baud a line takes about
+// 10 ms to send, so printing on every pass would hold up the LED.
+const unsigned long printInterval = 100;  // ms
+unsigned long lastPrint = 0;
 
 void setup()
 {
   pinMode(ledPin, OUTPUT);    // Set up the LED pin to be an output.
   Serial.begin(9600);
+  range.begin();              // start from the range saved last time, if there is one
 }
 
 void loop()
 {
   lightLevel = analogRead(sensorPin);  // reads the voltage on the sensorPin
-  Serial.print(lightLevel);
-  //autoRange();  // autoRanges the min / max values you see in your room.
-
-  calibratedlightLevel = map(lightLevel, 0, 1023, 0, 255);  // scale the lightLevel from 0 - 1023 range to 0 - 255 range.
-                                                  // the map() function applies a linear scale / offset.
-                                                  // map(inputValue, fromMin, fromMax, toMin, toMax);
-  Serial.print("\t"); 		  // tab character
-  Serial.print(calibratedlightLevel);   // println prints an CRLF at the end (creates a new line after)
 
+  calibratedlightLevel = range.scale(lightLevel);  // scale the lightLevel to 0 - 255 between the darkest
+                                                   // and brightest levels seen
   analogWrite(ledPin, calibratedlightLevel);    // set the led level based on the input lightLevel.
-}
-/******************************************************************
- * void autoRange()
- * 
- * This function sets a minThreshold and maxThreshold value for the
- * light levels in your setting. Move your hand / light source / etc
- * so that your light sensor sees a full range of values. This will
- * "autoCalibrate" to your range of input values.
-/*****************************************************************/
-
-void autoRange()
-{
-  if (lightLevel < minThreshold)  // minThreshold was initialized to 1023 -- so, if it's less, reset the threshold level.
-    minThreshold = lightLevel;
-
-  if (lightLevel > maxThreshold)  // maxThreshold was initialized to 0 -- so, if it's bigger, reset the threshold level.
-    maxThreshold = lightLevel;
 
-  // Once we have the highest and lowest values, we can stick them
-  // directly into the map() function.
-  // 
-  // This function must run a few times to get a good range of bright and dark values in order to work.
+  range.update();  // lets old extremes fade, and saves the range now and then
 
-  lightLevel = map(lightLevel, minThreshold, maxThreshold, 0, 255);
-  lightLevel = constrain(lightLevel, 0, 255);
+  // Print now and then, and only if the line fits in Serial's buffer, so
+  // print() never has to wait for the port
+  if (millis() - lastPrint >= printInterval && Serial.availableForWrite() >= 24)
+  {
+    lastPrint = millis();
+    Serial.print(lightLevel);
+    Serial.print("\t"); 		  // tab character
+    Serial.print(calibratedlightLevel);
+    Serial.print("\t");
+    Serial.print(range.getMin());
+    Serial.print("-");
+    Serial.println(range.getMax());   // println prints an CRLF at the end (creates a new line after)
+  }
 }
-
-
-
@@ -0,0 +1,53 @@
+/*
+  FixedConvert
+
+  Sensor unit conversions in whole numbers instead of float.
+
+  The AVR has no floating point hardware, so every float multiply or
+  divide is a library call of a few hundred cycles, and the first one
+  used adds a few KB of flash.  These do the same conversions with 32 bit
+  integers, in fixed units (millivolts, hundredths of a degree), rounding
+  to the nearest unit exactly as if the math had been done on paper: the
+  answer is the float version's, rounded, never more than 1 unit off.
+
+  ADC readings come with their number of bits: 10 for analogRead(), more
+  when oversampled (see OversampledADC.h).  Keep counts * refMv * 10
+  under 2^32, which any 16 bit reading with a reference up to 6.5 V is.
+
+  This file only needs <stdint.h>, so the math can be checked on a PC.
+ */
+
+#ifndef FixedConvert_h
+#define FixedConvert_h
+
+#include <stdint.h>
+
+// n / d to the nearest whole number, halves away from zero
+inline int32_t roundedDivide(int32_t n, int32_t d)
+{
+  return (n >= 0 ? n + d / 2 : n - d / 2) / d;
+}
+
+// A reading of an ADC with this many bits, in millivolts.
+// analogRead() * 0.004882814 V is adcMillivolts(reading, 10, 5000).
+inline uint16_t adcMillivolts(uint16_t counts, uint8_t bits, uint16_t refMv)
+{
+  return ((uint32_t)counts * refMv + ((uint32_t)1 << (bits - 1))) >> bits;
+}
+
+// A TMP36 reading in hundredths of a degree C: (volts - 0.5) * 100.
+// Straight from the reading, so extra bits aren't lost to millivolts.
+inline int32_t tmp36CentiDegrees(uint16_t counts, uint8_t bits, uint16_t refMv)
+{
+  uint32_t tenthsOfMv = ((uint32_t)counts * refMv * 10 + ((uint32_t)1 << (bits - 1))) >> bits;
+  return (int32_t)tenthsOfMv - 5000;
+}
+
+// Degrees C to F, both in the same fixed units: "one" is what stands for
+// 1 degree, e.g. 10 for tenths or 100 for hundredths
+inline int32_t fahrenheitFromCelsius(int32_t celsius, int16_t one)
+{
+  return roundedDivide(celsius * 9, 5) + 32 * (int32_t)one;
+}
+
+#endif
@@ -0,0 +1,152 @@
+#include "OversampledADC.h"
+#include <avr/sleep.h>
+
+// The ADC wants a 50 to 200 kHz clock for full 10 bit accuracy
+#define ADC_MAX_CLOCK 200000UL
+
+static uint8_t adcChannel;                // 0 to 7, for A0 to A7
+static uint8_t shift;                     // extra bits
+static uint16_t conversions;              // per result, 4^shift
+static bool sleeping;                     // noise reduction sleep, not free running
+
+// Only the interrupt touches these while running
+static uint32_t sum;
+static uint16_t count;
+
+// Double buffer: the interrupt writes results[(sequence + 1) & 1], then
+// bumps sequence, so results[sequence & 1] is always a finished one
+static volatile uint16_t results[2];
+static volatile uint8_t sequence = 0;
+static volatile uint32_t resultCount = 0;
+static uint8_t lastRead = 0;
+
+
+bool OversampledADC::begin(uint8_t pin, uint8_t extraBits, bool sleep)
+{
+  uint8_t channel = pin >= A0 ? pin - A0 : pin;
+  if (channel > 7 || extraBits > MaxExtraBits)
+  {
+    return false;
+  }
+
+  ADCSRA = 0;
+  adcChannel = channel;
+  shift = extraBits;
+  conversions = 1 << (2 * extraBits);
+  sleeping = sleep;
+  sum = 0;
+  count = 0;
+  results[0] = 0;
+  results[1] = 0;
+  resultCount = 0;
+  lastRead = sequence;
+
+  // The slowest prescaler that still keeps the ADC clock under 200 kHz:
+  // /128 at 16 MHz, /64 at 8 MHz
+  uint8_t prescaler = 7;
+  while (prescaler > 1 && (F_CPU >> (prescaler - 1)) <= ADC_MAX_CLOCK)
+  {
+    prescaler--;
+  }
+
+  ADMUX = _BV(REFS0) | channel;           // AVcc reference, as analogRead() uses
+  DIDR0 |= _BV(channel);                  // the digital input only adds noise
+  ADCSRB = 0;                             // free running, when auto trigger is on
+  if (sleeping)
+  {
+    // Each conversion is started by entering sleep
+    ADCSRA = _BV(ADEN) | _BV(ADIF) | _BV(ADIE) | prescaler;
+  }
+  else
+  {
+    ADCSRA = _BV(ADEN) | _BV(ADIF) | _BV(ADIE) | _BV(ADATE) | _BV(ADSC) | prescaler;
+  }
+  return true;
+}
+
+
+void OversampledADC::end()
+{
+  // As the Arduino core's init() leaves it
+  ADCSRA = 0;
+  ADCSRB = 0;
+  ADCSRA = _BV(ADEN) | _BV(ADPS2) | _BV(ADPS1) | _BV(ADPS0);
+  DIDR0 &= ~_BV(adcChannel);              // so digitalRead() works on the pin again
+}
+
+
+bool OversampledADC::available()
+{
+  return sequence != lastRead;
+}
+
+
+uint16_t OversampledADC::read()
+{
+  // If a result comes in part way through, read the new one instead
+  uint8_t seq;
+  uint16_t value;
+  do
+  {
+    seq = sequence;
+    value = results[seq & 1];
+  }
+  while (seq != sequence);
+  lastRead = seq;
+  return value;
+}
+
+
+uint16_t OversampledADC::waitForResult()
+{
+  uint8_t seq = sequence;
+  if (sleeping)
+  {
+    set_sleep_mode(SLEEP_MODE_ADC);
+  }
+  while (sequence == seq)
+  {
+    if (sleeping)
+    {
+      // Going to sleep starts a conversion, and its interrupt wakes us.
+      // Any other interrupt just means sleeping again.
+      noInterrupts();
+      sleep_enable();
+      interrupts();
+      sleep_cpu();
+      sleep_disable();
+    }
+  }
+  return read();
+}
+
+
+uint32_t OversampledADC::getFullScale()
+{
+  return 1024UL << shift;
+}
+
+
+uint32_t OversampledADC::getResultCount()
+{
+  noInterrupts();
+  uint32_t n = resultCount;
+  interrupts();
+  return n;
+}
+
+
+ISR(ADC_vect)
+{
+  sum += ADC;
+  if (++count < conversions)
+  {
+    return;
+  }
+  uint8_t next = sequence + 1;
+  results[next & 1] = sum >> shift;
+  sequence = next;
+  resultCount++;
+  sum = 0;
+  count = 0;
+}
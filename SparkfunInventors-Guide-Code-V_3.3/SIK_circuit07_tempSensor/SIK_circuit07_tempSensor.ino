@@ -27,16 +27,75 @@ Version 2.0 6/2012 MDG
 ******************************************************************/
 
 
+#include "OversampledADC.h"	// Reads the sensor in the background, with extra bits
+#include "FixedConvert.h"	// Unit conversions without float math
+
 // We'll use analog input 0 to measure the temperature sensor's
 // signal pin.
 
 const int temperaturePin = A0;
 
+// Each extra bit comes from averaging 4 times as many readings.
+// 4 extra bits gives 14 bit results, 37 times a second.
+const uint8_t extraBits = 4;
+const uint8_t adcBits = 10 + extraBits;
+
+// The ADC's reference voltage, in millivolts
+const uint16_t referenceMv = 5000;
+
+// Set to true to put the CPU to sleep during each conversion, for even
+// less noise (see OversampledADC.h)
+const bool adcSleep = false;
+
+
+#ifdef CONVERSION_BENCHMARK
+// Time the float math this sketch used to do against the whole number
+// version, and print the CPU cycles each takes per reading.  Build with
+// -DCONVERSION_BENCHMARK to run it at startup.
+volatile uint16_t benchCounts = 150;	// volatile, so the math can't be done ahead
+volatile float benchFloat;
+volatile long benchLong;
+
+void benchmarkConversions()
+{
+	const int readings = 1000;
+
+	unsigned long start = micros();
+	for (int i = 0; i < readings; i++)
+	{
+		float voltage = benchCounts * 0.004882814;
+		float degreesC = (voltage - 0.5) * 100.0;
+		benchFloat = degreesC * (9.0 / 5.0) + 32.0;
+	}
+	unsigned long floatMicros = micros() - start;
+
+	start = micros();
+	for (int i = 0; i < readings; i++)
+	{
+		long centiC = tmp36CentiDegrees(benchCounts, 10, referenceMv);
+		benchLong = fahrenheitFromCelsius(centiC, 100);
+	}
+	unsigned long fixedMicros = micros() - start;
+
+	Serial.print("Float cycles per reading: ");
+	Serial.println(floatMicros * (F_CPU / 1000000L) / readings);
+	Serial.print("Fixed cycles per reading: ");
+	Serial.println(fixedMicros * (F_CPU / 1000000L) / readings);
+}
+#endif
+
 
 void setup()
 {
 
 	Serial.begin(9600); //Initialize serial port & set baud rate to 9600 bits per second (bps)
+
+	OversampledADC::begin(temperaturePin, extraBits, adcSleep);
+	OversampledADC::waitForResult();	// the first one takes about 27 ms
+
+#ifdef CONVERSION_BENCHMARK
+	benchmarkConversions();
+#endif
 }
 
 
@@ -44,40 +103,69 @@ void loop()
 {
 
 
-	float voltage, degreesC, degreesF; //Declare 3 floating point variables
+	// Whole numbers in small units instead of floats, which the
+	// Arduino has to do slowly in software
+	uint16_t counts, millivolts;
+	long centiC, centiF;	// hundredths of a degree
+
+	counts = getCounts(); //Measure the analog pin
 
-	voltage = getVoltage(temperaturePin); //Measure the voltage at the analog pin
+	millivolts = adcMillivolts(counts, adcBits, referenceMv); // Convert the reading to millivolts
 
-	degreesC = (voltage - 0.5) * 100.0; // Convert the voltage to degrees Celsius
+	centiC = tmp36CentiDegrees(counts, adcBits, referenceMv); // Convert the reading to degrees Celsius
 
-	degreesF = degreesC * (9.0 / 5.0) + 32.0; //Convert degrees Celsius to Fahrenheit
+	centiF = fahrenheitFromCelsius(centiC, 100); //Convert degrees Celsius to Fahrenheit
 	
 	//Now print to the Serial monitor. Remember the baud must be 9600 on your monitor!
 	// These statements will print lines of data like this:
-	// "voltage: 0.73 deg C: 22.75 deg F: 72.96"
+	// "voltage: 0.728 deg C: 22.75 deg F: 72.96"
 	
 	Serial.print("voltage: ");
-	Serial.print(voltage);
+	printFixed(millivolts, 1000);
 	Serial.print("  deg C: ");
-	Serial.print(degreesC);
+	printFixed(centiC, 100);
 	Serial.print("  deg F: ");
-	Serial.println(degreesF);
+	printFixed(centiF, 100);
+	Serial.println();
 
 	delay(1000); // repeat once per second (change as you wish!)
 }
 
 
-float getVoltage(int pin) 	//Function to read and return
-							//floating-point value (true voltage)
-							//on analog pin 
+uint16_t getCounts() 	//Function to read and return
+						//the reading (0 to 16383 for 14 bits)
+						//on the temperature pin
 {
+	// The ADC has been measuring all along, so the latest result is
+	// already waiting.  With sleep on, it measures now instead, and as
+	// Serial stops while the CPU sleeps, whatever is still being sent
+	// has to go first.
+	if (adcSleep)
+	{
+		Serial.flush();
+	}
+	return adcSleep ? OversampledADC::waitForResult() : OversampledADC::read();
+}
+
 
-	return (analogRead(pin) * 0.004882814);	
-	// This equation converts the 0 to 1023 value that analogRead()
-	// returns, into a 0.0 to 5.0 value that is the true voltage
-	// being read at that pin.
+void printFixed(long value, unsigned int one)	//Print a number in small units,
+												//e.g. 2275 hundredths as 22.75
+{
+	if (value < 0)
+	{
+		Serial.print('-');
+		value = -value;
+	}
+	Serial.print(value / one);
+	Serial.print('.');
+	unsigned int fraction = value % one;
+	for (unsigned int digit = one / 10; digit > 0; digit /= 10)
+	{
+		Serial.print((fraction / digit) % 10);
+	}
 }
 
+
 // Other things to try with this code:
 
 //   Turn on an LED if the temperature is above or below a value.
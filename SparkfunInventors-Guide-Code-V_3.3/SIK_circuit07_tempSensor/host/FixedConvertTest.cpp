@@ -0,0 +1,97 @@
+/*
+  FixedConvertTest
+
+  Checks FixedConvert.h against floating point, for every reading of a
+  10 to 16 bit ADC with 1.1 V, 3.3 V, 5 V and 6.5 V references:
+
+  - each result is the exact answer rounded to the nearest unit, worked
+    out in double, which holds all of these exactly
+  - and within 1 unit of the float math the sketches used to do,
+    analogRead() * 0.004882814 and t * 9.0 / 5.0 + 32
+
+  Build and run from this folder:
+    g++ -std=c++11 -Wall -I.. -o FixedConvertTest FixedConvertTest.cpp && ./FixedConvertTest
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include "FixedConvert.h"
+
+static int failures = 0;
+
+static void check(bool ok, const char *what, uint8_t bits, uint16_t refMv, int32_t value, int32_t got)
+{
+  if (!ok && failures++ < 20)
+  {
+    printf("FAIL %s: %u bits, %u mV ref, %ld gave %ld\n", what, bits, refMv, (long)value, (long)got);
+  }
+}
+
+// Halves round up, as adding half a unit before shifting does
+static int32_t nearest(double x)
+{
+  return (int32_t)floor(x + 0.5);
+}
+
+
+static void testReadings(uint8_t bits, uint16_t refMv)
+{
+  for (uint32_t counts = 0; counts < (1UL << bits); counts++)
+  {
+    double volts = (double)counts * refMv / 1000 / (1UL << bits);
+
+    uint16_t mv = adcMillivolts(counts, bits, refMv);
+    check(mv == nearest(volts * 1000), "millivolts", bits, refMv, counts, mv);
+
+    int32_t centiC = tmp36CentiDegrees(counts, bits, refMv);
+    check(centiC == nearest(volts * 10000) - 5000, "TMP36", bits, refMv, counts, centiC);
+
+    // What the sketch did before, in float, for a 10 bit read at 5 V
+    if (bits == 10 && refMv == 5000)
+    {
+      float voltage = counts * 0.004882814f;
+      float degreesC = (voltage - 0.5f) * 100.0f;
+      check(fabs(mv - voltage * 1000) <= 1, "millivolts vs float", bits, refMv, counts, mv);
+      check(fabs(centiC - degreesC * 100) <= 1, "TMP36 vs float", bits, refMv, counts, centiC);
+    }
+  }
+}
+
+
+static void testFahrenheit()
+{
+  // Every hundredth of a degree from -55 C to 150 C, the TMP36's range
+  // and then some, and every tenth over the DHT22's -40 C to 80 C
+  for (int32_t c = -5500; c <= 15000; c++)
+  {
+    int32_t f = fahrenheitFromCelsius(c, 100);
+    double exact = c * 9.0 / 5.0 + 3200;
+    // Never a half, as 9c / 5 is a whole number of fifths
+    check(f == (int32_t)lround(exact), "F from hundredths", 0, 0, c, f);
+    float degreesF = (c / 100.0f) * 9.0f / 5.0f + 32;
+    check(fabs(f - degreesF * 100) <= 1, "F vs float", 0, 0, c, f);
+  }
+  for (int32_t c = -400; c <= 800; c++)
+  {
+    int32_t f = fahrenheitFromCelsius(c, 10);
+    check(f == (int32_t)lround(c * 9.0 / 5.0 + 320), "F from tenths", 0, 0, c, f);
+  }
+  check(fahrenheitFromCelsius(0, 1) == 32 && fahrenheitFromCelsius(100, 1) == 212 &&
+    fahrenheitFromCelsius(-40, 1) == -40, "0, 100 and -40 C", 0, 0, 0, 0);
+}
+
+
+int main()
+{
+  static const uint16_t refs[] = { 1100, 3300, 5000, 6500 };
+  for (uint8_t bits = 10; bits <= 16; bits++)
+  {
+    for (uint8_t r = 0; r < 4; r++)
+    {
+      testReadings(bits, refs[r]);
+    }
+  }
+  testFahrenheit();
+  printf(failures ? "FAILED\n" : "PASSED\n");
+  return failures ? 1 : 0;
+}
@@ -25,16 +25,47 @@ Version 2.0 6/2012 MDG
 */
 
 
-#include <Servo.h>  // servo library
+#include "ServoPlanner.h"  // moves servos smoothly, in the background
 
 
-Servo servo1;  // servo control object
+int servo1;  // servo number, from ServoPlanner::attach()
+
+// The moves to make, one after another: the angle, how fast (degrees
+// per second), and how long to wait once there (ms).  A servo like the
+// one in the kit turns about 600 degrees per second flat out.
+struct Step
+{
+  int angle;
+  int speed;
+  unsigned long pause;
+};
+
+const Step steps[] =
+{
+  // Change position at full speed:
+  {  90, 600, 1000 },   // Tell servo to go to 90 degrees
+  { 180, 600, 1000 },   // Tell servo to go to 180 degrees
+  {   0, 600, 1000 },   // Tell servo to go to 0 degrees
+
+  // Sweep to 180 degrees at 100 degrees per second (the old loop's
+  // two degrees every 20 ms), then back at half that speed
+  { 180, 100, 0 },
+  {   0,  50, 0 },
+};
+const int stepCount = sizeof(steps) / sizeof(steps[0]);
+
+// How quickly to speed up and slow down, in degrees per second per second
+const int acceleration = 2000;
+
+int step = -1;               // the step in progress
+unsigned long arrived = 0;   // when the servo got there
+bool waiting = true;
 
 
 void setup()
 {
 
-  servo1.attach(9, 900, 2100);  //Connect the servo to pin 9
+  servo1 = ServoPlanner::attach(9, 900, 2100);  //Connect the servo to pin 9
 								//with a minimum pulse width of
 								//900 and a maximum pulse width of
 								//2100. 
@@ -44,41 +75,26 @@ void setup()
 
 void loop()
 {
-  int position;
-  
   // To control a servo, you give it the angle you'd like it
   // to turn to. Servos cannot turn a full 360 degrees, but you
   // can tell it to move anywhere between 0 and 180 degrees.
 
-  // Change position at full speed:
-
-  servo1.write(90);    // Tell servo to go to 90 degrees
-
-  delay(1000);         // Pause to get it time to move
-
-  servo1.write(180);   // Tell servo to go to 180 degrees
-
-  delay(1000);         // Pause to get it time to move
-
-  servo1.write(0);     // Tell servo to go to 0 degrees
+  // moveTo() starts a move and returns straight away: the servo gets
+  // there by itself, speeding up and slowing down smoothly.  So loop()
+  // only has to notice when a move has finished and start the next.
 
-  delay(1000);         // Pause to get it time to move
-  
- 
-	// Tell servo to go to 180 degrees, stepping by two degrees each step
- 
-  for(position = 0; position < 180; position += 2)
+  if (!waiting && !ServoPlanner::moving(servo1))
   {
-    servo1.write(position);  // Move to next position
-    delay(20);               // Short pause to allow it to move
+    arrived = millis();
+    waiting = true;
   }
 
-  // Tell servo to go to 0 degrees, stepping by one degree each step
-
-  for(position = 180; position >= 0; position -= 1)
-  {                                
-    servo1.write(position);  // Move to next position
-    delay(20);               // Short pause to allow it to move
+  if (waiting && (step < 0 || millis() - arrived >= steps[step].pause))
+  {
+    step = (step + 1) % stepCount;
+    ServoPlanner::moveTo(servo1, steps[step].angle, steps[step].speed, acceleration);
+    waiting = false;
   }
-}
 
+  // Anything else can happen here, even moving more servos at once
+}
@@ -0,0 +1,171 @@
+#include "ServoPlanner.h"
+#include "ServoProfile.h"
+
+// Timer1 counts at F_CPU / 8: 2 ticks per us at 16 MHz, 1 at 8 MHz
+#define FRAME_TICKS (F_CPU / 400)          // 20 ms
+#define TICKS(pos) (((uint32_t)(pos) * (F_CPU / 1000000L)) >> 11)   // from 1/256 us
+
+struct ServoState
+{
+  volatile uint8_t *port;
+  uint8_t mask;
+  uint16_t minUs;
+  uint16_t maxUs;
+  ServoProfile profile;
+  uint16_t frame;          // frames into the move
+  int32_t position;        // 1/256 us
+  uint16_t ticks;          // the next pulse
+  bool moving;
+};
+
+static ServoState servos[SERVO_PLANNER_MAX];
+static volatile uint8_t servoCount = 0;
+static volatile int8_t channel = -1;   // the pulse being sent, -1 between frames
+
+
+// Degrees to a pulse width in 1/256 us
+static int32_t toPosition(const ServoState &s, uint8_t degrees)
+{
+  if (degrees > 180)
+  {
+    degrees = 180;
+  }
+  return ((int32_t)s.minUs << 8) + (((int32_t)degrees * (s.maxUs - s.minUs)) << 8) / 180;
+}
+
+
+int8_t ServoPlanner::attach(uint8_t pin, uint16_t minUs, uint16_t maxUs)
+{
+  if (servoCount >= SERVO_PLANNER_MAX)
+  {
+    return -1;
+  }
+
+  uint8_t n = servoCount;
+  ServoState &s = servos[n];
+  s.port = portOutputRegister(digitalPinToPort(pin));
+  s.mask = digitalPinToBitMask(pin);
+  s.minUs = minUs;
+  s.maxUs = maxUs;
+  s.moving = false;
+  s.position = toPosition(s, 90);
+  s.ticks = TICKS(s.position);
+  digitalWrite(pin, LOW);
+  pinMode(pin, OUTPUT);
+
+  if (n == 0)
+  {
+    // Normal counting, prescaler 8, compare A starts and ends each pulse
+    TCCR1A = 0;
+    TCCR1B = _BV(CS11);
+    TCNT1 = 0;
+    OCR1A = FRAME_TICKS;
+    TIFR1 = _BV(OCF1A);
+    TIMSK1 |= _BV(OCIE1A);
+  }
+  servoCount = n + 1;
+  return n;
+}
+
+
+void ServoPlanner::write(uint8_t servo, uint8_t degrees)
+{
+  ServoState &s = servos[servo];
+  int32_t position = toPosition(s, degrees);
+  noInterrupts();
+  s.moving = false;
+  s.position = position;
+  s.ticks = TICKS(position);
+  interrupts();
+}
+
+
+void ServoPlanner::moveTo(uint8_t servo, uint8_t degrees, uint16_t degPerSec, uint16_t degPerSec2)
+{
+  ServoState &s = servos[servo];
+  uint32_t span = s.maxUs - s.minUs;
+
+  // Per 20 ms frame, in 1/256 us: degrees/s * span/180 * 256/50 and
+  // degrees/s^2 * span/180 * 256/2500
+  uint32_t speed = (uint32_t)degPerSec * span * 32 / 1125;
+  uint32_t accel = (uint32_t)degPerSec2 * span * 32 / 56250;
+
+  // Stop the old move first, so the interrupt doesn't move the servo on
+  // from where the new move starts while it is being planned
+  noInterrupts();
+  s.moving = false;
+  int32_t from = s.position;
+  interrupts();
+
+  // Plan outside the interrupt, then swap the plan in
+  ServoProfile profile;
+  servoPlan(profile, from, toPosition(s, degrees), speed, accel);
+
+  noInterrupts();
+  s.profile = profile;
+  s.frame = 0;
+  s.moving = true;
+  interrupts();
+}
+
+
+bool ServoPlanner::moving(uint8_t servo)
+{
+  noInterrupts();
+  bool m = servos[servo].moving;
+  interrupts();
+  return m;
+}
+
+
+uint8_t ServoPlanner::read(uint8_t servo)
+{
+  ServoState &s = servos[servo];
+  noInterrupts();
+  int32_t position = s.position;
+  interrupts();
+  int32_t span = s.maxUs - s.minUs;
+  return ((position - ((int32_t)s.minUs << 8)) * 180 + (span << 7)) / (span << 8);
+}
+
+
+// Each compare match ends one servo's pulse and starts the next one's.
+// After the last, it waits for the end of the 20 ms frame.
+ISR(TIMER1_COMPA_vect)
+{
+  if (channel < 0)
+  {
+    TCNT1 = 0;   // a new frame
+  }
+  else
+  {
+    ServoState &s = servos[channel];
+    *s.port &= ~s.mask;
+
+    // Where this servo should be for its next pulse
+    if (s.moving)
+    {
+      s.frame++;
+      s.position = servoPosition(s.profile, s.frame);
+      s.ticks = TICKS(s.position);
+      if (s.frame >= servoFrames(s.profile))
+      {
+        s.moving = false;
+      }
+    }
+  }
+
+  channel++;
+  if (channel < (int8_t)servoCount)
+  {
+    ServoState &s = servos[channel];
+    OCR1A = TCNT1 + s.ticks;
+    *s.port |= s.mask;
+  }
+  else
+  {
+    uint16_t now = TCNT1;
+    OCR1A = (uint32_t)now + 4 < FRAME_TICKS ? FRAME_TICKS : now + 4;
+    channel = -1;
+  }
+}
@@ -0,0 +1,51 @@
+/*
+  ServoPlanner
+
+  Drives up to 8 servos from Timer1, like the Servo library, and moves
+  them smoothly to a new angle by themselves.
+
+  moveTo() takes a target angle, a top speed and an acceleration, plans a
+  trapezoidal move (ServoProfile.h) and returns at once.  The timer
+  interrupt sends each servo's pulse in turn, every 20 ms, and as each
+  pulse ends it works out that servo's next pulse width from its move.
+  So any number of servos can be moving at once, and loop() is free for
+  other work; moving() says when a move has finished.
+
+  Timer1 is used for the pulses, so this can't be used together with the
+  Servo library, and analogWrite() won't work on pins 9 and 10.
+ */
+
+#ifndef ServoPlanner_h
+#define ServoPlanner_h
+
+#include <Arduino.h>
+
+#define SERVO_PLANNER_MAX 8
+
+class ServoPlanner
+{
+  public:
+  // Start driving a servo, at 90 degrees, with the pulse widths for 0
+  // and 180 degrees.  Returns its number for the calls below, or -1 if
+  // there are already SERVO_PLANNER_MAX.
+  static int8_t attach(uint8_t pin, uint16_t minUs = 544, uint16_t maxUs = 2400);
+
+  // Go straight to an angle, as fast as the servo can
+  static void write(uint8_t servo, uint8_t degrees);
+
+  // Move to an angle, no faster than degPerSec, speeding up and slowing
+  // down at degPerSec2.  Replaces any move in progress, starting from
+  // wherever the servo has got to.  Every move starts from standing
+  // still, so a new target part way through a move stops the servo dead
+  // before it speeds up again: wait for moving() to be false first for
+  // smooth motion.
+  static void moveTo(uint8_t servo, uint8_t degrees, uint16_t degPerSec, uint16_t degPerSec2);
+
+  // True until the servo reaches the angle from moveTo()
+  static bool moving(uint8_t servo);
+
+  // Where the servo is now, in degrees
+  static uint8_t read(uint8_t servo);
+};
+
+#endif
@@ -0,0 +1,154 @@
+/*
+  ServoProfile
+
+  A trapezoidal move: speed up at a steady rate, cruise, slow down at
+  the same rate, and stop exactly on the target.  If the move is too
+  short to reach full speed there is no cruise, and it is a triangle.
+
+  Everything is counted in servo frames (one pulse per servo, 20 ms), and
+  positions are pulse widths in 1/256 us, so the shape is kept even when
+  the servo moves less than a microsecond per frame:
+
+    speeding up  frames 0 to ta          p = a t^2 / 2
+    cruising     frames ta to ta + tc    p = a ta^2 / 2 + a ta (t - ta)
+    slowing      frames ta + tc to end   p = distance - a (end - t)^2 / 2
+
+  ta and tc are whole numbers of frames, picked as short as the speed and
+  acceleration limits allow.  Then a is worked out (to 1/256) so the
+  three parts add up to the distance exactly: it comes out at or a bit
+  under the limit, and the cruise is at exactly the speed reached, with
+  no step in between.
+
+  servoPlan() does the planning, with a square root, when a move starts.
+  servoPosition() is then a few multiplies per frame, cheap enough for an
+  interrupt.  This file only needs <stdint.h>, so the math can be checked
+  on a PC.
+ */
+
+#ifndef ServoProfile_h
+#define ServoProfile_h
+
+#include <stdint.h>
+
+struct ServoProfile
+{
+  int32_t start;          // 1/256 us
+  int32_t distance;       // 1/256 us, negative to move down
+  uint32_t accel;         // 1/65536 us per frame per frame
+  uint16_t accelFrames;   // also the frames spent slowing down
+  uint16_t cruiseFrames;
+};
+
+inline uint16_t servoIsqrt(uint32_t n)
+{
+  uint32_t root = 0;
+  uint32_t bit = (uint32_t)1 << 30;
+  while (bit > n)
+  {
+    bit >>= 2;
+  }
+  while (bit != 0)
+  {
+    if (n >= root + bit)
+    {
+      n -= root + bit;
+      root = (root >> 1) + bit;
+    }
+    else
+    {
+      root >>= 1;
+    }
+    bit >>= 2;
+  }
+  return root;
+}
+
+// Plan a move from one position to another (1/256 us), with a top speed
+// (1/256 us per frame) and an acceleration (1/256 us per frame per frame)
+inline void servoPlan(ServoProfile &p, int32_t from, int32_t to, uint32_t maxSpeed, uint32_t accel)
+{
+  uint32_t distance = to >= from ? to - from : from - to;
+  // Any slower and a long move would need more frames than can be counted
+  if (maxSpeed < 16)
+  {
+    maxSpeed = 16;
+  }
+  if (accel == 0)
+  {
+    accel = 1;
+  }
+
+  p.start = from;
+  p.distance = to - from;
+  if (distance == 0)
+  {
+    p.accel = 0;
+    p.accelFrames = 0;
+    p.cruiseFrames = 0;
+    return;
+  }
+
+  // Speed up for as long as the speed limit allows, or until half way
+  uint32_t frames = (maxSpeed + accel - 1) / accel;
+  uint32_t half = servoIsqrt(distance / accel);
+  if (half * half * accel < distance)
+  {
+    half++;
+  }
+  if (half < frames)
+  {
+    frames = half;
+  }
+
+  // Then cruise long enough that neither limit is broken:
+  // a = distance / (ta * (ta + tc)) <= accel, and a * ta <= maxSpeed
+  uint32_t total = (distance + maxSpeed - 1) / maxSpeed;
+  uint32_t byAccel = (distance + accel * frames - 1) / (accel * frames);
+  if (byAccel > total)
+  {
+    total = byAccel;
+  }
+  if (total < frames)
+  {
+    total = frames;
+  }
+
+  p.accelFrames = frames;
+  p.cruiseFrames = total - frames;
+  p.accel = (distance << 8) / (frames * total);
+}
+
+// How many frames the move takes
+inline uint16_t servoFrames(const ServoProfile &p)
+{
+  return 2 * p.accelFrames + p.cruiseFrames;
+}
+
+// Where the move is after this many frames (1/256 us)
+inline int32_t servoPosition(const ServoProfile &p, uint16_t frame)
+{
+  uint32_t along;
+  uint16_t end = servoFrames(p);
+  uint32_t distance = p.distance >= 0 ? p.distance : -p.distance;
+  if (frame >= end)
+  {
+    along = distance;
+  }
+  else if (frame <= p.accelFrames)
+  {
+    along = (p.accel * frame * frame / 2) >> 8;
+  }
+  else if (frame <= p.accelFrames + p.cruiseFrames)
+  {
+    uint32_t t = frame - p.accelFrames;
+    along = (p.accel * p.accelFrames * (p.accelFrames + 2 * t) / 2) >> 8;
+  }
+  else
+  {
+    uint32_t left = end - frame;
+    along = distance - ((p.accel * left * left / 2) >> 8);
+  }
+  return p.distance >= 0 ? p.start + (int32_t)along : p.start - (int32_t)along;
+}
+
+#endif
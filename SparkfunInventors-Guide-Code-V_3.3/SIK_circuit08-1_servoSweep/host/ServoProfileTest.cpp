@@ -0,0 +1,116 @@
+/*
+  ServoProfileTest
+
+  Plans a couple of hundred thousand random moves with ServoProfile.h and
+  steps each one frame by frame, the way the timer interrupt does.  Every
+  move has to start and stop exactly on its end points, never go
+  backwards, keep to its speed and acceleration limits (give or take the
+  rounding of the acceleration to 1/256), and take about as long as an
+  ideal trapezoid with the same limits.
+
+  Build and run from this folder:
+    g++ -std=c++11 -Wall -I.. -o ServoProfileTest ServoProfileTest.cpp && ./ServoProfileTest
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "ServoProfile.h"
+
+static int failures = 0;
+
+static void fail(const char *what, int32_t from, int32_t to, uint32_t speed, uint32_t accel)
+{
+  if (failures < 10)
+  {
+    printf("FAIL %s: from %d to %d, speed %u, accel %u\n", what, from, to, speed, accel);
+  }
+  failures++;
+}
+
+static void checkMove(int32_t from, int32_t to, uint32_t speed, uint32_t accel)
+{
+  ServoProfile p;
+  servoPlan(p, from, to, speed, accel);
+  uint16_t frames = servoFrames(p);
+
+  if (servoPosition(p, 0) != from || servoPosition(p, frames) != to)
+  {
+    fail("end points", from, to, speed, accel);
+    return;
+  }
+
+  // The limits servoPlan() works to
+  uint32_t maxSpeed = speed < 16 ? 16 : speed;
+  uint32_t maxAccel = accel < maxSpeed ? accel : maxSpeed;
+  uint32_t distance = labs((long)to - from);
+  // a is rounded to 1/256, which over ta * (ta + tc) frames can add up,
+  // and each position is rounded down, which can put a step out by 1 and
+  // a change of step by 2 either side of the peak speed
+  int32_t slack = (int32_t)p.accelFrames * (p.accelFrames + p.cruiseFrames) / 256 + 4;
+
+  int32_t previous = from;
+  int32_t lastStep = 0;
+  for (uint32_t f = 1; f <= (uint32_t)frames + 1; f++)
+  {
+    int32_t position = servoPosition(p, f);
+    int32_t step = position - previous;
+    if ((to >= from && step < 0) || (to < from && step > 0))
+    {
+      fail("went backwards", from, to, speed, accel);
+      return;
+    }
+    if ((uint32_t)labs(step) > maxSpeed + slack)
+    {
+      fail("too fast", from, to, speed, accel);
+      return;
+    }
+    if (distance > maxAccel && (uint32_t)labs(step - lastStep) > maxAccel + slack)
+    {
+      fail("accelerated too hard", from, to, speed, accel);
+      return;
+    }
+    previous = position;
+    lastStep = step;
+  }
+
+  // An ideal trapezoid, or a triangle if it never reaches full speed
+  double ideal = (double)distance / maxSpeed + (double)maxSpeed / maxAccel;
+  if (distance < (double)maxSpeed * maxSpeed / maxAccel)
+  {
+    ideal = 2 * sqrt((double)distance / maxAccel);
+  }
+  if (distance > 4 * maxAccel && (frames > ideal * 1.1 + 3 || frames < ideal * 0.9 - 3))
+  {
+    fail("took the wrong time", from, to, speed, accel);
+  }
+}
+
+
+int main()
+{
+  srand(1);
+  for (long i = 0; i < 200000; i++)
+  {
+    // Anywhere in a 544 to 2400 us servo's range, in 1/256 us
+    int32_t from = (544 + rand() % 1857) * 256;
+    int32_t to = (544 + rand() % 1857) * 256;
+    if (i % 7 == 0)
+    {
+      to = from + rand() % 5 - 2;   // tiny moves, and none at all
+    }
+    checkMove(from, to, 1 + rand() % 20000, 1 + rand() % 3000);
+  }
+
+  // The sketch's sweep from 0 to 180 degrees at 100 degrees/s and 2000
+  // degrees/s^2, converted the way moveTo() does: 1.8 s at full speed,
+  // plus 0.05 s lost speeding up and slowing down, and a little more for
+  // whole frames
+  uint32_t span = 2400 - 544;
+  ServoProfile p;
+  servoPlan(p, 544 * 256, 2400 * 256, 100UL * span * 32 / 1125, 2000UL * span * 32 / 56250);
+  printf("0 to 180 degrees takes %u frames (%.2f s)\n", servoFrames(p), servoFrames(p) * 0.02);
+
+  printf(failures ? "FAILED\n" : "PASSED\n");
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,101 @@
+#include "FilteredADC.h"
+#include "StreamFilter.h"
+
+// The ADC wants a 50 to 200 kHz clock for full 10 bit accuracy
+#define ADC_MAX_CLOCK 200000UL
+
+// Only the interrupt touches this while running
+static StreamFilter filter;
+
+// Double buffer: the interrupt writes samples[(sequence + 1) & 1], then
+// bumps sequence, so samples[sequence & 1] is always a finished one
+static volatile FilteredADC::Sample samples[2];
+static volatile uint8_t sequence = 0;
+static volatile uint32_t sampleCount = 0;
+static uint8_t lastRead = 0;
+static uint8_t adcChannel;                // 0 to 7, for A0 to A7
+
+
+bool FilteredADC::begin(uint8_t pin, uint8_t smoothShift)
+{
+  uint8_t channel = pin >= A0 ? pin - A0 : pin;
+  if (channel > 7)
+  {
+    return false;
+  }
+  adcChannel = channel;
+
+  ADCSRA = 0;
+  streamFilterReset(filter, smoothShift);
+  sampleCount = 0;
+  lastRead = sequence;
+
+  // The slowest prescaler that still keeps the ADC clock under 200 kHz:
+  // /128 at 16 MHz, /64 at 8 MHz
+  uint8_t prescaler = 7;
+  while (prescaler > 1 && (F_CPU >> (prescaler - 1)) <= ADC_MAX_CLOCK)
+  {
+    prescaler--;
+  }
+
+  ADMUX = _BV(REFS0) | channel;           // AVcc reference, as analogRead() uses
+  DIDR0 |= _BV(channel);                  // the digital input only adds noise
+  ADCSRB = _BV(ADTS2);                    // start a conversion as Timer0 overflows
+  ADCSRA = _BV(ADEN) | _BV(ADIF) | _BV(ADIE) | _BV(ADATE) | prescaler;
+  return true;
+}
+
+
+void FilteredADC::end()
+{
+  // As the Arduino core's init() leaves it
+  ADCSRA = 0;
+  ADCSRB = 0;
+  ADCSRA = _BV(ADEN) | _BV(ADPS2) | _BV(ADPS1) | _BV(ADPS0);
+  DIDR0 &= ~_BV(adcChannel);              // so digitalRead() works on the pin again
+}
+
+
+bool FilteredADC::available()
+{
+  return sequence != lastRead;
+}
+
+
+void FilteredADC::read(Sample &sample)
+{
+  // If a reading comes in part way through, read the new one instead
+  uint8_t seq;
+  do
+  {
+    seq = sequence;
+    const volatile Sample &latest = samples[seq & 1];
+    sample.raw = latest.raw;
+    sample.filtered = latest.filtered;
+    sample.micros = latest.micros;
+  }
+  while (seq != sequence);
+  lastRead = seq;
+}
+
+
+uint32_t FilteredADC::getSampleCount()
+{
+  noInterrupts();
+  uint32_t n = sampleCount;
+  interrupts();
+  return n;
+}
+
+
+ISR(ADC_vect)
+{
+  uint16_t raw = ADC;
+  uint8_t next = sequence + 1;
+  volatile FilteredADC::Sample &sample = samples[next & 1];
+  sample.micros = micros();
+  sample.raw = raw;
+  sample.filtered = streamFilterAdd(filter, raw);
+  sequence = next;
+  sampleCount++;
+}
@@ -0,0 +1,56 @@
+/*
+  FilteredADC
+
+  Reads one analog pin on a steady clock in the background, and filters
+  each reading as it comes in (StreamFilter.h), so loop() only ever has
+  to pick up the latest clean value.
+
+  The conversions are started by the hardware, not by code: the ADC's
+  auto trigger is set to Timer0 overflowing, the same tick millis()
+  counts.  That's every 1.024 ms at 16 MHz (2.048 ms at 8 MHz), evenly
+  spaced however busy loop() is, and without taking over a timer.  The
+  ADC-complete interrupt notes micros(), filters the reading and hands it
+  over.
+
+  Results are double buffered like OversampledADC's: the interrupt fills
+  one slot while read() takes the other, so loop() never waits for the
+  ADC and never turns interrupts off.  Each comes with the micros() it
+  was measured at, so the time until something is done with it can be
+  measured.
+
+  While this runs, analogRead() can't be used on any pin.
+ */
+
+#ifndef FilteredADC_h
+#define FilteredADC_h
+
+#include <Arduino.h>
+
+class FilteredADC
+{
+  public:
+  struct Sample
+  {
+    uint16_t raw;             // the reading, 0 - 1023
+    uint16_t filtered;        // after the filter, in 1/16ths of a count
+    unsigned long micros;     // when it was measured
+  };
+
+  // Start reading an analog pin (A0 to A7), with a low pass of
+  // 1/2^smoothShift.  Returns false if the pin won't do.
+  static bool begin(uint8_t pin, uint8_t smoothShift = 2);
+
+  // Stop, and give the ADC back to analogRead()
+  static void end();
+
+  // True when a reading has come in since the last read()
+  static bool available();
+
+  // The latest reading.  Never waits.
+  static void read(Sample &sample);
+
+  // Readings since begin()
+  static uint32_t getSampleCount();
+};
+
+#endif
@@ -0,0 +1,85 @@
+/*
+  LatencyHistogram
+
+  Counts how long something took, in microseconds, so the median and the
+  slow tail can be printed without keeping every time.
+
+  Times go in LATENCY_BUCKETS buckets of LatencyBucketUs each; anything
+  longer goes in the last one, and the longest is kept exactly.  A
+  percentile is the top of the bucket it lands in, so it reads a little
+  high, never low.  That's 64 bytes of counts, instead of a list that
+  would have to be sorted.
+
+  This file only needs <stdint.h>, so the math can be checked on a PC.
+ */
+
+#ifndef LatencyHistogram_h
+#define LatencyHistogram_h
+
+#include <stdint.h>
+
+#define LATENCY_BUCKETS 32
+
+static const uint16_t LatencyBucketUs = 1024; // 32 buckets cover 32 ms,
+                                              // more than a servo frame
+
+struct LatencyHistogram
+{
+  uint16_t counts[LATENCY_BUCKETS];
+  uint16_t total;
+  uint32_t longest;
+};
+
+inline void latencyReset(LatencyHistogram &h)
+{
+  for (uint8_t i = 0; i < LATENCY_BUCKETS; i++)
+  {
+    h.counts[i] = 0;
+  }
+  h.total = 0;
+  h.longest = 0;
+}
+
+inline void latencyAdd(LatencyHistogram &h, uint32_t us)
+{
+  if (h.total == 0xFFFF)
+  {
+    return;   // full: the percentiles so far still stand
+  }
+  uint32_t bucket = us / LatencyBucketUs;
+  h.counts[bucket < LATENCY_BUCKETS ? bucket : LATENCY_BUCKETS - 1]++;
+  h.total++;
+  if (us > h.longest)
+  {
+    h.longest = us;
+  }
+}
+
+// The time that percent of the times were at or under, e.g. 99 for the
+// 99th percentile.  0 if there are none yet.
+inline uint32_t latencyPercentile(const LatencyHistogram &h, uint8_t percent)
+{
+  if (h.total == 0)
+  {
+    return 0;
+  }
+  // The rank-th smallest time, counting from 1, rounded up
+  uint32_t rank = ((uint32_t)h.total * percent + 99) / 100;
+  if (rank == 0)
+  {
+    rank = 1;
+  }
+  uint32_t seen = 0;
+  for (uint8_t i = 0; i < LATENCY_BUCKETS - 1; i++)
+  {
+    seen += h.counts[i];
+    if (seen >= rank)
+    {
+      uint32_t top = (uint32_t)(i + 1) * LatencyBucketUs;
+      return top < h.longest ? top : h.longest;
+    }
+  }
+  return h.longest;
+}
+
+#endif
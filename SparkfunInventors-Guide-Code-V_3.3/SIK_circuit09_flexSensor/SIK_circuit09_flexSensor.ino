@@ -31,6 +31,8 @@ Version 2.0 6/2012 MDG
 // Include the servo library to add servo-control functions:
 
 #include <Servo.h> 
+#include "FilteredADC.h"	// Reads and cleans up the sensor in the background
+#include "LatencyHistogram.h"	// Keeps track of how quickly the servo follows
 
 Servo servo1;	//Create a servo "object", called servo1. 
 				//Each servo object controls one servo (you 
@@ -39,41 +41,166 @@ Servo servo1;	//Create a servo "object", called servo1.
 const int flexPin = A0; //Define analog input pin to measure
 						//flex sensor position. 
 
+// The flex sensor's range, straight to bent
+const int flexLow = 600;
+const int flexHigh = 900;
+
+// The servo is only moved when the sensor asks for a change of more
+// than this, in tenths of a degree, so it doesn't buzz back and forth
+// over the last bit of noise
+const int deadband = 15;
+
+// How often to print what's going on, in milliseconds
+const unsigned long reportInterval = 2000;
+
+int servoTenths = -1;		// where the servo was last sent, -1 for not yet
+unsigned long servoWrites = 0;	// how many times, since the last report
+unsigned long lastReport = 0;
+
+// From each reading to the start of the servo pulse that carries it.
+// The servo library only sends a new position with its next pulse, up
+// to 20 ms after write(), so that is timed too: a pin change interrupt
+// stamps the first rising edge on the servo pin after each write.
+LatencyHistogram latency;
+
+const int servoPin = 9;		// PB1: pin change group 0 on an Uno, 1 on a Mayfly
+
+// The interrupt has to be named when the sketch is compiled, so the
+// vector for servoPin's group is picked by chip here, and checked
+// against the group setup() turns on.  Without that, a board where the
+// pin is in another group would jump to the default vector, and reset,
+// on the first pulse.
+#if defined(__AVR_ATmega1284P__) || defined(__AVR_ATmega644P__)
+#define SERVO_PCINT_GROUP 1
+#define SERVO_PCINT_vect PCINT1_vect
+#else
+#define SERVO_PCINT_GROUP 0
+#define SERVO_PCINT_vect PCINT0_vect
+#endif
+static_assert(digitalPinToPCICRbit(servoPin) == SERVO_PCINT_GROUP,
+	"servoPin isn't in the pin change group SERVO_PCINT_vect handles");
+
+volatile bool pulseWanted = false;	// a write is waiting for its pulse
+volatile unsigned long pulseMicros;	// when that pulse started
+bool pulsePending = false;			// loop() still has to time it
+unsigned long pendingMicros;		// the reading it came from
+
 
 void setup() 
 { 
    
   Serial.begin(9600); //Set serial baud rate to 9600 bps
 
-  servo1.attach(9); // Enable control of a servo on pin 9
+  servo1.attach(servoPin); // Enable control of a servo on pin 9
+
+  // A pin change interrupt fires on output pins too, so it sees every
+  // pulse the servo library sends
+  *digitalPinToPCMSK(servoPin) |= _BV(digitalPinToPCMSKbit(servoPin));
+  *digitalPinToPCICR(servoPin) |= _BV(digitalPinToPCICRbit(servoPin));
+
+  // Instead of analogRead() each time round loop(), the ADC measures
+  // the flex sensor about 1000 times a second on its own, and each
+  // reading is filtered as it comes in.
+  FilteredADC::begin(flexPin);
+
+  latencyReset(latency);
 } 
 
 
 void loop() 
 { 
-  int flexPosition;    // Input value from the analog pin.
-  int servoPosition;   // Output value to the servo.
-
-  // Read the position of the flex sensor (0 to 1023):
-  
-  flexPosition = analogRead(flexPin);
+  FilteredADC::Sample sample;	// The latest reading, raw and filtered
+  long tenths;					// Where the servo should be, in tenths of a degree
+
+  // Wait for the next reading. This takes about 1 ms, not 20.
+
+  if (!FilteredADC::available())
+  {
+    return;
+  }
+  FilteredADC::read(sample);
+
+  // The filtered value is in 1/16ths, so scale the range to match:
+
+  tenths = ((long)sample.filtered - flexLow * 16L) * 1800 / ((flexHigh - flexLow) * 16L);
+  tenths = constrain(tenths, 0, 1800);
+
+  // Now we'll command the servo to move to that position, but only if
+  // it has moved far enough to matter:
+
+  if (servoTenths < 0 || abs(tenths - servoTenths) > deadband)
+  {
+    servo1.write((tenths + 5) / 10);
+    // If the last write hasn't gone out yet, this one replaces it and
+    // only this one is timed
+    noInterrupts();
+    pendingMicros = sample.micros;
+    pulseWanted = true;
+    interrupts();
+    pulsePending = true;
+    servoTenths = tenths;
+    servoWrites++;
+  }
+
+  if (pulsePending && !pulseWanted)
+  {
+    noInterrupts();
+    unsigned long started = pulseMicros;
+    interrupts();
+    latencyAdd(latency, started - pendingMicros);
+    pulsePending = false;
+  }
+
+  if (millis() - lastReport >= reportInterval)
+  {
+    lastReport = millis();
+    report(sample);
+  }
+} 
 
 
-  servoPosition = map(flexPosition, 600, 900, 0, 180);
-  servoPosition = constrain(servoPosition, 0, 180);
+// The servo pin went up or down
+ISR(SERVO_PCINT_vect)
+{
+  if (pulseWanted && digitalRead(servoPin) == HIGH)
+  {
+    pulseMicros = micros();
+    pulseWanted = false;
+  }
+}
 
-  // Now we'll command the servo to move to that position:
 
-  servo1.write(servoPosition);
+void report(const FilteredADC::Sample &sample)	//Print the latest values, and
+												//how quickly the servo followed
+{
+  static uint32_t lastCount = 0;
+  uint32_t count = FilteredADC::getSampleCount();
 
-  
   Serial.print("sensor: ");
-  Serial.print(flexPosition);
+  Serial.print(sample.raw);
+  Serial.print("  filtered: ");
+  Serial.print(sample.filtered / 16);
   Serial.print("  servo: ");
-  Serial.println(servoPosition);
-  
-  
-  delay(20);  // wait 20ms between servo updates
+  Serial.println((servoTenths + 5) / 10);
+
+  // Printing at 9600 bps takes a while, so a reading that came in
+  // during the last report shows up as the longest time
+  Serial.print("writes: ");
+  Serial.print(servoWrites);
+  Serial.print("/");
+  Serial.print(count - lastCount);
+  Serial.print("  to pulse, us p50: ");
+  Serial.print(latencyPercentile(latency, 50));
+  Serial.print(" p90: ");
+  Serial.print(latencyPercentile(latency, 90));
+  Serial.print(" p99: ");
+  Serial.print(latencyPercentile(latency, 99));
+  Serial.print(" max: ");
+  Serial.println(latency.longest);
+
+  lastCount = count;
+  servoWrites = 0;
+  latencyReset(latency);
 } 
 
 
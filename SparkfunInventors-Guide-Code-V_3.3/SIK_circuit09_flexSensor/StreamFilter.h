@@ -0,0 +1,87 @@
+/*
+  StreamFilter
+
+  Cleans up a stream of ADC readings one at a time: a median of the last
+  5, then a first order low pass (IIR) on that.
+
+  The median throws away single spikes, like the ones a servo's motor
+  puts on the supply when it starts, without rounding off real steps the
+  way an average would.  The low pass then takes out the last bit of
+  noise: each reading moves the output 1/2^shift of the way to it, so
+  with shift 2 it has settled to within 1% after about 16 readings.  At a
+  reading every millisecond the whole filter is only a few ms behind.
+
+  The output is in 1/16ths of a count, so the low pass doesn't stall a
+  fraction of a count short of the reading.  Adding a reading is a few
+  compares and a shift, cheap enough to do in the ADC interrupt.
+
+  This file only needs <stdint.h>, so the math can be checked on a PC.
+ */
+
+#ifndef StreamFilter_h
+#define StreamFilter_h
+
+#include <stdint.h>
+
+#define STREAM_FILTER_MEDIAN 5
+
+struct StreamFilter
+{
+  uint16_t window[STREAM_FILTER_MEDIAN];   // the last readings, oldest first round
+  uint8_t next;
+  uint8_t shift;
+  int32_t smooth;                          // 1/16ths of a count
+  bool started;
+};
+
+// Start again, with a low pass of 1/2^shift
+inline void streamFilterReset(StreamFilter &f, uint8_t shift)
+{
+  f.next = 0;
+  f.shift = shift;
+  f.smooth = 0;
+  f.started = false;
+}
+
+// The middle one of the window
+inline uint16_t streamMedian(const StreamFilter &f)
+{
+  uint16_t sorted[STREAM_FILTER_MEDIAN];
+  for (uint8_t i = 0; i < STREAM_FILTER_MEDIAN; i++)
+  {
+    uint16_t value = f.window[i];
+    uint8_t j = i;
+    while (j > 0 && sorted[j - 1] > value)
+    {
+      sorted[j] = sorted[j - 1];
+      j--;
+    }
+    sorted[j] = value;
+  }
+  return sorted[STREAM_FILTER_MEDIAN / 2];
+}
+
+// Add a reading, and return the filtered value in 1/16ths of a count
+inline uint16_t streamFilterAdd(StreamFilter &f, uint16_t reading)
+{
+  if (!f.started)
+  {
+    // Fill the window with the first reading, so it starts there
+    // instead of climbing up from 0
+    for (uint8_t i = 0; i < STREAM_FILTER_MEDIAN; i++)
+    {
+      f.window[i] = reading;
+    }
+    f.smooth = (int32_t)reading << 4;
+    f.started = true;
+  }
+
+  f.window[f.next] = reading;
+  f.next = f.next + 1 < STREAM_FILTER_MEDIAN ? f.next + 1 : 0;
+
+  int32_t target = (int32_t)streamMedian(f) << 4;
+  f.smooth += (target - f.smooth) >> f.shift;
+  return f.smooth;
+}
+
+#endif
@@ -0,0 +1,205 @@
+/*
+  FlexFilterTest
+
+  Checks the two pieces of math the flex sensor sketch runs on the board:
+
+  - StreamFilter: the median of 5 matches sorting the window, one or two
+    spikes in a row never move the output, and a step comes through two
+    readings late, then settles as the low pass says it does (within 1%
+    after 16 more readings at shift 2), without overshooting, and ends
+    less than a count from the new value
+  - LatencyHistogram: every percentile is the top of the bucket the true
+    one (the rank-th smallest time, rounded up) lands in, or the longest
+    time if that's less, so it reads up to a bucket high and never low
+
+  Build and run from this folder:
+    g++ -std=c++11 -Wall -Wextra -I.. -o FlexFilterTest FlexFilterTest.cpp && ./FlexFilterTest
+ */
+
+#include <algorithm>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+#include "StreamFilter.h"
+#include "LatencyHistogram.h"
+
+static int failures = 0;
+
+static void expect(bool ok, const char *what)
+{
+  if (!ok && failures++ < 20)
+  {
+    printf("FAIL %s\n", what);
+  }
+}
+
+
+static void testMedian()
+{
+  StreamFilter f;
+  streamFilterReset(f, 2);
+  for (int n = 0; n < 100000; n++)
+  {
+    streamFilterAdd(f, rand() % 1024);
+    uint16_t sorted[STREAM_FILTER_MEDIAN];
+    std::copy(f.window, f.window + STREAM_FILTER_MEDIAN, sorted);
+    std::sort(sorted, sorted + STREAM_FILTER_MEDIAN);
+    if (streamMedian(f) != sorted[STREAM_FILTER_MEDIAN / 2])
+    {
+      expect(false, "median isn't the middle of the sorted window");
+      return;
+    }
+  }
+}
+
+
+// A steady reading with spikes: up to two in a row go, three get through
+static void testSpikes()
+{
+  for (int run = 1; run <= 3; run++)
+  {
+    StreamFilter f;
+    streamFilterReset(f, 2);
+    bool moved = false;
+    for (int i = 0; i < 200; i++)
+    {
+      bool spike = i % 20 >= 10 && i % 20 < 10 + run;
+      uint16_t out = streamFilterAdd(f, spike ? 1023 : 700);
+      moved |= out != 700 * 16;
+    }
+    expect(moved == (run == 3), run == 3 ? "three spikes in a row didn't get through" :
+      "one or two spikes moved the output");
+  }
+}
+
+
+// From 'from' to 'to' in one reading, at each shift
+static void testStep(uint16_t from, uint16_t to, uint8_t shift)
+{
+  StreamFilter f;
+  streamFilterReset(f, shift);
+  expect(streamFilterAdd(f, from) == from * 16, "doesn't start at the first reading");
+  for (int i = 0; i < 10; i++)
+  {
+    streamFilterAdd(f, from);
+  }
+
+  // The median needs three of the five to have changed
+  expect(streamFilterAdd(f, to) == from * 16 && streamFilterAdd(f, to) == from * 16,
+    "step came through the median early");
+
+  double step = fabs((double)to - from) * 16;
+  int32_t last = from * 16;
+  int settleBy = (int)ceil(log(0.01) / log(1 - 1.0 / (1 << shift)));
+  for (int i = 1; i <= 200; i++)
+  {
+    int32_t out = streamFilterAdd(f, to);
+    if (to > from ? out < last || out > to * 16 : out > last || out < to * 16)
+    {
+      expect(false, "step went backwards or overshot");
+      return;
+    }
+    // The shift leaves up to 2^shift - 1 sixteenths short, going up
+    if (i == settleBy && fabs((double)out - to * 16) > 0.01 * step + (1 << shift))
+    {
+      printf("FAIL %u to %u at shift %u: %.2f after %d readings\n", from, to, shift, out / 16.0, i);
+      failures++;
+    }
+    last = out;
+  }
+  expect(abs(last - to * 16) < 16, "step settled a count or more away");
+}
+
+
+static void testSteps()
+{
+  for (uint8_t shift = 0; shift <= 4; shift++)
+  {
+    testStep(600, 900, shift);
+    testStep(900, 600, shift);
+    testStep(0, 1023, shift);
+    testStep(1023, 0, shift);
+    testStep(512, 513, shift);
+  }
+}
+
+
+// What latencyPercentile() should give for these times, sorted
+static uint32_t expectedPercentile(const std::vector<uint32_t> &times, uint8_t percent)
+{
+  if (times.empty())
+  {
+    return 0;
+  }
+  size_t rank = std::max<size_t>(1, (times.size() * percent + 99) / 100);
+  uint32_t exact = times[rank - 1];
+  uint32_t bucket = exact / LatencyBucketUs;
+  if (bucket >= LATENCY_BUCKETS - 1)
+  {
+    return times.back();
+  }
+  return std::min((bucket + 1) * LatencyBucketUs, times.back());
+}
+
+static void testPercentiles()
+{
+  LatencyHistogram h;
+  latencyReset(h);
+  expect(latencyPercentile(h, 50) == 0, "no times isn't 0");
+
+  for (int n = 0; n < 20000; n++)
+  {
+    latencyReset(h);
+    std::vector<uint32_t> times;
+    size_t count = 1 + rand() % 300;
+    uint32_t spread = rand() % 2 ? 20000 : 40000;    // some past the last bucket
+    for (size_t i = 0; i < count; i++)
+    {
+      times.push_back(rand() % spread);
+      latencyAdd(h, times.back());
+    }
+    std::sort(times.begin(), times.end());
+    for (int percent = 0; percent <= 100; percent++)
+    {
+      uint32_t got = latencyPercentile(h, percent);
+      if (got != expectedPercentile(times, percent))
+      {
+        printf("FAIL %u times, p%d: %u, wanted %u\n", (unsigned)count, percent, got,
+          expectedPercentile(times, percent));
+        failures++;
+        return;
+      }
+    }
+  }
+
+  // p10 of 1 to 100 ms is 10 ms, reported as its bucket top; p100 is
+  // past the last bucket, so the longest
+  latencyReset(h);
+  for (uint32_t ms = 1; ms <= 100; ms++)
+  {
+    latencyAdd(h, ms * 1000);
+  }
+  expect(latencyPercentile(h, 10) == 10240 && latencyPercentile(h, 100) == 100000,
+    "1 to 100 ms");
+
+  // Full: more times are ignored, and the ones in still count
+  latencyReset(h);
+  for (uint32_t i = 0; i < 0x10000 + 100; i++)
+  {
+    latencyAdd(h, i < 0xFFFF ? 500 : 30000);
+  }
+  expect(h.total == 0xFFFF && latencyPercentile(h, 100) == 500, "full histogram");
+}
+
+
+int main()
+{
+  srand(1);
+  testMedian();
+  testSpikes();
+  testSteps();
+  testPercentiles();
+  printf(failures ? "FAILED\n" : "PASSED\n");
+  return failures ? 1 : 0;
+}
@@ -37,7 +37,7 @@ Hardware connections:
 
 //The flex sensor will output a value on the analog pin, based on the degree 
 // of its flex. Because the voltage divider circuit only returns a portion
-// of the 0-1023 range of analogRead(), we'll map() that range
+// of the 0-1023 range of the ADC, we'll scale that range
 // to the servo's range of 0 to 180 degrees. The flex sensors
 // we use are usually in the 600-900 range.
 
@@ -55,8 +55,19 @@ Hardware connections:
 // (the magnifying-glass icon to the right of the icon bar).
 // You'll be able to see the sensor values. Bend the flex sensor
 // and note its minimum and maximum values. If you replace the
-// 600 and 900 in the map() function above, you'll exactly match
+// flexLow and flexHigh values in the sketch, you'll exactly match
 // the flex sensor's range with the servo's range.
 
+// The sketch doesn't call analogRead() and wait 20 ms each time. The
+// ADC measures the sensor about 1000 times a second by itself, and each
+// reading is filtered: a median of the last 5 throws away spikes, then
+// a smoothing step takes out the rest of the noise. The servo is only
+// sent a new position when that moves by more than the deadband, so it
+// holds still instead of twitching. Every 2 seconds the sketch prints
+// how many readings moved the servo, and how many microseconds it took
+// from a reading to the start of the servo pulse carrying it (the servo
+// only takes a new position every 20 ms): the median (p50), 90th and
+// 99th percentiles, and the longest.
+
 // Make sure you don't bend the flex sensor too sharply, or you could
 // permanently damage the sensor. No right angle bends! 
\ No newline at end of file
@@ -0,0 +1,152 @@
+#include "ToneSequencer.h"
+
+static volatile uint8_t *port;
+static uint8_t mask;
+static volatile uint8_t *otherPort;
+static uint8_t otherMask = 0;
+
+// Only the interrupt changes these while playing
+static const ToneEvent *events;
+static uint8_t count;
+static bool repeat;
+static volatile uint8_t position;
+static uint16_t toggles;
+static uint16_t restTicks;
+static volatile bool active = false;
+
+
+// Both legs low: no current through the buzzer
+static inline void silence()
+{
+  *port &= ~mask;
+  *otherPort &= ~otherMask;
+}
+
+
+// Timer2 counting 0 to top, then round again, at a clock select
+static inline void setTimer(uint8_t clock, uint8_t top)
+{
+  TCCR2B = clock;
+  OCR2A = top;
+  TCNT2 = 0;
+}
+
+
+void ToneSequencer::begin(uint8_t pin, uint8_t otherPin)
+{
+  port = portOutputRegister(digitalPinToPort(pin));
+  mask = digitalPinToBitMask(pin);
+  digitalWrite(pin, LOW);
+  pinMode(pin, OUTPUT);
+
+  if (otherPin != 0xFF)
+  {
+    otherPort = portOutputRegister(digitalPinToPort(otherPin));
+    otherMask = digitalPinToBitMask(otherPin);
+    digitalWrite(otherPin, LOW);
+    pinMode(otherPin, OUTPUT);
+  }
+  else
+  {
+    otherPort = port;
+    otherMask = 0;
+  }
+}
+
+
+void ToneSequencer::play(const ToneEvent *melody, uint8_t length, bool again)
+{
+  stop();
+  if (length == 0)
+  {
+    return;
+  }
+
+  events = melody;
+  count = length;
+  repeat = again;
+  position = 0xFF;       // the first interrupt moves on to note 0
+  toggles = 0;
+  restTicks = 0;
+  active = true;
+
+  // Clear timer on compare match, starting with a 1 ms tick
+  TCCR2A = _BV(WGM21);
+  setTimer(toneClock(ToneRestFrequency), toneTop(ToneRestFrequency));
+  TIFR2 = _BV(OCF2A);
+  TIMSK2 |= _BV(OCIE2A);
+}
+
+
+void ToneSequencer::stop()
+{
+  TIMSK2 &= ~_BV(OCIE2A);
+  active = false;
+  if (port)
+  {
+    silence();
+  }
+}
+
+
+bool ToneSequencer::playing()
+{
+  return active;
+}
+
+
+uint8_t ToneSequencer::getPosition()
+{
+  return position;
+}
+
+
+ISR(TIMER2_COMPA_vect)
+{
+  if (toggles != 0)
+  {
+    *port ^= mask;
+    *otherPort ^= otherMask;
+    if (--toggles == 0)
+    {
+      // The note is over: count the silence after it in 1 ms ticks
+      silence();
+      setTimer(toneClock(ToneRestFrequency), toneTop(ToneRestFrequency));
+    }
+    return;
+  }
+
+  if (restTicks != 0)
+  {
+    restTicks--;
+    return;
+  }
+
+  // On to the next note
+  uint8_t next = position + 1;
+  if (next >= count)
+  {
+    if (!repeat)
+    {
+      TIMSK2 &= ~_BV(OCIE2A);
+      active = false;
+      return;
+    }
+    next = 0;
+  }
+  position = next;
+
+  const ToneEvent *event = events + next;
+  toggles = pgm_read_word(&event->toggles);
+  restTicks = pgm_read_word(&event->restMs);
+  if (restTicks != 0)
+  {
+    restTicks--;         // the tick that loads the next note is the last
+  }
+  setTimer(pgm_read_byte(&event->clock), pgm_read_byte(&event->top));
+  if (toggles != 0)
+  {
+    // Legs opposite each other, ready for the first toggle
+    *otherPort |= otherMask;
+  }
+}
@@ -0,0 +1,50 @@
+/*
+  ToneSequencer
+
+  Plays a song (ToneMelody.h) on a buzzer in the background, so the
+  sketch doesn't have to wait in delay() for every note.
+
+  Timer2 does the work, as it does for tone().  Its compare interrupt
+  toggles the buzzer pin each half cycle, and when a note's toggles run
+  out it counts off the silence after it and loads the next note from
+  flash.  Everything it needs was worked out when the sketch compiled,
+  so each interrupt is just a count down and a toggle.
+
+  Give a second pin to drive the buzzer's other leg the opposite way,
+  as the Simon board does: twice the voltage across it, so louder.
+
+  This uses Timer2, so tone() and noTone() can't be used with it, and
+  analogWrite() won't work on pins 3 and 11.
+ */
+
+#ifndef ToneSequencer_h
+#define ToneSequencer_h
+
+#include <Arduino.h>
+#include "ToneMelody.h"
+
+class ToneSequencer
+{
+  public:
+  // The buzzer pin, and optionally one to drive opposite it
+  static void begin(uint8_t pin, uint8_t otherPin = 0xFF);
+
+  // Start playing a melody from flash (declared PROGMEM), from the top.
+  // With repeat, it starts again at the end until stop().
+  template<size_t N> static void play(const ToneMelody<N> &melody, bool repeat = false)
+  {
+    play(melody.events, N, repeat);
+  }
+  static void play(const ToneEvent *events, uint8_t count, bool repeat = false);
+
+  // Stop at once, and leave the buzzer off
+  static void stop();
+
+  // True until the last note and its silence are over
+  static bool playing();
+
+  // Which note is playing, counting from 0
+  static uint8_t getPosition();
+};
+
+#endif
@@ -29,7 +29,7 @@
  **************************************************************/
 
 /*****************************************************************
- * This sketch uses the tone() command to play notes.
+ * This sketch plays notes the way the tone() command does.
  * 
  * Usage: tone([pin], [frequency]);
  * 
@@ -48,21 +48,25 @@
  * For more information, see http://arduino.cc/en/Tutorial/Tone
  ****************************************************************/
 
-// In this sketch, we introduce an array or a list. Here is an array called notes[] that is
-// an array of individual characters. Each character is designated by a ' ' and separated
-// by commas. The spaces ' ' represent a rest note.
+// In this sketch, the song is written as a string called notes, one character
+// per note. The spaces ' ' represent a rest note. A second string, beats, says
+// how long each note lasts.
 
 /***************************************************************** 
-frequency() 
-// This is a specially written function takes a note as a character (a-g), 
-// and returns the corresponding frequency in Hz for the tone() function.
+toneMelody() 
+// This is a specially written function that takes the notes as characters (a-g),
+// and works out the timer settings for each note's frequency and length.
+// It is "constexpr", so the compiler runs it while the sketch compiles, and
+// the Arduino only gets the finished list. Nothing is looked up while playing.
 
-// The char_names and frequencies arrays hold the note characters and their
+// toneFrequency() in ToneMelody.h holds the note characters and their
 // corresponding frequencies. The last "C" note is uppercase
 // to separate it from the first lowercase "c". If you want to
 // add more notes, you'll need to use unique characters.
 
-// For the "char" (character) type, we put single characters
-// in single quotes.
+ToneSequencer::play()
+// Starts the song and returns straight away. A timer interrupt clicks the
+// buzzer and moves on to each next note by itself, so the sketch doesn't
+// have to wait in delay() for the whole song.
 
  ****************************************************************/
@@ -0,0 +1,133 @@
+#include "BuzzerPWM.h"
+#include "SIK_circuit16_simonGame.h"   // BUZZER1 and BUZZER2: OC1A and OC1B
+
+#define CLOCKS_PER_US (F_CPU / 1000000L)
+
+// Only the interrupt changes these while playing
+static uint16_t halfPeriod;        // us
+static uint16_t target;            // us, the end of a sweep
+static uint16_t cyclesLeft;        // at this half period
+static uint8_t cyclesEach;         // at each step of a sweep, 0 for a plain tone
+static volatile bool active = false;
+
+
+// Set the timer for a half period in us.  It counts at the CPU clock
+// when a period fits in 16 bits, else at /8, else at /64: at 16 MHz that
+// is half periods up to 2 ms, up to 16 ms, and the rest, which the
+// longest (65535 us) fits at 32767 counts.
+static void setPeriod(uint16_t halfUs)
+{
+  uint32_t clocks = (uint32_t)halfUs * 2 * CLOCKS_PER_US;
+  uint8_t prescaler = _BV(CS10);
+  if (clocks > 65536)
+  {
+    clocks /= 8;
+    prescaler = _BV(CS11);
+  }
+  if (clocks > 65536)
+  {
+    clocks /= 8;
+    prescaler = _BV(CS11) | _BV(CS10);
+  }
+  // Each output changes when the count matches, and again one count
+  // after top, so it is high (or low) for OCR1x + 1 counts: exactly half
+  ICR1 = clocks - 1;
+  OCR1A = clocks / 2 - 1;
+  OCR1B = clocks / 2 - 1;
+  TCCR1B = _BV(WGM13) | _BV(WGM12) | prescaler;
+}
+
+
+void BuzzerPWM::begin()
+{
+  digitalWrite(BUZZER1, LOW);
+  digitalWrite(BUZZER2, LOW);
+  pinMode(BUZZER1, OUTPUT);
+  pinMode(BUZZER2, OUTPUT);
+}
+
+
+// Start the timer from the bottom with the pins connected
+static void start()
+{
+  TIMSK1 &= ~_BV(TOIE1);
+  TCCR1B = 0;
+  TCNT1 = 0;
+  setPeriod(halfPeriod);
+  // Fast PWM to ICR1, OC1A non-inverted, OC1B inverted
+  TCCR1A = _BV(COM1A1) | _BV(COM1B1) | _BV(COM1B0) | _BV(WGM11);
+  active = true;
+  TIFR1 = _BV(TOV1);
+  TIMSK1 |= _BV(TOIE1);
+}
+
+
+void BuzzerPWM::play(uint16_t halfPeriodUs, uint16_t lengthMs)
+{
+  stop();
+  if (halfPeriodUs == 0)
+  {
+    return;
+  }
+  uint32_t cycles = (uint32_t)lengthMs * 1000 / (2UL * halfPeriodUs);
+  if (cycles == 0)
+  {
+    return;
+  }
+  halfPeriod = halfPeriodUs;
+  cyclesLeft = cycles > 0xFFFF ? 0xFFFF : cycles;
+  cyclesEach = 0;
+  start();
+}
+
+
+void BuzzerPWM::sweep(uint16_t fromUs, uint16_t toUs, uint8_t cycles)
+{
+  stop();
+  if (fromUs == 0 || toUs == 0 || cycles == 0)
+  {
+    return;
+  }
+  halfPeriod = fromUs;
+  target = toUs;
+  cyclesLeft = cycles;
+  cyclesEach = cycles;
+  start();
+}
+
+
+void BuzzerPWM::stop()
+{
+  TIMSK1 &= ~_BV(TOIE1);
+  TCCR1A = 0;             // the pins go back to PORT, which is low
+  TCCR1B = 0;
+  active = false;
+}
+
+
+bool BuzzerPWM::playing()
+{
+  return active;
+}
+
+
+// Once a cycle, as the count reaches top
+ISR(TIMER1_OVF_vect)
+{
+  if (--cyclesLeft != 0)
+  {
+    return;
+  }
+
+  if (cyclesEach == 0 || halfPeriod == target)
+  {
+    BuzzerPWM::stop();
+    return;
+  }
+
+  // The next step of a sweep.  The counter has only just wrapped round,
+  // so the new top is still ahead of it.
+  halfPeriod += target > halfPeriod ? 1 : -1;
+  setPeriod(halfPeriod);
+  cyclesLeft = cyclesEach;
+}
@@ -0,0 +1,56 @@
+/*
+  BuzzerPWM
+
+  Drives a buzzer between two pins from Timer1's compare outputs, so a
+  tone plays with no code running at all.
+
+  The timer runs in fast PWM mode with ICR1 as the top.  OC1A is set at
+  the bottom and cleared half way (non-inverted), and OC1B does the
+  opposite (inverted), so the two legs of the buzzer are always driven
+  opposite each other, as buzz_sound() used to do by hand.  The period is
+  a whole number of timer counts, and nothing can stretch it: with a
+  1136 us half period, every cycle is exactly 36352 clocks at 16 MHz.
+  Half periods too long for 16 bits at the CPU clock count at /8, or /64
+  past about 16 ms, so any half period up to 65535 us plays at its pitch.
+
+  A tone's length is counted in whole cycles: the overflow interrupt
+  counts them down, once per cycle, and disconnects the pins when done.
+  A sweep changes the half period by 1 us every few cycles, for sounds
+  like the winner's.
+
+  play() and sweep() return at once.  playing() says whether the tone is
+  still going, for when the next thing has to wait for it.
+
+  The pins are BUZZER1 and BUZZER2 from SIK_circuit16_simonGame.h, and
+  have to be OC1A and OC1B: 9 and 10 on an Uno.  While a tone plays,
+  analogWrite() won't work on them, and Timer1 can't be used for
+  anything else (the Servo library, for one).
+ */
+
+#ifndef BuzzerPWM_h
+#define BuzzerPWM_h
+
+#include <Arduino.h>
+
+class BuzzerPWM
+{
+  public:
+  // Set both buzzer pins (OC1A, OC1B) as outputs, off
+  static void begin();
+
+  // Play a tone with a half period in microseconds, for a length in
+  // milliseconds.  Replaces any tone playing.
+  static void play(uint16_t halfPeriodUs, uint16_t lengthMs);
+
+  // Step the half period from one value to another, 1 us at a time,
+  // with cyclesEach cycles at each
+  static void sweep(uint16_t fromUs, uint16_t toUs, uint8_t cyclesEach);
+
+  // Stop at once, with both pins low
+  static void stop();
+
+  // True until the tone or sweep has finished
+  static bool playing();
+};
+
+#endif
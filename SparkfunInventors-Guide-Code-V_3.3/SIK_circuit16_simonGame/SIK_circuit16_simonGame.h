@@ -98,24 +98,26 @@
 #define CHOICE_BLUE (1 << 2)
 #define CHOICE_YELLOW   (1 << 3)
 
-#define LED_RED     10
+#define LED_RED     7
 #define LED_GREEN   3
 #define LED_BLUE    13
 #define LED_YELLOW  5
 
 // Button pin definitions
-#define BUTTON_RED    9
+#define BUTTON_RED    4
 #define BUTTON_GREEN  2
 #define BUTTON_BLUE   12
 #define BUTTON_YELLOW 6
 
 // Buzzer pin definitions
-#define BUZZER1  4
-#define BUZZER2  7
+// These have to be Timer1's OC1A and OC1B, for BuzzerPWM
+#define BUZZER1  9
+#define BUZZER2  10
 
 // Define game parameters
 #define ROUNDS_TO_WIN      13 //Number of rounds to succesfully remember before you win. 13 is do-able.
 #define ENTRY_TIME_LIMIT   3000 //Amount of time to press a button before game times out. 3000ms = 3 sec
+#define ATTRACT_TIME_LIMIT 60000 //Amount of attract display with nobody playing before the board powers down until a button is pressed. 60000ms = 1 min
 
 #define MODE_MEMORY  0
 #define MODE_BATTLE  1
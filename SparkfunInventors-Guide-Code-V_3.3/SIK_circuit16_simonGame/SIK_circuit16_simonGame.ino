@@ -31,11 +31,15 @@
  */
 
 #include "SIK_circuit16_simonGame.h" // public constants used in the code
+#include "ToneSequencer.h" // plays the beegees song in the background
+#include "BuzzerPWM.h" // plays tones from Timer1 while the game carries on
+#include "SimonGame.h" // the game itself, as a state machine
+#include <avr/sleep.h>
 
 // Game state variables
 byte gameMode = MODE_MEMORY; //By default, let's play the memory game
-byte gameBoard[32]; //Contains the combination of buttons as we advance
-byte gameRound = 0; //Counts the number of succesful rounds the player has made it through
+SimonGame game; //Keeps track of the moves, the round, and what the game is doing now
+unsigned long idleSince = 0; //When the attract display last started, or a button was last pressed in it
 
 void setup()
 {
@@ -52,8 +56,7 @@ void setup()
   pinMode(LED_BLUE, OUTPUT);
   pinMode(LED_YELLOW, OUTPUT);
 
-  pinMode(BUZZER1, OUTPUT);
-  pinMode(BUZZER2, OUTPUT);
+  BuzzerPWM::begin(); // Sets up BUZZER1 and BUZZER2
 
   //Mode checking
   gameMode = MODE_MEMORY; // By default, we're going to play the memory game
@@ -77,123 +80,109 @@ void setup()
     //Now do nothing. Battle mode will be serviced in the main routine
   }
 
-  play_winner(); // After setup is complete, say hello to the world
+  game.begin(gameMode, millis()); // After setup is complete, say hello to the world
+
+  // Between updates the CPU sleeps. Idle sleep keeps the timers running,
+  // so millis() keeps counting, the buzzer keeps playing, and the millis()
+  // interrupt wakes it up again about once a millisecond. That is as deep
+  // as it can go while a game is on; see sleepUntilPressed() for when
+  // nobody is playing.
+  set_sleep_mode(SLEEP_MODE_IDLE);
 }
 
 void loop()
 {
-  attractMode(); // Blink lights while waiting for user to press a button
-
-  // Indicate the start of game play
-  setLEDs(CHOICE_RED | CHOICE_GREEN | CHOICE_BLUE | CHOICE_YELLOW); // Turn all LEDs on
-  delay(1000);
-  setLEDs(CHOICE_OFF); // Turn off LEDs
-  delay(250);
-
-  if (gameMode == MODE_MEMORY)
+  // Let the game react to the buttons and the time. This never waits:
+  // the attract display, the moves, the player's turn, winning and
+  // losing are all states in SimonGame.cpp that move on by themselves.
+  byte button = checkButton();
+  game.update(millis(), button);
+
+  // Nobody has played for a while, so stop the attract display and
+  // power down until somebody does
+  if (game.getState() != SimonGame::Attract || button != CHOICE_NONE)
   {
-    // Play memory game and handle result
-    if (play_memory() == true) 
-      play_winner(); // Player won, play winner tones
-    else 
-      play_loser(); // Player lost, play loser tones
+    idleSince = millis();
   }
-
-  if (gameMode == MODE_BATTLE)
+  else if (millis() - idleSince >= ATTRACT_TIME_LIMIT && !BuzzerPWM::playing())
   {
-    play_battle(); // Play game until someone loses
-
-    play_loser(); // Player lost, play loser tones
+    sleepUntilPressed();
+    idleSince = millis();
   }
-}
 
-//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
-//The following functions are related to game play only
+  sleep_mode(); // Sleep until the next interrupt
+}
 
-// Play the regular memory game
-// Returns 0 if player loses, or 1 if player wins
-boolean play_memory(void)
+// Power down, with only the buttons' pin change interrupts to wake it.
+// That stops every clock, millis() included, so it is only done in the
+// attract display, which just carries on where it was. The press that
+// wakes it is still held at the next update(), and starts a game.
+void sleepUntilPressed(void)
 {
-  randomSeed(millis()); // Seed the random generator with random amount of millis()
+  static const byte buttons[] = { BUTTON_RED, BUTTON_GREEN, BUTTON_BLUE, BUTTON_YELLOW };
 
-  gameRound = 0; // Reset the game to the beginning
+  setLEDs(CHOICE_OFF);
 
-  while (gameRound < ROUNDS_TO_WIN) 
+  for (byte i = 0; i < sizeof(buttons); i++)
   {
-    add_to_moves(); // Add a button to the current moves, then play them back
-
-    playMoves(); // Play back the current game board
-
-    // Then require the player to repeat the sequence.
-    for (byte currentMove = 0 ; currentMove < gameRound ; currentMove++)
-    {
-      byte choice = wait_for_button(); // See what button the user presses
-
-      if (choice == 0) return false; // If wait timed out, player loses
-
-      if (choice != gameBoard[currentMove]) return false; // If the choice is incorect, player loses
-    }
-
-    delay(1000); // Player was correct, delay before playing moves
+    *digitalPinToPCMSK(buttons[i]) |= _BV(digitalPinToPCMSKbit(buttons[i]));
+    PCIFR = _BV(digitalPinToPCICRbit(buttons[i])); // forget any old change
+    *digitalPinToPCICR(buttons[i]) |= _BV(digitalPinToPCICRbit(buttons[i]));
   }
 
-  return true; // Player made it through all the rounds to win!
-}
-
-// Play the special 2 player battle mode
-// A player begins by pressing a button then handing it to the other player
-// That player repeats the button and adds one, then passes back.
-// This function returns when someone loses
-boolean play_battle(void)
-{
-  gameRound = 0; // Reset the game frame back to one frame
-
-  while (1) // Loop until someone fails 
+  set_sleep_mode(SLEEP_MODE_PWR_DOWN);
+  noInterrupts();
+  if (checkButton() == CHOICE_NONE) // a press now would already be missed
   {
-    byte newButton = wait_for_button(); // Wait for user to input next move
-    gameBoard[gameRound++] = newButton; // Add this new button to the game array
-
-    // Then require the player to repeat the sequence.
-    for (byte currentMove = 0 ; currentMove < gameRound ; currentMove++)
-    {
-      byte choice = wait_for_button();
+    sleep_enable();
+    interrupts(); // the instruction after this one still runs first, so
+    sleep_cpu();  // a press can't slip in between and be slept through
+    sleep_disable();
+  }
+  interrupts();
+  set_sleep_mode(SLEEP_MODE_IDLE);
 
-      if (choice == 0) return false; // If wait timed out, player loses.
+  for (byte i = 0; i < sizeof(buttons); i++)
+  {
+    *digitalPinToPCICR(buttons[i]) &= ~_BV(digitalPinToPCICRbit(buttons[i]));
+    *digitalPinToPCMSK(buttons[i]) &= ~_BV(digitalPinToPCMSKbit(buttons[i]));
+  }
+}
 
-      if (choice != gameBoard[currentMove]) return false; // If the choice is incorect, player loses.
-    }
+// The wakeup is all a button's pin change interrupt is for. There is one
+// for every group, so whichever ports the buttons are on are covered.
+EMPTY_INTERRUPT(PCINT0_vect)
+#ifdef PCINT1_vect
+EMPTY_INTERRUPT(PCINT1_vect)
+#endif
+#ifdef PCINT2_vect
+EMPTY_INTERRUPT(PCINT2_vect)
+#endif
+#ifdef PCINT3_vect
+EMPTY_INTERRUPT(PCINT3_vect)
+#endif
 
-    delay(100); // Give the user an extra 100ms to hand the game to the other player
-  }
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+// The game calls these to light the LEDs and make sounds
 
-  return true; // We should never get here
+void simonSetLEDs(uint8_t leds)
+{
+  setLEDs(leds);
 }
 
-// Plays the current contents of the game moves
-void playMoves(void)
+void simonPlayTone(uint16_t halfPeriodUs, uint16_t lengthMs)
 {
-  for (byte currentMove = 0 ; currentMove < gameRound ; currentMove++) 
-  {
-    toner(gameBoard[currentMove], 150);
-
-    // Wait some amount of time between button playback
-    // Shorten this to make game harder
-    delay(150); // 150 works well. 75 gets fast.
-  }
+  BuzzerPWM::play(halfPeriodUs, lengthMs);
 }
 
-// Adds a new random button to the game sequence, by sampling the timer
-void add_to_moves(void)
+void simonPlaySweep(uint16_t fromUs, uint16_t toUs, uint8_t cyclesEach)
 {
-  byte newButton = random(0, 4); //min (included), max (exluded)
-
-  // We have to convert this number, 0 to 3, to CHOICEs
-  if(newButton == 0) newButton = CHOICE_RED;
-  else if(newButton == 1) newButton = CHOICE_GREEN;
-  else if(newButton == 2) newButton = CHOICE_BLUE;
-  else if(newButton == 3) newButton = CHOICE_YELLOW;
+  BuzzerPWM::sweep(fromUs, toUs, cyclesEach);
+}
 
-  gameBoard[gameRound++] = newButton; // Add this new button to the game array
+bool simonSoundPlaying()
+{
+  return BuzzerPWM::playing();
 }
 
 //-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
@@ -224,32 +213,6 @@ void setLEDs(byte leds)
     digitalWrite(LED_YELLOW, LOW);
 }
 
-// Wait for a button to be pressed. 
-// Returns one of LED colors (LED_RED, etc.) if successful, 0 if timed out
-byte wait_for_button(void)
-{
-  long startTime = millis(); // Remember the time we started the this loop
-
-  while ( (millis() - startTime) < ENTRY_TIME_LIMIT) // Loop until too much time has passed
-  {
-    byte button = checkButton();
-
-    if (button != CHOICE_NONE)
-    { 
-      toner(button, 150); // Play the button the user just pressed
-
-      while(checkButton() != CHOICE_NONE) ;  // Now let's wait for user to release button
-
-      delay(10); // This helps with debouncing and accidental double taps
-
-      return button;
-    }
-
-  }
-
-  return CHOICE_NONE; // If we get here, we've timed out!
-}
-
 // Returns a '1' bit in the position corresponding to CHOICE_RED, CHOICE_GREEN, etc.
 byte checkButton(void)
 {
@@ -262,139 +225,47 @@ byte checkButton(void)
 }
 
 // Light an LED and play tone
-// Red, upper left:     440Hz - 2.272ms - 1.136ms pulse
-// Green, upper right:  880Hz - 1.136ms - 0.568ms pulse
-// Blue, lower left:    587.33Hz - 1.702ms - 0.851ms pulse
-// Yellow, lower right: 784Hz - 1.276ms - 0.638ms pulse
 void toner(byte which, int buzz_length_ms)
 {
-  setLEDs(which); //Turn on a given LED
+  toner_start(which, buzz_length_ms);
 
-  //Play the sound associated with the given LED
-  switch(which) 
-  {
-  case CHOICE_RED:
-    buzz_sound(buzz_length_ms, 1136); 
-    break;
-  case CHOICE_GREEN:
-    buzz_sound(buzz_length_ms, 568); 
-    break;
-  case CHOICE_BLUE:
-    buzz_sound(buzz_length_ms, 851); 
-    break;
-  case CHOICE_YELLOW:
-    buzz_sound(buzz_length_ms, 638); 
-    break;
-  }
+  wait_for_sound();
 
   setLEDs(CHOICE_OFF); // Turn off all LEDs
 }
 
-// Toggle buzzer every buzz_delay_us, for a duration of buzz_length_ms.
-void buzz_sound(int buzz_length_ms, int buzz_delay_us)
-{
-  // Convert total play time from milliseconds to microseconds
-  long buzz_length_us = buzz_length_ms * (long)1000;
-
-  // Loop until the remaining play time is less than a single buzz_delay_us
-  while (buzz_length_us > (buzz_delay_us * 2))
-  {
-    buzz_length_us -= buzz_delay_us * 2; //Decrease the remaining play time
-
-    // Toggle the buzzer at various speeds
-    digitalWrite(BUZZER1, LOW);
-    digitalWrite(BUZZER2, HIGH);
-    delayMicroseconds(buzz_delay_us);
-
-    digitalWrite(BUZZER1, HIGH);
-    digitalWrite(BUZZER2, LOW);
-    delayMicroseconds(buzz_delay_us);
-  }
-}
-
-// Play the winner sound and lights
-void play_winner(void)
-{
-  setLEDs(CHOICE_GREEN | CHOICE_BLUE);
-  winner_sound();
-  setLEDs(CHOICE_RED | CHOICE_YELLOW);
-  winner_sound();
-  setLEDs(CHOICE_GREEN | CHOICE_BLUE);
-  winner_sound();
-  setLEDs(CHOICE_RED | CHOICE_YELLOW);
-  winner_sound();
-}
-
-// Play the winner sound
-// This is just a unique (annoying) sound we came up with, there is no magic to it
-void winner_sound(void)
+// Light an LED and start its tone, then return while it plays
+void toner_start(byte which, int buzz_length_ms)
 {
-  // Toggle the buzzer at various speeds
-  for (byte x = 250 ; x > 70 ; x--)
-  {
-    for (byte y = 0 ; y < 3 ; y++)
-    {
-      digitalWrite(BUZZER2, HIGH);
-      digitalWrite(BUZZER1, LOW);
-      delayMicroseconds(x);
+  setLEDs(which); //Turn on a given LED
 
-      digitalWrite(BUZZER2, LOW);
-      digitalWrite(BUZZER1, HIGH);
-      delayMicroseconds(x);
-    }
-  }
+  //Play the sound associated with the given LED
+  buzz_sound(buzz_length_ms, SimonGame::halfPeriodFor(which));
 }
 
-// Play the loser sound/lights
-void play_loser(void)
+// Toggle buzzer every buzz_delay_us, for a duration of buzz_length_ms.
+// The timer does the toggling, so this returns straight away.
+void buzz_sound(int buzz_length_ms, int buzz_delay_us)
 {
-  setLEDs(CHOICE_RED | CHOICE_GREEN);
-  buzz_sound(255, 1500);
-
-  setLEDs(CHOICE_BLUE | CHOICE_YELLOW);
-  buzz_sound(255, 1500);
-
-  setLEDs(CHOICE_RED | CHOICE_GREEN);
-  buzz_sound(255, 1500);
-
-  setLEDs(CHOICE_BLUE | CHOICE_YELLOW);
-  buzz_sound(255, 1500);
+  BuzzerPWM::play(buzz_delay_us, buzz_length_ms);
 }
 
-// Show an "attract mode" display while waiting for user to press button.
-void attractMode(void)
+// Wait for the sound playing to finish
+void wait_for_sound(void)
 {
-  while(1) 
-  {
-    setLEDs(CHOICE_RED);
-    delay(100);
-    if (checkButton() != CHOICE_NONE) return;
-
-    setLEDs(CHOICE_BLUE);
-    delay(100);
-    if (checkButton() != CHOICE_NONE) return;
-
-    setLEDs(CHOICE_GREEN);
-    delay(100);
-    if (checkButton() != CHOICE_NONE) return;
-
-    setLEDs(CHOICE_YELLOW);
-    delay(100);
-    if (checkButton() != CHOICE_NONE) return;
-  }
+  while (BuzzerPWM::playing()) ;
 }
 
 //-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
 // The following functions are related to Beegees Easter Egg only
 
-// Notes in the melody. Each note is about an 1/8th note, "0"s are rests.
-int melody[] = {
-  NOTE_G4, NOTE_A4, 0, NOTE_C5, 0, 0, NOTE_G4, 0, 0, 0,
-  NOTE_E4, 0, NOTE_D4, NOTE_E4, NOTE_G4, 0,
-  NOTE_D4, NOTE_E4, 0, NOTE_G4, 0, 0,
-  NOTE_D4, 0, NOTE_E4, 0, NOTE_G4, 0, NOTE_A4, 0, NOTE_C5, 0};
+// Notes in the melody, one character per 1/8th note, spaces are rests:
+// g = NOTE_G4, a = NOTE_A4, C = NOTE_C5, d = NOTE_D4, e = NOTE_E4.
+// Each note plays for 115ms, then there is a 30% gap so the notes are
+// distinguished. 115 is just about right for a disco groove :)
+// The timer settings for every note are worked out when the sketch compiles.
+const auto beegees PROGMEM = toneMelody("ga C  g   e deg de g  d e g a C ", 115, 34);
 
-int noteDuration = 115; // This essentially sets the tempo, 115 is just about right for a disco groove :)
 int LEDnumber = 0; // Keeps track of which LED we are on during the beegees loop
 
 // Do nothing but play bad beegees music
@@ -413,22 +284,22 @@ void play_beegees()
 
   delay(1000); // Wait a second before playing song
 
-  digitalWrite(BUZZER1, LOW); // setup the "BUZZER1" side of the buzzer to stay low, while we play the tone on the other pin.
+  // The song plays from a timer interrupt, over and over, with the two buzzer pins driven opposite each other
+  ToneSequencer::begin(BUZZER2, BUZZER1);
+  ToneSequencer::play(beegees, true);
 
+  byte lastNote = ToneSequencer::getPosition();
   while(checkButton() == CHOICE_NONE) //Play song until you press a button
   {
-    // iterate over the notes of the melody:
-    for (int thisNote = 0; thisNote < 32; thisNote++) {
+    byte thisNote = ToneSequencer::getPosition();
+    if (thisNote != lastNote) // Move the lights along with each note
+    {
       changeLED();
-      tone(BUZZER2, melody[thisNote],noteDuration);
-      // to distinguish the notes, set a minimum time between them.
-      // the note's duration + 30% seems to work well:
-      int pauseBetweenNotes = noteDuration * 1.30;
-      delay(pauseBetweenNotes);
-      // stop the tone playing:
-      noTone(BUZZER2);
+      lastNote = thisNote;
     }
   }
+
+  ToneSequencer::stop();
 }
 
 // Each time this function is called the board moves to the next LED
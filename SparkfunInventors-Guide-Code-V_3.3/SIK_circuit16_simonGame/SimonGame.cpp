@@ -0,0 +1,326 @@
+#include "SimonGame.h"
+
+#if ROUNDS_TO_WIN > SIMON_BOARD_SIZE
+#error ROUNDS_TO_WIN has to fit on the board
+#endif
+
+#define ALL_LEDS (CHOICE_RED | CHOICE_GREEN | CHOICE_BLUE | CHOICE_YELLOW)
+
+#define ATTRACT_MS      100     // each light of the attract display
+#define START_ON_MS     1000    // all lights on before the first move
+#define START_OFF_MS    250
+#define MOVE_MS         150     // each move shown, and each button's tone
+#define MOVE_GAP_MS     150     // between moves shown. 75 gets fast.
+#define DEBOUNCE_MS     10      // after a release, against double taps
+#define ROUND_PAUSE_MS  1000    // after repeating a round
+#define HANDOFF_MS      100     // battle: time to hand the game over
+#define LOSER_MS        255
+#define LOSER_HALF_US   1500
+
+// The attract display goes round red, blue, green, yellow
+static const uint8_t attractLights[4] = { CHOICE_RED, CHOICE_BLUE, CHOICE_GREEN, CHOICE_YELLOW };
+
+
+SimonGame::SimonGame()
+  : mode(MODE_MEMORY), state(Attract), since(0), round(0), move(0),
+    choice(CHOICE_NONE), adding(false), step(0), won(false), seed(1)
+{
+}
+
+
+void SimonGame::begin(uint8_t gameMode, uint32_t now)
+{
+  mode = gameMode;
+  fanfare(true, now);   // say hello to the world
+}
+
+
+// Red, upper left:     440Hz - 2.272ms - 1.136ms pulse
+// Green, upper right:  880Hz - 1.136ms - 0.568ms pulse
+// Blue, lower left:    587.33Hz - 1.702ms - 0.851ms pulse
+// Yellow, lower right: 784Hz - 1.276ms - 0.638ms pulse
+uint16_t SimonGame::halfPeriodFor(uint8_t which)
+{
+  switch (which)
+  {
+  case CHOICE_RED:
+    return 1136;
+  case CHOICE_GREEN:
+    return 568;
+  case CHOICE_BLUE:
+    return 851;
+  case CHOICE_YELLOW:
+    return 638;
+  }
+  return 0;
+}
+
+
+SimonGame::State SimonGame::getState()
+{
+  return state;
+}
+
+
+uint8_t SimonGame::getRound()
+{
+  return round;
+}
+
+
+uint8_t SimonGame::getMode()
+{
+  return mode;
+}
+
+
+void SimonGame::enter(State next, uint32_t now)
+{
+  state = next;
+  since = now;
+}
+
+
+bool SimonGame::waited(uint32_t now, uint32_t ms)
+{
+  return now - since >= ms;
+}
+
+
+// Four flashes with the winner's sweep or the loser's buzz
+void SimonGame::fanfare(bool win, uint32_t now)
+{
+  won = win;
+  step = 0;
+  enter(Fanfare, now);
+  fanfareStep();
+}
+
+
+void SimonGame::fanfareStep()
+{
+  if (won)
+  {
+    simonSetLEDs(step & 1 ? CHOICE_RED | CHOICE_YELLOW : CHOICE_GREEN | CHOICE_BLUE);
+    simonPlaySweep(250, 71, 3);
+  }
+  else
+  {
+    simonSetLEDs(step & 1 ? CHOICE_BLUE | CHOICE_YELLOW : CHOICE_RED | CHOICE_GREEN);
+    simonPlayTone(LOSER_HALF_US, LOSER_MS);
+  }
+}
+
+
+// A new random button on the end of the board
+void SimonGame::addMove()
+{
+  // xorshift: a cheap random sequence, the same on the Arduino and a PC
+  seed ^= seed << 7;
+  seed ^= seed >> 9;
+  seed ^= seed << 8;
+  board[round++] = 1 << (seed & 3);   // CHOICE_RED to CHOICE_YELLOW
+}
+
+
+void SimonGame::showMove()
+{
+  simonSetLEDs(board[move]);
+  simonPlayTone(halfPeriodFor(board[move]), MOVE_MS);
+}
+
+
+// The player has repeated every move on the board
+void SimonGame::roundDone(uint32_t now)
+{
+  if (mode == MODE_BATTLE)
+  {
+    adding = true;
+    enter(Pause, now);
+  }
+  else if (round >= ROUNDS_TO_WIN)
+  {
+    fanfare(true, now);
+  }
+  else
+  {
+    enter(Pause, now);
+  }
+}
+
+
+// The button is back up: was it the right one?
+void SimonGame::judge(uint32_t now)
+{
+  if (adding)
+  {
+    // Battle: a new move for the other player to repeat, starting from
+    // the first
+    board[round++] = choice;
+    adding = false;
+    move = 0;
+    enter(WaitPress, now);
+    return;
+  }
+
+  if (choice != board[move])
+  {
+    fanfare(false, now);
+    return;
+  }
+
+  move++;
+  if (move < round)
+  {
+    enter(WaitPress, now);
+  }
+  else
+  {
+    roundDone(now);
+  }
+}
+
+
+void SimonGame::update(uint32_t now, uint8_t button)
+{
+  switch (state)
+  {
+  case Fanfare:
+    if (!simonSoundPlaying())
+    {
+      if (++step < 4)
+      {
+        fanfareStep();
+      }
+      else
+      {
+        step = 0;
+        simonSetLEDs(attractLights[0]);
+        enter(Attract, now);
+      }
+    }
+    break;
+
+  case Attract:
+    if (button != CHOICE_NONE)
+    {
+      simonSetLEDs(ALL_LEDS);
+      enter(StartLights, now);
+    }
+    else if (waited(now, ATTRACT_MS))
+    {
+      step = (step + 1) & 3;
+      simonSetLEDs(attractLights[step]);
+      enter(Attract, now);
+    }
+    break;
+
+  case StartLights:
+    if (waited(now, START_ON_MS))
+    {
+      simonSetLEDs(CHOICE_OFF);
+      enter(StartGap, now);
+    }
+    break;
+
+  case StartGap:
+    if (waited(now, START_OFF_MS))
+    {
+      round = 0;
+      move = 0;
+      if (mode == MODE_BATTLE)
+      {
+        adding = true;
+        enter(WaitPress, now);
+      }
+      else
+      {
+        seed = (uint16_t)now | 1;   // never 0, or xorshift sticks there
+        adding = false;
+        addMove();
+        showMove();
+        enter(ShowMove, now);
+      }
+    }
+    break;
+
+  case ShowMove:
+    if (!simonSoundPlaying())
+    {
+      simonSetLEDs(CHOICE_OFF);
+      enter(ShowGap, now);
+    }
+    break;
+
+  case ShowGap:
+    if (waited(now, MOVE_GAP_MS))
+    {
+      if (++move < round)
+      {
+        showMove();
+        enter(ShowMove, now);
+      }
+      else
+      {
+        move = 0;
+        enter(WaitPress, now);
+      }
+    }
+    break;
+
+  case WaitPress:
+    if (button != CHOICE_NONE)
+    {
+      // Play the button the player pressed, while waiting for them to
+      // let go
+      choice = button;
+      simonSetLEDs(choice);
+      simonPlayTone(halfPeriodFor(choice), MOVE_MS);
+      enter(WaitRelease, now);
+    }
+    else if (waited(now, ENTRY_TIME_LIMIT))
+    {
+      fanfare(false, now);   // too slow
+    }
+    break;
+
+  case WaitRelease:
+    if (button == CHOICE_NONE && !simonSoundPlaying())
+    {
+      simonSetLEDs(CHOICE_OFF);
+      enter(Debounce, now);
+    }
+    break;
+
+  case Debounce:
+    if (waited(now, DEBOUNCE_MS))
+    {
+      judge(now);
+    }
+    break;
+
+  case Pause:
+    if (mode == MODE_BATTLE)
+    {
+      if (waited(now, HANDOFF_MS))
+      {
+        if (round < SIMON_BOARD_SIZE)
+        {
+          enter(WaitPress, now);
+        }
+        else
+        {
+          fanfare(true, now);   // the board is full and nobody slipped
+        }
+      }
+    }
+    else if (waited(now, ROUND_PAUSE_MS))
+    {
+      addMove();
+      move = 0;
+      showMove();
+      enter(ShowMove, now);
+    }
+    break;
+  }
+}
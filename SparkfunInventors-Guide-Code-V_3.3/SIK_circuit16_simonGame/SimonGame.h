@@ -0,0 +1,99 @@
+/*
+  SimonGame
+
+  The Simon game as a state machine.  Instead of loops that wait for a
+  button or a delay(), the game is in one state at a time (showing the
+  moves, waiting for a press, waiting for the release, ...) and moves on
+  only when something happens: a button goes down or up, a time runs
+  out, or a sound finishes.
+
+  The sketch calls update() as often as it likes with the time and the
+  button being pressed; each call does whatever is due and returns at
+  once.  So a press is seen at the next update(), within a millisecond
+  or so, instead of up to 100 ms later in the attract display, and the
+  sketch can sleep between updates.
+
+  The game doesn't touch the hardware itself.  It calls four functions
+  the sketch has to provide: simonSetLEDs(), simonPlayTone(),
+  simonPlaySweep() and simonSoundPlaying().  This file, SimonGame.cpp
+  and SIK_circuit16_simonGame.h only need <stdint.h>, so the game can be
+  built on a PC against pretend LEDs and buttons, and run through
+  thousands of games with scripted presses.
+
+  The moves go in a SIMON_BOARD_SIZE array.  In battle mode a game that
+  fills it ends with the winner's sound, as nobody lost.
+ */
+
+#ifndef SimonGame_h
+#define SimonGame_h
+
+#include <stdint.h>
+#include "SIK_circuit16_simonGame.h"
+
+#define SIMON_BOARD_SIZE 32
+
+// Provided by the sketch
+void simonSetLEDs(uint8_t leds);                               // CHOICE_ bits
+void simonPlayTone(uint16_t halfPeriodUs, uint16_t lengthMs);  // returns at once
+void simonPlaySweep(uint16_t fromUs, uint16_t toUs, uint8_t cyclesEach);
+bool simonSoundPlaying();
+
+class SimonGame
+{
+  public:
+  enum State
+  {
+    Fanfare,        // the winner's or loser's lights and sounds
+    Attract,        // lights going round until a button is pressed
+    StartLights,    // all on, then all off, before the first move
+    StartGap,
+    ShowMove,       // lighting and sounding the moves to repeat
+    ShowGap,
+    WaitPress,      // for the player's next button
+    WaitRelease,    // and for them to let go of it
+    Debounce,
+    Pause           // after a round, before the next
+  };
+
+  SimonGame();
+
+  // Start in MODE_MEMORY or MODE_BATTLE, with the hello sound
+  void begin(uint8_t mode, uint32_t now);
+
+  // Call often, with millis() and the button held (a CHOICE_, or
+  // CHOICE_NONE).  Never waits.
+  void update(uint32_t now, uint8_t button);
+
+  // The half period, in us, of the tone for each button
+  static uint16_t halfPeriodFor(uint8_t choice);
+
+  State getState();
+  uint8_t getRound();
+  uint8_t getMode();
+
+  private:
+  void enter(State next, uint32_t now);
+  bool waited(uint32_t now, uint32_t ms);
+  void fanfare(bool won, uint32_t now);
+  void fanfareStep();
+  void addMove();
+  void showMove();
+  void roundDone(uint32_t now);
+  void judge(uint32_t now);
+
+  uint8_t mode;
+  State state;
+  uint32_t since;           // when this state started
+
+  uint8_t board[SIMON_BOARD_SIZE];
+  uint8_t round;            // moves on the board
+  uint8_t move;             // the one being shown or repeated
+  uint8_t choice;           // the button pressed
+  bool adding;              // battle mode: the next press is a new move
+
+  uint8_t step;             // of the attract lights or a fanfare
+  bool won;
+  uint16_t seed;            // for the random moves
+};
+
+#endif
@@ -0,0 +1,147 @@
+/*
+  ToneMelody
+
+  Turns a song written as a string of notes into the list of timer
+  settings ToneSequencer plays, while the sketch compiles.
+
+  Notes are one letter each, as in the SIK buzzer sketch, and a space is
+  a rest:
+
+    note   c    d    e    f    g    a    b    C
+    Hz    262  294  330  349  392  440  494  523
+
+  The beats string gives each note's length in beats, one digit per
+  note, so it has to be exactly as long as the notes (the compiler says
+  so if it isn't).  After each note there is a short gap of silence, so
+  two of the same note don't run together.
+
+    const auto song PROGMEM = toneMelody("cdfda ag", "11111144", 150, 15);
+
+  Everything here is constexpr, so the frequency lookup, the choice of
+  timer prescaler and the count for each note's length are all worked
+  out by the compiler.  The sketch only gets the finished numbers, in
+  flash, and has nothing to look up or divide while it plays.
+
+  Each note becomes one ToneEvent for Timer2: its clock select, its
+  compare value (the timer counts 0 to top, then toggles the buzzer),
+  how many toggles make the note's length, and then how many
+  milliseconds of silence follow it.
+
+  This file only needs <stdint.h> and F_CPU, so the tables can be
+  checked on a PC.
+ */
+
+#ifndef ToneMelody_h
+#define ToneMelody_h
+
+#include <stdint.h>
+#include <stddef.h>
+
+struct ToneEvent
+{
+  uint8_t clock;        // Timer2 clock select, 1 (/1) to 7 (/1024)
+  uint8_t top;          // compare value
+  uint16_t toggles;     // 0 for a rest
+  uint16_t restMs;      // silence after the note
+};
+
+template<size_t N> struct ToneMelody
+{
+  ToneEvent events[N];
+};
+
+
+// The note letters, c to C
+constexpr uint16_t toneFrequency(char note)
+{
+  return note == 'c' ? 262 : note == 'd' ? 294 : note == 'e' ? 330 :
+         note == 'f' ? 349 : note == 'g' ? 392 : note == 'a' ? 440 :
+         note == 'b' ? 494 : note == 'C' ? 523 : 0;
+}
+
+// Timer2's prescaler for each clock select
+constexpr uint16_t toneDivider(uint8_t clock)
+{
+  return clock == 1 ? 1 : clock == 2 ? 8 : clock == 3 ? 32 : clock == 4 ? 64 :
+         clock == 5 ? 128 : clock == 6 ? 256 : 1024;
+}
+
+// The fastest clock that can still count one half cycle in 8 bits
+constexpr uint8_t toneClock(uint32_t frequency, uint8_t clock = 1)
+{
+  return clock == 7 || F_CPU / (2 * frequency * toneDivider(clock)) <= 256 ?
+         clock : toneClock(frequency, clock + 1);
+}
+
+// Counting 0 to top, to the nearest count
+constexpr uint8_t toneTop(uint32_t frequency)
+{
+  return (F_CPU / (frequency * toneDivider(toneClock(frequency))) + 1) / 2 - 1;
+}
+
+// How many times a second the buzzer actually toggles
+constexpr uint32_t toneToggleRate(uint32_t frequency)
+{
+  return F_CPU / ((uint32_t)toneDivider(toneClock(frequency)) * (toneTop(frequency) + 1));
+}
+
+// Rests are timed in 1 ms ticks, as if toggling at 1 kHz
+static const uint16_t ToneRestFrequency = 500;
+
+constexpr uint16_t toneToggles(uint32_t frequency, uint32_t ms)
+{
+  return frequency == 0 ? 0 :
+         toneToggleRate(frequency) * ms / 1000 > 0xFFFF ? 0xFFFF :
+         toneToggleRate(frequency) * ms / 1000;
+}
+
+// One note: beats long, then gapMs of silence.  A rest is silent for all
+// of it.
+constexpr ToneEvent toneEvent(char note, uint8_t beats, uint16_t beatMs, uint16_t gapMs)
+{
+  return toneFrequency(note) == 0 ?
+         ToneEvent{ toneClock(ToneRestFrequency), toneTop(ToneRestFrequency), 0,
+                    (uint16_t)(beats * beatMs + gapMs) } :
+         ToneEvent{ toneClock(toneFrequency(note)), toneTop(toneFrequency(note)),
+                    toneToggles(toneFrequency(note), (uint32_t)beats * beatMs), gapMs };
+}
+
+
+// 0, 1, 2 ... N - 1, to walk through the strings one letter at a time
+template<size_t... I> struct ToneIndices {};
+template<size_t N, size_t... I> struct ToneCount : ToneCount<N - 1, N - 1, I...> {};
+template<size_t... I> struct ToneCount<0, I...>
+{
+  typedef ToneIndices<I...> type;
+};
+
+template<size_t N, size_t... I>
+constexpr ToneMelody<N - 1> toneCompile(const char (&notes)[N], const char (&beats)[N],
+                                        uint16_t beatMs, uint16_t gapMs, ToneIndices<I...>)
+{
+  return ToneMelody<N - 1>{ { toneEvent(notes[I], beats[I] - '0', beatMs, gapMs)... } };
+}
+
+template<size_t N, size_t... I>
+constexpr ToneMelody<N - 1> toneCompile(const char (&notes)[N],
+                                        uint16_t beatMs, uint16_t gapMs, ToneIndices<I...>)
+{
+  return ToneMelody<N - 1>{ { toneEvent(notes[I], 1, beatMs, gapMs)... } };
+}
+
+// A song with a length in beats for each note
+template<size_t N>
+constexpr ToneMelody<N - 1> toneMelody(const char (&notes)[N], const char (&beats)[N],
+                                       uint16_t beatMs, uint16_t gapMs)
+{
+  return toneCompile(notes, beats, beatMs, gapMs, typename ToneCount<N - 1>::type());
+}
+
+// A song with every note one beat long
+template<size_t N>
+constexpr ToneMelody<N - 1> toneMelody(const char (&notes)[N], uint16_t beatMs, uint16_t gapMs)
+{
+  return toneCompile(notes, beatMs, gapMs, typename ToneCount<N - 1>::type());
+}
+
+#endif
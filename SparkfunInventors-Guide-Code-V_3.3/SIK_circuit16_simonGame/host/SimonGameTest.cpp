@@ -0,0 +1,317 @@
+/*
+  SimonGameTest
+
+  Plays SimonGame on a PC against pretend LEDs, buzzer and buttons, with
+  update() called every millisecond as the sketch would between sleeps.
+
+  - A perfect player always wins a memory game, and a full battle game.
+  - A player who slips, or waits too long, loses at that move.
+  - A fuzzer presses random buttons at random times in either mode, from
+    a random millis(), so some games run across it wrapping round.  Every
+    game has to get back to the attract display, the board never
+    overflows, and a press always lights its LED at the same update.
+
+  Also times a sample of the update() calls on this PC.
+
+  Build and run from this folder:
+    g++ -std=c++11 -O2 -Wall -Wextra -I.. -o SimonGameTest SimonGameTest.cpp ../SimonGame.cpp && ./SimonGameTest
+
+  That fuzzes a million games, a minute or two of work;
+  ./SimonGameTest 2000 fuzzes that many instead.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+#include "SimonGame.h"
+
+// The pretend hardware
+static uint32_t nowMs;
+static uint8_t leds;
+static uint32_t soundEnd;
+static uint32_t sweeps;       // only the hello and the winner's fanfare sweep
+
+void simonSetLEDs(uint8_t l)
+{
+  leds = l;
+}
+
+void simonPlayTone(uint16_t halfPeriodUs, uint16_t lengthMs)
+{
+  // Whole cycles, as BuzzerPWM plays them
+  uint32_t cycles = (uint32_t)lengthMs * 1000 / (2 * halfPeriodUs);
+  soundEnd = nowMs + (cycles * 2 * halfPeriodUs + 999) / 1000;
+}
+
+void simonPlaySweep(uint16_t fromUs, uint16_t toUs, uint8_t cyclesEach)
+{
+  uint32_t us = 0;
+  for (uint32_t half = fromUs; half >= toUs; half--)
+  {
+    us += 2 * half * cyclesEach;
+  }
+  soundEnd = nowMs + (us + 999) / 1000;
+  sweeps++;
+}
+
+bool simonSoundPlaying()
+{
+  return (int32_t)(nowMs - soundEnd) < 0;
+}
+
+static uint32_t random32()
+{
+  static uint32_t x = 2463534242UL;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  return x;
+}
+
+static uint8_t randomButton()
+{
+  return 1 << (random32() & 3);
+}
+
+
+// How a player plays
+struct Style
+{
+  uint8_t mode;
+  bool fuzz;            // any button at any time
+  uint8_t slipAt;       // press a wrong button on this move (counting from 1), 0 for never
+  bool tooSlow;         // stop pressing after the first round
+  uint32_t maxGapMs;    // between letting go and the next press
+};
+
+struct Outcome
+{
+  bool finished;
+  bool won;
+  uint8_t round;
+  uint32_t moves;       // presses judged
+};
+
+static int failures = 0;
+static uint64_t updates = 0;
+static std::vector<uint32_t> updateNanos;
+
+static void fail(const char *what, uint8_t round)
+{
+  if (failures++ < 20)
+  {
+    printf("FAIL %s (round %u, at %lu ms)\n", what, round, (unsigned long)nowMs);
+  }
+}
+
+static Outcome play(const Style &style, uint32_t startMs)
+{
+  SimonGame game;
+  nowMs = startMs;
+  soundEnd = startMs;
+  uint32_t sweepsBefore = sweeps;
+  game.begin(style.mode, nowMs);
+
+  std::vector<uint8_t> board;    // what the player remembers
+  size_t next = 0;               // the move they are repeating
+  bool adding = style.mode == MODE_BATTLE;
+  bool started = false;
+  uint8_t held = CHOICE_NONE;
+  uint32_t holdUntil = 0, nextPress = nowMs + 500;
+  uint32_t presses = 0;
+
+  Outcome outcome = { false, false, 0, 0 };
+  SimonGame::State before = game.getState();
+  uint32_t limit = 40UL * 60 * 1000;     // no game takes 40 minutes
+  for (uint32_t ms = 0; ms < limit; ms++, nowMs++)
+  {
+    if (held != CHOICE_NONE && (int32_t)(nowMs - holdUntil) >= 0)
+    {
+      held = CHOICE_NONE;
+    }
+
+    SimonGame::State state = game.getState();
+    bool pressing = held == CHOICE_NONE && (int32_t)(nowMs - nextPress) >= 0;
+    if (pressing && state == SimonGame::Attract && !started)
+    {
+      held = randomButton();
+      holdUntil = nowMs + 30;
+    }
+    else if (pressing && (style.fuzz || state == SimonGame::WaitPress) &&
+      !(style.tooSlow && outcome.round > 0))
+    {
+      uint8_t button;
+      presses++;
+      if (style.fuzz || adding || next >= board.size())
+      {
+        button = randomButton();
+      }
+      else
+      {
+        button = board[next];
+      }
+      if (presses == style.slipAt)
+      {
+        button = button == CHOICE_RED ? CHOICE_GREEN : CHOICE_RED;
+      }
+      held = button;
+      holdUntil = nowMs + 5 + random32() % 150;
+      nextPress = holdUntil + random32() % (style.maxGapMs + 1);
+    }
+
+    // Timing every update() would take longer than the updates do
+    updates++;
+    if ((random32() & 255) == 0)
+    {
+      std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+      game.update(nowMs, held);
+      std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
+      updateNanos.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count());
+    }
+    else
+    {
+      game.update(nowMs, held);
+    }
+
+    state = game.getState();
+    if (before == SimonGame::Attract && state == SimonGame::StartLights)
+    {
+      started = true;
+    }
+    outcome.round = game.getRound();
+    if (outcome.round > SIMON_BOARD_SIZE)
+    {
+      fail("board overflow", outcome.round);
+      return outcome;
+    }
+
+    // A press lights its own LED straight away
+    if (before == SimonGame::WaitPress && state == SimonGame::WaitRelease)
+    {
+      if (leds != held)
+      {
+        fail("press didn't light its LED", outcome.round);
+      }
+      if (!style.fuzz)
+      {
+        if (adding)
+        {
+          board.push_back(held);
+          adding = false;
+          next = 0;
+        }
+        else if (++next == board.size() && style.mode == MODE_BATTLE)
+        {
+          adding = true;
+        }
+      }
+      outcome.moves++;
+    }
+
+    // Memory mode: a new round shows the whole board again
+    if (state == SimonGame::ShowMove && before != SimonGame::ShowMove)
+    {
+      if (before != SimonGame::ShowGap)
+      {
+        board.clear();
+      }
+      board.push_back(leds);
+      next = 0;
+    }
+
+    if (started && before == SimonGame::Fanfare && state == SimonGame::Attract)
+    {
+      outcome.finished = true;
+      outcome.won = sweeps > sweepsBefore + 4;   // the hello fanfare was the first four
+      return outcome;
+    }
+    before = state;
+  }
+  fail("game never ended", outcome.round);
+  return outcome;
+}
+
+
+static void testPerfectPlayers()
+{
+  for (int i = 0; i < 200; i++)
+  {
+    Style memory = { MODE_MEMORY, false, 0, false, 400 };
+    Outcome o = play(memory, random32());
+    if (!o.finished || !o.won || o.round != ROUNDS_TO_WIN)
+    {
+      fail("a perfect memory game wasn't won", o.round);
+    }
+
+    Style battle = { MODE_BATTLE, false, 0, false, 400 };
+    o = play(battle, random32());
+    if (!o.finished || !o.won || o.round != SIMON_BOARD_SIZE)
+    {
+      fail("a perfect battle didn't fill the board and win", o.round);
+    }
+  }
+}
+
+static void testLosers()
+{
+  for (uint8_t slip = 1; slip <= 20; slip++)
+  {
+    Style memory = { MODE_MEMORY, false, slip, false, 400 };
+    Outcome o = play(memory, random32());
+    if (!o.finished || o.won || o.moves != slip)
+    {
+      fail("a slip in a memory game didn't lose there", o.round);
+    }
+
+    Style battle = { MODE_BATTLE, false, slip, false, 400 };
+    o = play(battle, random32());
+    // A slip while adding a move is just a different move
+    if (!o.finished || (o.won && o.round != SIMON_BOARD_SIZE))
+    {
+      fail("a battle with a slip didn't end properly", o.round);
+    }
+  }
+
+  Style slow = { MODE_MEMORY, false, 0, true, 400 };
+  Outcome o = play(slow, random32());
+  if (!o.finished || o.won || o.round != 1)
+  {
+    fail("waiting too long didn't lose", o.round);
+  }
+}
+
+static void fuzz(long games)
+{
+  long won = 0;
+  for (long g = 0; g < games; g++)
+  {
+    uint8_t mode = random32() & 1 ? MODE_BATTLE : MODE_MEMORY;
+    uint32_t maxGapMs = random32() & 1 ? 400 : ENTRY_TIME_LIMIT + 500;   // some too slow
+    Style style = { mode, true, 0, false, maxGapMs };
+    uint32_t start = g % 4 == 0 ? 0xFFFFFFFFUL - random32() % 60000 : random32();
+    Outcome o = play(style, start);
+    won += o.won;
+  }
+  printf("%ld fuzzed games, %ld won by chance, %" PRIu64 " updates in all\n", games, won, updates);
+}
+
+
+int main(int argc, char **argv)
+{
+  long games = argc > 1 ? atol(argv[1]) : 1000000;
+
+  testPerfectPlayers();
+  testLosers();
+  fuzz(games);
+
+  std::sort(updateNanos.begin(), updateNanos.end());
+  printf("update() on this PC: median %u ns, 99%% %u ns, worst %u ns\n",
+    updateNanos[updateNanos.size() / 2], updateNanos[updateNanos.size() * 99 / 100],
+    updateNanos.back());
+
+  printf(failures ? "FAILED\n" : "PASSED\n");
+  return failures ? 1 : 0;
+}
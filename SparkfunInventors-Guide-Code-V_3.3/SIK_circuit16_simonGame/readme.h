@@ -2,8 +2,10 @@
 Hardware connections:
 
 Buzzer: 
-	Connect the positive leg (+) to pin 4 of the Arduino.
-	Connect the other leg to pin 7 of the Arduino.
+	Connect the positive leg (+) to pin 9 of the Arduino.
+	Connect the other leg to pin 10 of the Arduino.
+	(These are the pins Timer1 can drive by itself, so the game
+	keeps running while the buzzer plays.)
 	
 LEDs:
 	Connect the negative (shorter) leg of each LED to GND. 
@@ -23,14 +25,14 @@ LEDs:
 		Arduino.
 	Red LED: 
 		Connect the positive (longer leg) to a 330 Ohm resistor. 
-		Connect the other side of the resistor to pin 2 on the
+		Connect the other side of the resistor to pin 7 on the
 		Arduino.
 
 Buttons: 
 	Button Red:	
 		Connect any pin on the red pushbutton to ground (GND).
 		Connect the opposite diagonal pin of the pushbutton to
-		digital pin 2
+		digital pin 4
 	Button Green:	
 		Connect any pin on the green pushbutton to ground (GND).
 		Connect the opposite diagonal pin of the pushbutton to
@@ -38,11 +40,11 @@ Buttons:
 	Button Yellow:	
 		Connect any pin on  the yellow pushbutton  to ground (GND).
 		Connect the opposite diagonal pin of the pushbutton to
-		digital pin 2
+		digital pin 6
 	Button Blue:	
 		Connect any pin on the blue pushbutton  to ground (GND).
 		Connect the opposite diagonal pin of the pushbutton to
-		digital pin 2
+		digital pin 12
 ******************************************************************/
 
 /*****************************************************************
@@ -70,7 +72,8 @@ There are three modes available.
 			
 			A player begins by pressing a button then handing it to the other player
 			That player repeats the button and adds one, then passes back.
-			This function returns when someone loses
+			The game ends when someone loses, or with the winner sound
+			if the 32 moves the game can hold are all used up.
 			
 * BeeGees - This mode starts if the yellow button is held down on power up. 
 
@@ -42,11 +42,26 @@ Visit http://www.arduino.cc to learn about the Arduino.
 Version 2.0 6/2012 MDG
 */
 
+#include "OversampledADC.h"  // Reads the sensor in the background, with extra bits
+#include "FixedConvert.h"    // Unit conversions without float math
+
 // We'll use analog input 0 to measure the temperature sensor's
 // signal pin.
 
 const int temperaturePin = 0;
 
+// Each extra bit comes from averaging 4 times as many readings.
+// 4 extra bits gives 14 bit results, 37 times a second.
+const uint8_t extraBits = 4;
+const uint8_t adcBits = 10 + extraBits;
+
+// The ADC's reference voltage, in millivolts
+const uint16_t referenceMv = 5000;
+
+// Set to true to put the CPU to sleep during each conversion, for even
+// less noise (see OversampledADC.h)
+const bool adcSleep = false;
+
 
 void setup()
 {
@@ -61,38 +76,49 @@ void setup()
   // and will transfer about 10 characters per second.
   
   Serial.begin(9600);
+
+  // From here on the ADC measures the temperature pin by itself.
+  OversampledADC::begin(temperaturePin, extraBits, adcSleep);
+  OversampledADC::waitForResult();  // the first one takes about 27 ms
 }
 
 
 void loop()
 {
-  // Up to now we've only used integer ("int") values in our
-  // sketches. Integers are always whole numbers (0, 1, 23, etc.).
-  // In this sketch, we'll use floating-point values ("float").
-  // Floats can be fractional numbers such as 1.42, 2523.43121, etc.
+  // Integers are always whole numbers (0, 1, 23, etc.).
+  // Floating-point values ("float") can be fractional numbers such
+  // as 1.42, 2523.43121, etc., but the Arduino has no hardware for
+  // them, so every float multiply or divide is done slowly in
+  // software. Instead we'll keep whole numbers of small units:
+  // millivolts, and hundredths of a degree (2275 is 22.75 degrees).
 
-  // We'll declare three floating-point variables
   // (We can declare multiple variables of the same type on one line:)
 
-  float voltage, degreesC, degreesF;
+  uint16_t counts, millivolts;
+  long centiC, centiF;
 
-  // First we'll measure the voltage at the analog pin. Normally
-  // we'd use analogRead(), which returns a number from 0 to 1023.
+  // First we'll measure the analog pin. Normally we'd use
+  // analogRead(), which returns a number from 0 to 1023.
   // Here we've written a function (further down) called
-  // getVoltage() that returns the true voltage (0 to 5 Volts)
-  // present on an analog input pin.
+  // getCounts() that returns the ADC's latest reading
+  // (0 to 16383 for 14 bits) of the temperature pin.
+
+  counts = getCounts();
+
+  // The functions in FixedConvert.h do the math. First the
+  // voltage, 0 to 5000 millivolts:
 
-  voltage = getVoltage(temperaturePin);
+  millivolts = adcMillivolts(counts, adcBits, referenceMv);
   
-  // Now we'll convert the voltage to degrees Celsius.
-  // This formula comes from the temperature sensor datasheet:
+  // Now we'll convert to degrees Celsius. The formula
+  // (volts - 0.5) * 100 comes from the temperature sensor datasheet:
 
-  degreesC = (voltage - 0.5) * 100.0;
+  centiC = tmp36CentiDegrees(counts, adcBits, referenceMv);
   
   // While we're at it, let's convert degrees Celsius to Fahrenheit.
-  // This is the classic C to F conversion formula:
+  // This is the classic C to F conversion formula, C * 9/5 + 32:
   
-  degreesF = degreesC * (9.0/5.0) + 32.0;
+  centiF = fahrenheitFromCelsius(centiC, 100);
   
   // Now we'll use the serial port to print these values
   // to the serial monitor!
@@ -117,15 +143,19 @@ void loop()
   // we use the Serial.print() function. You can print variables
   // or text (within quotes).
 
+  // printFixed() (further down) prints our small units with
+  // a decimal point.
+
   Serial.print("voltage: ");
-  Serial.print(voltage);
+  printFixed(millivolts, 1000);
   Serial.print("  deg C: ");
-  Serial.print(degreesC);
+  printFixed(centiC, 100);
   Serial.print("  deg F: ");
-  Serial.println(degreesF);
+  printFixed(centiF, 100);
+  Serial.println();
 
   // These statements will print lines of data like this:
-  // "voltage: 0.73 deg C: 22.75 deg F: 72.96"
+  // "voltage: 0.728 deg C: 22.75 deg F: 72.96"
 
   // Note that all of the above statements are "print", except
   // for the last one, which is "println". "Print" will output
@@ -138,12 +168,12 @@ void loop()
 }
 
 
-float getVoltage(int pin)
+uint16_t getCounts()
 {
-  // This function has one input parameter, the analog pin number
-  // to read. You might notice that this function does not have
-  // "void" in front of it; this is because it returns a floating-
-  // point value, which is the true voltage on that pin (0 to 5V).
+  // This function has no input parameters, since the ADC already
+  // knows which pin to measure. You might notice that this function does not have
+  // "void" in front of it; this is because it returns a whole
+  // number, which is the reading of that pin.
   
   // You can write your own functions that take in parameters
   // and return values. Here's how:
@@ -153,7 +183,7 @@ float getVoltage(int pin)
     // have multiple parameters, separated with commas.
     
     // To return a value, put the type BEFORE the function name
-    // (see "float", above), and use a return() statement in your code
+    // (see "uint16_t", above), and use a return() statement in your code
     // to actually return the value (see below).
   
     // If you don't need to get any parameters, you can just put
@@ -162,14 +192,43 @@ float getVoltage(int pin)
     // If you don't need to return a value, just write "void" before
     // the function name.
 
-  // Here's the return statement for this function. We're doing
-  // all the math we need to do within this statement:
-  
-  return (analogRead(pin) * 0.004882814);
+  // Here's the return statement for this function.
   
-  // This equation converts the 0 to 1023 value that analogRead()
-  // returns, into a 0.0 to 5.0 value that is the true voltage
-  // being read at that pin.
+  // The ADC has been measuring all along, so the latest result is
+  // already waiting. With sleep on, it measures now instead, and as
+  // Serial stops while the CPU sleeps, whatever is still being sent
+  // has to go first.
+
+  if (adcSleep)
+  {
+    Serial.flush();
+  }
+  return adcSleep ? OversampledADC::waitForResult() : OversampledADC::read();
+}
+
+
+void printFixed(long value, unsigned int one)
+{
+  // Prints a number in small units with a decimal point. "one" is
+  // how many small units make 1, so printFixed(2275, 100) prints
+  // 22.75 and printFixed(728, 1000) prints 0.728.
+
+  if (value < 0)
+  {
+    Serial.print('-');
+    value = -value;
+  }
+  Serial.print(value / one);  // the whole part
+  Serial.print('.');
+
+  // Then the fraction, one digit at a time, so 5 hundredths
+  // comes out as "05" and not "5"
+
+  unsigned int fraction = value % one;
+  for (unsigned int digit = one / 10; digit > 0; digit /= 10)
+  {
+    Serial.print((fraction / digit) % 10);
+  }
 }
 
 // Other things to try with this code:
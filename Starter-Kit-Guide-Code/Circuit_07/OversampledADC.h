@@ -0,0 +1,70 @@
+/*
+  OversampledADC
+
+  Reads one analog pin continuously in the background, with more bits
+  than analogRead() gives.
+
+  The ADC runs free: each conversion takes 13 ADC clocks (about 104 us at
+  125 kHz) and the next starts by itself.  The ADC-complete interrupt adds
+  each one to a sum, and after 4^n conversions the sum shifted right by n
+  is a result with n extra bits (Atmel app note AVR121, "Enhancing ADC
+  resolution by oversampling").  That needs at least 1 LSB of noise on
+  the signal, which a TMP36 on a breadboard has plenty of.
+
+    extra bits   conversions   result range   results per second
+        0             1          0 - 1023          9615
+        2            16          0 - 4095           601
+        3            64          0 - 8191           150
+        4           256          0 - 16383           37
+
+  Results are double buffered: the interrupt fills one slot while read()
+  takes the other, so loop() picks up the latest one without waiting and
+  without turning interrupts off.
+
+  With noise reduction sleep on, the ADC doesn't run free.  Instead
+  waitForResult() puts the CPU in ADC noise reduction sleep for each
+  conversion, so the CPU's own switching isn't in the reading.  Nothing
+  is measured unless waitForResult() is called, and while asleep millis()
+  doesn't count and Serial doesn't send (their clock is stopped too).
+  Call Serial.flush() before waitForResult(), or a character still being
+  sent is cut off part way and comes out as garbage.
+
+  While this runs, analogRead() can't be used on any pin.
+ */
+
+#ifndef OversampledADC_h
+#define OversampledADC_h
+
+#include <Arduino.h>
+
+class OversampledADC
+{
+  public:
+  static const uint8_t MaxExtraBits = 4;
+
+  // Start reading an analog pin (A0 to A7) with 0 to 4 extra bits.
+  // Returns false if the pin or the number of bits won't do.
+  static bool begin(uint8_t pin, uint8_t extraBits, bool sleep = false);
+
+  // Stop, and give the ADC and the pin back to analogRead() and
+  // digitalRead()
+  static void end();
+
+  // True when a result has come in since the last read()
+  static bool available();
+
+  // The latest result, 0 to getFullScale() - 1.  Never waits.
+  static uint16_t read();
+
+  // Wait for a new result and return it.  With noise reduction sleep on,
+  // the CPU sleeps through its conversions, so flush Serial first.
+  static uint16_t waitForResult();
+
+  // What a result would be at the reference voltage: 1024 << extra bits
+  static uint32_t getFullScale();
+
+  // Results since begin()
+  static uint32_t getResultCount();
+};
+
+#endif
@@ -52,87 +52,93 @@ Version 2.0 6/2012 MDG
 // using a new part, chances are someone has written a library
 // for it.
 
-#include <Servo.h>  // servo library
+#include "ServoPlanner.h"  // moves servos smoothly, in the background
 
-// Once you "include" a library, you'll have access to those
-// functions. You can find a list of the functions in the servo
-// library at: http://arduino.cc/en/Reference/Servo
-// Most libraries also have example sketches you can load from
-// the "file/examples" menu.
+// This one, ServoPlanner, is in this sketch's folder. It sends the
+// servos their control signals just like the standard Servo library
+// (http://arduino.cc/en/Reference/Servo), and it can also move them
+// to a new angle by itself, speeding up and slowing down smoothly,
+// while your sketch gets on with something else.
 
-// Now we'll create a servo "object", called myservo. You should
-// create one of these for each servo you want to control. 
-// You can control a maximum of twelve servos on the Uno 
-// using this library. (Other servo libraries may let you
-// control more). Note that this library disables PWM on
-// pins 9 and 10!
+// Each servo you attach gets a number, which you use to tell it
+// what to do. You can control up to eight servos this way.
+// Note that this disables PWM on pins 9 and 10!
 
-Servo servo1;  // servo control object
+int servo1;  // servo number
+
+// The moves to make, one after another: the angle, how fast (degrees
+// per second), and how long to wait once there (ms). A "struct"
+// groups several values together, and we make a list of them.
+// The servo in the kit turns about 600 degrees per second flat out.
+
+struct Step
+{
+  int angle;
+  int speed;
+  unsigned long pause;
+};
+
+const Step steps[] =
+{
+  // Change position at full speed:
+  {  90, 600, 1000 },   // Tell servo to go to 90 degrees
+  { 180, 600, 1000 },   // Tell servo to go to 180 degrees
+  {   0, 600, 1000 },   // Tell servo to go to 0 degrees
+
+  // Change position at a slower speed: to 180 degrees at 100
+  // degrees per second, then back to 0 at 50 degrees per second
+  { 180, 100, 0 },
+  {   0,  50, 0 },
+};
+const int stepCount = sizeof(steps) / sizeof(steps[0]);
+
+// How quickly to speed up and slow down, in degrees per second per second
+const int acceleration = 2000;
+
+int step = -1;               // the step in progress
+unsigned long arrived = 0;   // when the servo got there
+bool waiting = true;
 
 
 void setup()
 {
-  // We'll now "attach" the servo1 object to digital pin 9.
+  // We'll now "attach" servo1 to digital pin 9.
   // If you want to control more than one servo, attach more
-  // servo objects to the desired pins (must be digital).
+  // servos to the desired pins (must be digital).
 
   // Attach tells the Arduino to begin sending control signals
   // to the servo. Servos require a continuous stream of control
   // signals, even if you're not currently moving them.
   // While the servo is being controlled, it will hold its 
-  // current position with some force. If you ever want to
-  // release the servo (allowing it to be turned by hand),
-  // you can call servo1.detach().
+  // current position with some force.
 
-  servo1.attach(9);
+  servo1 = ServoPlanner::attach(9);
 }
 
 
 void loop()
 {
-  int position;
-  
   // To control a servo, you give it the angle you'd like it
   // to turn to. Servos cannot turn a full 360 degrees, but you
   // can tell it to move anywhere between 0 and 180 degrees.
 
-  // Change position at full speed:
-
-  servo1.write(90);    // Tell servo to go to 90 degrees
-
-  delay(1000);         // Pause to get it time to move
-
-  servo1.write(180);   // Tell servo to go to 180 degrees
-
-  delay(1000);         // Pause to get it time to move
+  // ServoPlanner::moveTo() starts a move and returns straight
+  // away, so there's no delay() here: loop() just notices when
+  // a move has finished, waits out the pause, and starts the next.
 
-  servo1.write(0);     // Tell servo to go to 0 degrees
-
-  delay(1000);         // Pause to get it time to move
-  
-  // Change position at a slower speed:
-
-  // To slow down the servo's motion, we'll use a for() loop
-  // to give it a bunch of intermediate positions, with 20ms
-  // delays between them. You can change the step size to make 
-  // the servo slow down or speed up. Note that the servo can't
-  // move faster than its full speed, and you won't be able
-  // to update it any faster than every 20ms.
-
-  // Tell servo to go to 180 degrees, stepping by two degrees
- 
-  for(position = 0; position < 180; position += 2)
+  if (!waiting && !ServoPlanner::moving(servo1))
   {
-    servo1.write(position);  // Move to next position
-    delay(20);               // Short pause to allow it to move
+    arrived = millis();  // just got there
+    waiting = true;
   }
 
-  // Tell servo to go to 0 degrees, stepping by one degree
-
-  for(position = 180; position >= 0; position -= 1)
-  {                                
-    servo1.write(position);  // Move to next position
-    delay(20);               // Short pause to allow it to move
+  if (waiting && (step < 0 || millis() - arrived >= steps[step].pause))
+  {
+    step = (step + 1) % stepCount;  // the next step, and back to the first after the last
+    ServoPlanner::moveTo(servo1, steps[step].angle, steps[step].speed, acceleration);
+    waiting = false;
   }
+
+  // Anything else can happen here, even moving more servos at once
 }
 
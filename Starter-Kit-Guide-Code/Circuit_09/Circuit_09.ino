@@ -43,8 +43,8 @@ Version 2.0 6/2012 MDG
 /*
 This sketch uses the buzzer to play songs.
 The Arduino's tone() command will play notes of a given frequency.
-We'll provide a function that takes in note characters (a-g),
-and returns the corresponding frequency from this table:
+We'll write the song as note characters (a-g), and the sketch
+looks up their frequencies in this table while it compiles:
 
   note 	frequency
   c     262 Hz
@@ -59,95 +59,65 @@ and returns the corresponding frequency from this table:
 For more information, see http://arduino.cc/en/Tutorial/Tone
 */
   
+#include "ToneSequencer.h"
+
 const int buzzerPin = 9;
 
-// We'll set up an array with the notes we want to play
+// We'll set up strings with the notes we want to play
 // change these values to make different songs!
 
-// Length must equal the total number of notes and spaces 
-
-const int songLength = 18;
-
-// Notes is an array of text characters corresponding to the notes
+// Notes is a string of text characters corresponding to the notes
 // in your song. A space represents a rest (no tone)
 
-char notes[] = "cdfda ag cdfdg gf "; // a space represents a rest
-
-// Beats is an array values for each note and rest.
+// Beats is a string with a digit for each note and rest.
 // A "1" represents a quarter-note, 2 a half-note, etc.
 // Don't forget that the rests (spaces) need a length as well.
-
-int beats[] = {1,1,1,1,1,1,4,4,2,1,1,1,1,1,1,4,4,2};
+// The two strings must be the same length, or the sketch won't
+// compile.
 
 // The tempo is how fast to play the song.
 // To make the song play faster, decrease this value.
 
-int tempo = 150;
+const int tempo = 150;
 
+// toneMelody() turns the strings into a list of timer settings, one
+// per note, while the sketch compiles. PROGMEM puts that list in
+// flash memory, so it doesn't use any of the Arduino's RAM.
 
-void setup() 
-{
-  pinMode(buzzerPin, OUTPUT);
-}
+const auto song PROGMEM = toneMelody(
+  "cdfda ag cdfdg gf ",   // notes, a space represents a rest
+  "111111442111111442",   // beats
+  tempo, tempo/10);       // ms per beat, and a brief pause between notes
 
 
-void loop() 
+void setup() 
 {
-  int i, duration;
-  
-  for (i = 0; i < songLength; i++) // step through the song arrays
-  {
-    duration = beats[i] * tempo;  // length of note/rest in ms
-    
-    if (notes[i] == ' ')          // is this a rest? 
-    {
-      delay(duration);            // then pause for a moment
-    }
-    else                          // otherwise, play the note
-    {
-      tone(buzzerPin, frequency(notes[i]), duration);
-      delay(duration);            // wait for tone to finish
-    }
-    delay(tempo/10);              // brief pause between notes
-  }
+  ToneSequencer::begin(buzzerPin);
+
+  // Start the song. Instead of waiting in delay() for every note,
+  // a timer interrupt plays the notes one after another in the
+  // background, so this returns straight away.
   
-  // We only want to play the song once, so we'll pause forever:
-  while(true){}
-  // If you'd like your song to play over and over,
-  // remove the above statement
+  // We only want to play the song once. If you'd like your song
+  // to play over and over, use ToneSequencer::play(song, true);
+  ToneSequencer::play(song);
 }
 
 
-int frequency(char note) 
+void loop() 
 {
-  // This function takes a note character (a-g), and returns the
-  // corresponding frequency in Hz for the tone() function.
-  
-  int i;
-  const int numNotes = 8;  // number of notes we're storing
-  
-  // The following arrays hold the note characters and their
-  // corresponding frequencies. The last "C" note is uppercase
-  // to separate it from the first lowercase "c". If you want to
-  // add more notes, you'll need to use unique characters.
-
-  // For the "char" (character) type, we put single characters
-  // in single quotes.
+  // The Arduino is free to do other things while the song plays.
+  // Here we light the LED on pin 13 until it has finished.
 
-  char names[] = { 'c', 'd', 'e', 'f', 'g', 'a', 'b', 'C' };
-  int frequencies[] = {262, 294, 330, 349, 392, 440, 494, 523};
-  
-  // Now we'll search through the letters in the array, and if
-  // we find it, we'll return the frequency for that note.
+  pinMode(13, OUTPUT);
   
-  for (i = 0; i < numNotes; i++)  // Step through the notes
+  if (ToneSequencer::playing())
+  {
+    digitalWrite(13, HIGH);
+  }
+  else
   {
-    if (names[i] == note)         // Is this the one?
-    {
-      return(frequencies[i]);     // Yes! Return the frequency
-    }
+    digitalWrite(13, LOW);
   }
-  return(0);  // We looked through everything and didn't find it,
-              // but we still need to return a value, so return 0.
 }
 